@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/adaptive_radix_tree_test.dir/container/adaptive_radix_tree_test.cpp.o"
+  "CMakeFiles/adaptive_radix_tree_test.dir/container/adaptive_radix_tree_test.cpp.o.d"
+  "adaptive_radix_tree_test"
+  "adaptive_radix_tree_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/adaptive_radix_tree_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
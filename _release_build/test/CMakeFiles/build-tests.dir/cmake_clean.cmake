@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/build-tests"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/build-tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
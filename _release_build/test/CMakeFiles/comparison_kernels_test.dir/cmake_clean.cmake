@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/comparison_kernels_test.dir/execution/comparison_kernels_test.cpp.o"
+  "CMakeFiles/comparison_kernels_test.dir/execution/comparison_kernels_test.cpp.o.d"
+  "comparison_kernels_test"
+  "comparison_kernels_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/comparison_kernels_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
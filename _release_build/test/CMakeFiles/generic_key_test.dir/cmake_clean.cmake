@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/generic_key_test.dir/storage/generic_key_test.cpp.o"
+  "CMakeFiles/generic_key_test.dir/storage/generic_key_test.cpp.o.d"
+  "generic_key_test"
+  "generic_key_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/generic_key_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rwlatch_test.dir/common/rwlatch_test.cpp.o"
+  "CMakeFiles/rwlatch_test.dir/common/rwlatch_test.cpp.o.d"
+  "rwlatch_test"
+  "rwlatch_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rwlatch_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/varlen_b_plus_tree_test.dir/storage/varlen_b_plus_tree_test.cpp.o"
+  "CMakeFiles/varlen_b_plus_tree_test.dir/storage/varlen_b_plus_tree_test.cpp.o.d"
+  "varlen_b_plus_tree_test"
+  "varlen_b_plus_tree_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/varlen_b_plus_tree_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -202,7 +202,7 @@ bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   page_tmp->pin_count_ = 0;
   page_tmp->page_id_ = INVALID_PAGE_ID;
   page_tmp->ResetMemory();  // 擦除换出页数据
-  replacer_->Pin(page_id);
+  replacer_->Pin(frame_id_tmp);
   page_table_.erase(page_id);
   free_list_.push_back(frame_id_tmp);
   return true;
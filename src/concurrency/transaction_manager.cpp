@@ -36,11 +36,24 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
   return txn;
 }
 
-void TransactionManager::Commit(Transaction *txn) {
+bool TransactionManager::Commit(Transaction *txn) {
+  // Validation and write phases run in a single critical section, so a transaction validates against every
+  // transaction that committed before it.
+  std::unique_lock validation_lock{validation_latch_, std::defer_lock};
+  if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+    validation_lock.lock();
+    if (!Validate(txn) || !InstallWrites(txn)) {
+      Abort(txn);
+      return false;
+    }
+  }
+  txn->GetReadSet()->clear();
+  txn->GetOptimisticWriteSet()->clear();
   txn->SetState(TransactionState::COMMITTED);
 
   // Perform all deletes before we commit.
   auto write_set = txn->GetWriteSet();
+  std::vector<RID> written_rids = WrittenRids(txn);
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
@@ -51,15 +64,24 @@ void TransactionManager::Commit(Transaction *txn) {
     write_set->pop_back();
   }
   write_set->clear();
+  // The versions change once the writes are final, so no reader validates against a tuple that is still changing
+  BumpVersions(written_rids);
+  if (validation_lock.owns_lock()) {
+    validation_lock.unlock();
+  }
 
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
+  return true;
 }
 
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
+  std::vector<RID> written_rids = WrittenRids(txn);
+  txn->GetReadSet()->clear();
+  txn->GetOptimisticWriteSet()->clear();
   // Rollback before releasing the lock.
   auto table_write_set = txn->GetWriteSet();
   while (!table_write_set->empty()) {
@@ -84,8 +106,8 @@ void TransactionManager::Abort(Transaction *txn) {
     // Metadata identifying the table that should be deleted from.
     TableInfo *table_info = catalog->GetTable(item.table_oid_);
     IndexInfo *index_info = catalog->GetIndex(item.index_oid_);
-    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                            index_info->index_->GetKeyAttrs());
+    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetEntrySchema()),
+                                            index_info->index_->GetEntryAttrs());
     if (item.wtype_ == WType::DELETE) {
       index_info->index_->InsertEntry(new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
@@ -93,14 +115,16 @@ void TransactionManager::Abort(Transaction *txn) {
     } else if (item.wtype_ == WType::UPDATE) {
       // Delete the new key and insert the old key
       index_info->index_->DeleteEntry(new_key, item.rid_, txn);
-      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                                  index_info->index_->GetKeyAttrs());
+      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetEntrySchema()),
+                                                  index_info->index_->GetEntryAttrs());
       index_info->index_->InsertEntry(old_key, item.rid_, txn);
     }
     index_write_set->pop_back();
   }
   table_write_set->clear();
   index_write_set->clear();
+  // Optimistic readers may have seen the uncommitted values, invalidate them once they are rolled back.
+  BumpVersions(written_rids);
 
   // Release all the locks.
   ReleaseLocks(txn);
@@ -108,6 +132,93 @@ void TransactionManager::Abort(Transaction *txn) {
   global_txn_latch_.RUnlock();
 }
 
+version_t TransactionManager::GetTupleVersion(const RID &rid) {
+  std::scoped_lock version_lock{version_latch_};
+  auto iter = tuple_versions_.find(rid);
+  return iter == tuple_versions_.end() ? 0 : iter->second;
+}
+
+void TransactionManager::RecordRead(Transaction *txn, const RID &rid) {
+  if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+    txn->AddIntoReadSet(rid, GetTupleVersion(rid));
+  }
+}
+
+bool TransactionManager::Validate(Transaction *txn) {
+  std::scoped_lock version_lock{version_latch_};
+  for (const auto &[rid, version] : *txn->GetReadSet()) {
+    auto iter = tuple_versions_.find(rid);
+    version_t current = iter == tuple_versions_.end() ? 0 : iter->second;
+    if (current != version) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TransactionManager::InstallWrites(Transaction *txn) {
+  for (auto &item : *txn->GetOptimisticWriteSet()) {
+    auto catalog = item.catalog_;
+    TableInfo *table_info = catalog->GetTable(item.table_oid_);
+    TableHeap *table = table_info->table_.get();
+    auto indexes = catalog->GetTableIndexes(table_info->name_);
+
+    RID rid = item.rid_;
+    Tuple old_tuple;
+    if (item.wtype_ == WType::INSERT) {
+      if (!table->InsertTuple(item.tuple_, &rid, txn)) {
+        return false;
+      }
+    } else {
+      if (!table->GetTuple(rid, &old_tuple, txn)) {
+        return false;
+      }
+      bool installed =
+          item.wtype_ == WType::DELETE ? table->MarkDelete(rid, txn) : table->UpdateTuple(item.tuple_, rid, txn);
+      if (!installed) {
+        return false;
+      }
+    }
+
+    for (auto index_info : indexes) {
+      auto index = index_info->index_.get();
+      auto &new_tuple = item.wtype_ == WType::DELETE ? old_tuple : item.tuple_;
+      if (item.wtype_ != WType::INSERT) {
+        index->DeleteEntry(
+            old_tuple.KeyFromTuple(table_info->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()), rid, txn);
+      }
+      if (item.wtype_ != WType::DELETE) {
+        index->InsertEntry(
+            new_tuple.KeyFromTuple(table_info->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()), rid, txn);
+      }
+      txn->GetIndexWriteSet()->emplace_back(rid, item.table_oid_, item.wtype_, new_tuple, index_info->index_oid_,
+                                            catalog);
+      txn->GetIndexWriteSet()->back().old_tuple_ = old_tuple;
+    }
+  }
+  return true;
+}
+
+std::vector<RID> TransactionManager::WrittenRids(Transaction *txn) {
+  std::vector<RID> rids;
+  rids.reserve(txn->GetWriteSet()->size());
+  for (const auto &item : *txn->GetWriteSet()) {
+    rids.push_back(item.rid_);
+  }
+  return rids;
+}
+
+void TransactionManager::BumpVersions(const std::vector<RID> &rids) {
+  if (rids.empty()) {
+    return;
+  }
+  std::scoped_lock version_lock{version_latch_};
+  version_t version = next_version_++;
+  for (const auto &rid : rids) {
+    tuple_versions_[rid] = version;
+  }
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
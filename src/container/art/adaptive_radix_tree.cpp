@@ -0,0 +1,798 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/container/art/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "container/art/adaptive_radix_tree.h"
+
+namespace bustub {
+
+namespace {
+enum NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+// version of an inner node: bit 0 marks the node obsolete, bit 1 is the lock, the rest counts the modifications
+constexpr uint64_t OBSOLETE_BIT = 0b01;
+constexpr uint64_t LOCKED_BIT = 0b10;
+
+bool ReadLockOrRestart(const std::atomic<uint64_t> &version, uint64_t *v) {
+  *v = version.load();
+  return (*v & (LOCKED_BIT | OBSOLETE_BIT)) == 0;
+}
+
+bool CheckOrRestart(const std::atomic<uint64_t> &version, uint64_t v) {
+  // 验证之前读到的节点内容，这些普通读不能被重排到版本号之后
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return version.load() == v;
+}
+
+bool UpgradeToWriteLockOrRestart(std::atomic<uint64_t> *version, uint64_t v) {
+  return version->compare_exchange_strong(v, v + LOCKED_BIT);
+}
+
+void WriteUnlock(std::atomic<uint64_t> *version) { version->fetch_add(LOCKED_BIT); }
+
+void WriteUnlockObsolete(std::atomic<uint64_t> *version) { version->fetch_add(LOCKED_BIT | OBSOLETE_BIT); }
+
+void ThrowPrefixKey() {
+  throw Exception(ExceptionType::INVALID, "adaptive radix tree keys must not be prefixes of each other");
+}
+}  // namespace
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+struct AdaptiveRadixTree::Node {
+  explicit Node(uint8_t type) : type_(type) {}
+  const uint8_t type_;
+};
+
+struct AdaptiveRadixTree::Leaf : public Node {
+  Leaf(std::string_view key, std::vector<RID> values) : Node(LEAF), key_(key), values_(std::move(values)) {}
+  const std::string key_;
+  const std::vector<RID> values_;
+};
+
+struct AdaptiveRadixTree::InnerNode : public Node {
+  explicit InnerNode(uint8_t type) : Node(type) {}
+  std::atomic<uint64_t> version_{0};
+  uint8_t prefix_size_{0};
+  uint8_t prefix_[ART_MAX_PREFIX]{};
+  uint16_t count_{0};
+};
+
+template <int Capacity>
+struct AdaptiveRadixTree::SmallNode : public InnerNode {
+  SmallNode() : InnerNode(Capacity == 4 ? NODE4 : NODE16) {}
+
+  Node *Find(uint8_t byte) const {
+    // 乐观读时count_可能正在变化，不能越界
+    int count = std::min<int>(count_, Capacity);
+    for (int i = 0; i < count; i++) {
+      if (keys_[i] == byte) {
+        return children_[i];
+      }
+    }
+    return nullptr;
+  }
+  void Add(uint8_t byte, Node *child) {
+    keys_[count_] = byte;
+    children_[count_] = child;
+    count_++;
+  }
+  void Replace(uint8_t byte, Node *child) {
+    for (int i = 0; i < count_; i++) {
+      if (keys_[i] == byte) {
+        children_[i] = child;
+      }
+    }
+  }
+  void Remove(uint8_t byte) {
+    for (int i = 0; i < count_; i++) {
+      if (keys_[i] == byte) {
+        keys_[i] = keys_[count_ - 1];
+        children_[i] = children_[count_ - 1];
+        count_--;
+        return;
+      }
+    }
+  }
+  template <typename F>
+  void ForEach(F &&f) const {
+    for (int i = 0; i < count_; i++) {
+      f(keys_[i], children_[i]);
+    }
+  }
+
+  uint8_t keys_[Capacity]{};
+  Node *children_[Capacity]{};
+};
+
+struct AdaptiveRadixTree::Node48 : public InnerNode {
+  Node48() : InnerNode(NODE48) {}
+
+  Node *Find(uint8_t byte) const {
+    uint8_t index = child_index_[byte];
+    return index == 0 ? nullptr : children_[index - 1];
+  }
+  void Add(uint8_t byte, Node *child) {
+    int slot = 0;
+    while (children_[slot] != nullptr) {
+      slot++;
+    }
+    children_[slot] = child;
+    child_index_[byte] = slot + 1;
+    count_++;
+  }
+  void Replace(uint8_t byte, Node *child) { children_[child_index_[byte] - 1] = child; }
+  void Remove(uint8_t byte) {
+    children_[child_index_[byte] - 1] = nullptr;
+    child_index_[byte] = 0;
+    count_--;
+  }
+  template <typename F>
+  void ForEach(F &&f) const {
+    for (int byte = 0; byte < 256; byte++) {
+      if (child_index_[byte] != 0) {
+        f(static_cast<uint8_t>(byte), children_[child_index_[byte] - 1]);
+      }
+    }
+  }
+
+  // 孩子所在的槽位加一，0表示没有这个孩子
+  uint8_t child_index_[256]{};
+  Node *children_[48]{};
+};
+
+struct AdaptiveRadixTree::Node256 : public InnerNode {
+  Node256() : InnerNode(NODE256) {}
+
+  Node *Find(uint8_t byte) const { return children_[byte]; }
+  void Add(uint8_t byte, Node *child) {
+    children_[byte] = child;
+    count_++;
+  }
+  void Replace(uint8_t byte, Node *child) { children_[byte] = child; }
+  void Remove(uint8_t byte) {
+    children_[byte] = nullptr;
+    count_--;
+  }
+  template <typename F>
+  void ForEach(F &&f) const {
+    for (int byte = 0; byte < 256; byte++) {
+      if (children_[byte] != nullptr) {
+        f(static_cast<uint8_t>(byte), children_[byte]);
+      }
+    }
+  }
+
+  Node *children_[256]{};
+};
+
+/*****************************************************************************
+ * NODE HELPERS
+ *****************************************************************************/
+AdaptiveRadixTree::InnerNode *AdaptiveRadixTree::NewNode(uint8_t type) {
+  switch (type) {
+    case NODE4:
+      return new SmallNode<4>();
+    case NODE16:
+      return new SmallNode<16>();
+    case NODE48:
+      return new Node48();
+    default:
+      return new Node256();
+  }
+}
+
+// 按节点类型分派到具体的实现
+#define ART_DISPATCH(node, call)                          \
+  switch ((node)->type_) {                                \
+    case NODE4:                                           \
+      return static_cast<SmallNode<4> *>(node)->call;     \
+    case NODE16:                                          \
+      return static_cast<SmallNode<16> *>(node)->call;    \
+    case NODE48:                                          \
+      return static_cast<Node48 *>(node)->call;           \
+    default:                                              \
+      return static_cast<Node256 *>(node)->call;          \
+  }
+
+AdaptiveRadixTree::Node *AdaptiveRadixTree::FindChild(const InnerNode *node, uint8_t byte) {
+  ART_DISPATCH(const_cast<InnerNode *>(node), Find(byte));
+}
+
+template <typename F>
+void AdaptiveRadixTree::ForEachChild(const InnerNode *node, F &&f) {
+  ART_DISPATCH(const_cast<InnerNode *>(node), ForEach(std::forward<F>(f)));
+}
+
+void AdaptiveRadixTree::AddChild(InnerNode *node, uint8_t byte, Node *child) { ART_DISPATCH(node, Add(byte, child)); }
+
+void AdaptiveRadixTree::ReplaceChild(InnerNode *node, uint8_t byte, Node *child) {
+  ART_DISPATCH(node, Replace(byte, child));
+}
+
+void AdaptiveRadixTree::RemoveChild(InnerNode *node, uint8_t byte) { ART_DISPATCH(node, Remove(byte)); }
+
+#undef ART_DISPATCH
+
+bool AdaptiveRadixTree::IsFull(const InnerNode *node) {
+  switch (node->type_) {
+    case NODE4:
+      return node->count_ == 4;
+    case NODE16:
+      return node->count_ == 16;
+    case NODE48:
+      return node->count_ == 48;
+    default:
+      return false;
+  }
+}
+
+bool AdaptiveRadixTree::ShouldShrink(const InnerNode *node) {
+  // 缩小后留一些空位，避免在边界上反复扩大缩小
+  switch (node->type_) {
+    case NODE16:
+      return node->count_ <= 4;
+    case NODE48:
+      return node->count_ <= 13;
+    case NODE256:
+      return node->count_ <= 38;
+    default:
+      return false;
+  }
+}
+
+AdaptiveRadixTree::InnerNode *AdaptiveRadixTree::CopyAs(const InnerNode *node, uint8_t type, int skip) {
+  InnerNode *copy = NewNode(type);
+  copy->prefix_size_ = node->prefix_size_;
+  memcpy(copy->prefix_, node->prefix_, node->prefix_size_);
+  ForEachChild(node, [&](uint8_t byte, Node *child) {
+    if (byte != skip) {
+      AddChild(copy, byte, child);
+    }
+  });
+  return copy;
+}
+
+size_t AdaptiveRadixTree::PrefixMatch(const InnerNode *node, std::string_view key, size_t depth) {
+  size_t prefix_size = std::min<size_t>(node->prefix_size_, ART_MAX_PREFIX);
+  size_t match = 0;
+  while (match < prefix_size && depth + match < key.size() &&
+         node->prefix_[match] == static_cast<uint8_t>(key[depth + match])) {
+    match++;
+  }
+  return match;
+}
+
+AdaptiveRadixTree::Node *AdaptiveRadixTree::MakeBranch(Leaf *first, Leaf *second, size_t depth) {
+  const std::string &a = first->key_;
+  const std::string &b = second->key_;
+  size_t end = depth;
+  while (end < a.size() && end < b.size() && a[end] == b[end]) {
+    end++;
+  }
+  if (end == a.size() || end == b.size()) {
+    return nullptr;
+  }
+  // 公共部分超过ART_MAX_PREFIX时拆成一串只有一个孩子的节点
+  InnerNode *top = nullptr;
+  InnerNode *last = nullptr;
+  uint8_t last_byte = 0;
+  size_t pos = depth;
+  while (true) {
+    InnerNode *node = NewNode(NODE4);
+    size_t take = std::min(ART_MAX_PREFIX, end - pos);
+    memcpy(node->prefix_, a.data() + pos, take);
+    node->prefix_size_ = take;
+    if (last == nullptr) {
+      top = node;
+    } else {
+      AddChild(last, last_byte, node);
+    }
+    pos += take;
+    if (pos == end) {
+      AddChild(node, a[pos], first);
+      AddChild(node, b[pos], second);
+      return top;
+    }
+    last = node;
+    last_byte = a[pos];
+    pos++;
+  }
+}
+
+void AdaptiveRadixTree::FreeNode(Node *node) {
+  switch (node->type_) {
+    case LEAF:
+      delete static_cast<Leaf *>(node);
+      break;
+    case NODE4:
+      delete static_cast<SmallNode<4> *>(node);
+      break;
+    case NODE16:
+      delete static_cast<SmallNode<16> *>(node);
+      break;
+    case NODE48:
+      delete static_cast<Node48 *>(node);
+      break;
+    default:
+      delete static_cast<Node256 *>(node);
+      break;
+  }
+}
+
+void AdaptiveRadixTree::FreeTree(Node *node) {
+  if (node->type_ != LEAF) {
+    ForEachChild(static_cast<InnerNode *>(node), [](uint8_t /*byte*/, Node *child) { FreeTree(child); });
+  }
+  FreeNode(node);
+}
+
+size_t AdaptiveRadixTree::CountInnerNodes(const Node *node) {
+  if (node->type_ == LEAF) {
+    return 0;
+  }
+  size_t count = 1;
+  ForEachChild(static_cast<const InnerNode *>(node),
+               [&count](uint8_t /*byte*/, Node *child) { count += CountInnerNodes(child); });
+  return count;
+}
+
+/*****************************************************************************
+ * EPOCHS
+ *****************************************************************************/
+/**
+ * Registers an operation in the current epoch for its whole duration.
+ */
+class AdaptiveRadixTree::EpochGuard {
+ public:
+  explicit EpochGuard(AdaptiveRadixTree *tree) : tree_(tree) {
+    // 计数之后epoch变了就重新登记，保证登记的epoch不落后
+    while (true) {
+      epoch_ = tree_->epoch_.load();
+      tree_->active_[epoch_ % 3].fetch_add(1);
+      if (tree_->epoch_.load() == epoch_) {
+        break;
+      }
+      tree_->active_[epoch_ % 3].fetch_sub(1);
+    }
+  }
+
+  ~EpochGuard() {
+    tree_->active_[epoch_ % 3].fetch_sub(1);
+    if (tree_->retired_count_.load() > 0) {
+      tree_->TryAdvanceEpoch();
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+ private:
+  AdaptiveRadixTree *tree_;
+  uint64_t epoch_;
+};
+
+void AdaptiveRadixTree::Retire(Node *node) {
+  std::scoped_lock lock(epoch_latch_);
+  retired_[epoch_.load() % 3].push_back(node);
+  retired_count_++;
+}
+
+void AdaptiveRadixTree::TryAdvanceEpoch() {
+  // 别的线程正在推进时不用等
+  std::unique_lock lock(epoch_latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  uint64_t epoch = epoch_.load();
+  if (epoch > 0) {
+    // 进入epoch - 1的操作都结束后，epoch - 1里退休的节点不会再被任何操作访问
+    auto &previous = active_[(epoch - 1) % 3];
+    if (previous.load() != 0) {
+      return;
+    }
+    auto &retired = retired_[(epoch - 1) % 3];
+    for (Node *node : retired) {
+      FreeNode(node);
+    }
+    retired_count_ -= retired.size();
+    retired.clear();
+  }
+  epoch_.store(epoch + 1);
+}
+
+/*****************************************************************************
+ * PUBLIC
+ *****************************************************************************/
+AdaptiveRadixTree::AdaptiveRadixTree() : root_(NewNode(NODE256)) {}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() {
+  FreeTree(root_);
+  for (auto &retired : retired_) {
+    for (Node *node : retired) {
+      FreeNode(node);
+    }
+  }
+}
+
+bool AdaptiveRadixTree::Insert(std::string_view key, const RID &value) {
+  EpochGuard guard(this);
+  while (true) {
+    std::optional<bool> result = TryInsert(key, value);
+    if (result.has_value()) {
+      return *result;
+    }
+  }
+}
+
+bool AdaptiveRadixTree::Remove(std::string_view key, const RID &value) {
+  EpochGuard guard(this);
+  while (true) {
+    std::optional<bool> result = TryRemove(key, value);
+    if (result.has_value()) {
+      return *result;
+    }
+  }
+}
+
+bool AdaptiveRadixTree::GetValue(std::string_view key, std::vector<RID> *result) {
+  EpochGuard guard(this);
+  while (true) {
+    size_t size = result->size();
+    std::optional<bool> found = TryGetValue(key, result);
+    if (found.has_value()) {
+      return *found;
+    }
+    result->resize(size);
+  }
+}
+
+size_t AdaptiveRadixTree::GetInnerNodeCount() const { return CountInnerNodes(root_); }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+std::optional<bool> AdaptiveRadixTree::TryGetValue(std::string_view key, std::vector<RID> *result) {
+  InnerNode *node = root_;
+  uint64_t version;
+  if (!ReadLockOrRestart(node->version_, &version)) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  while (true) {
+    size_t prefix_size = node->prefix_size_;
+    if (PrefixMatch(node, key, depth) < prefix_size || depth + prefix_size >= key.size()) {
+      if (!CheckOrRestart(node->version_, version)) {
+        return std::nullopt;
+      }
+      return false;
+    }
+    depth += prefix_size;
+    Node *child = FindChild(node, key[depth]);
+    // 确认读到的孩子指针有效后才能访问孩子
+    if (!CheckOrRestart(node->version_, version)) {
+      return std::nullopt;
+    }
+    if (child == nullptr) {
+      return false;
+    }
+    if (child->type_ == LEAF) {
+      // 叶子创建后不再修改，不需要加锁
+      auto *leaf = static_cast<Leaf *>(child);
+      if (leaf->key_ != key) {
+        return false;
+      }
+      result->insert(result->end(), leaf->values_.begin(), leaf->values_.end());
+      return true;
+    }
+    auto *inner = static_cast<InnerNode *>(child);
+    uint64_t child_version;
+    if (!ReadLockOrRestart(inner->version_, &child_version) || !CheckOrRestart(node->version_, version)) {
+      return std::nullopt;
+    }
+    node = inner;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+std::optional<bool> AdaptiveRadixTree::TryInsert(std::string_view key, const RID &value) {
+  InnerNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  InnerNode *node = root_;
+  uint64_t version;
+  if (!ReadLockOrRestart(node->version_, &version)) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  while (true) {
+    size_t prefix_size = node->prefix_size_;
+    size_t match = PrefixMatch(node, key, depth);
+    if (match < prefix_size) {
+      // 前缀不匹配时在不匹配的位置插入一个新节点，根节点没有前缀，所以一定有父节点
+      if (!UpgradeToWriteLockOrRestart(&parent->version_, parent_version)) {
+        return std::nullopt;
+      }
+      if (!UpgradeToWriteLockOrRestart(&node->version_, version)) {
+        WriteUnlock(&parent->version_);
+        return std::nullopt;
+      }
+      if (depth + match >= key.size()) {
+        WriteUnlock(&node->version_);
+        WriteUnlock(&parent->version_);
+        ThrowPrefixKey();
+      }
+      InnerNode *branch = NewNode(NODE4);
+      branch->prefix_size_ = match;
+      memcpy(branch->prefix_, node->prefix_, match);
+      AddChild(branch, node->prefix_[match], node);
+      AddChild(branch, key[depth + match], new Leaf(key, {value}));
+      std::copy(node->prefix_ + match + 1, node->prefix_ + prefix_size, node->prefix_);
+      node->prefix_size_ = prefix_size - match - 1;
+      ReplaceChild(parent, parent_byte, branch);
+      WriteUnlock(&node->version_);
+      WriteUnlock(&parent->version_);
+      return true;
+    }
+    depth += prefix_size;
+    if (depth >= key.size()) {
+      if (!CheckOrRestart(node->version_, version)) {
+        return std::nullopt;
+      }
+      ThrowPrefixKey();
+    }
+    auto byte = static_cast<uint8_t>(key[depth]);
+    Node *child = FindChild(node, byte);
+    if (!CheckOrRestart(node->version_, version)) {
+      return std::nullopt;
+    }
+
+    if (child == nullptr) {
+      if (!IsFull(node)) {
+        if (!UpgradeToWriteLockOrRestart(&node->version_, version)) {
+          return std::nullopt;
+        }
+        AddChild(node, byte, new Leaf(key, {value}));
+        WriteUnlock(&node->version_);
+        return true;
+      }
+      // 节点满了换成下一个大小的节点，根节点是Node256不会满，所以一定有父节点
+      if (!UpgradeToWriteLockOrRestart(&parent->version_, parent_version)) {
+        return std::nullopt;
+      }
+      if (!UpgradeToWriteLockOrRestart(&node->version_, version)) {
+        WriteUnlock(&parent->version_);
+        return std::nullopt;
+      }
+      InnerNode *bigger = CopyAs(node, node->type_ + 1, -1);
+      AddChild(bigger, byte, new Leaf(key, {value}));
+      ReplaceChild(parent, parent_byte, bigger);
+      WriteUnlockObsolete(&node->version_);
+      WriteUnlock(&parent->version_);
+      Retire(node);
+      return true;
+    }
+
+    if (child->type_ == LEAF) {
+      if (!UpgradeToWriteLockOrRestart(&node->version_, version)) {
+        return std::nullopt;
+      }
+      auto *leaf = static_cast<Leaf *>(child);
+      if (leaf->key_ == key) {
+        if (std::find(leaf->values_.begin(), leaf->values_.end(), value) != leaf->values_.end()) {
+          WriteUnlock(&node->version_);
+          return false;
+        }
+        // 叶子不能原地修改，复制一份加上新的value
+        std::vector<RID> values = leaf->values_;
+        values.push_back(value);
+        ReplaceChild(node, byte, new Leaf(key, std::move(values)));
+        WriteUnlock(&node->version_);
+        Retire(leaf);
+        return true;
+      }
+      auto *new_leaf = new Leaf(key, {value});
+      Node *branch = MakeBranch(leaf, new_leaf, depth + 1);
+      if (branch == nullptr) {
+        WriteUnlock(&node->version_);
+        delete new_leaf;
+        ThrowPrefixKey();
+      }
+      ReplaceChild(node, byte, branch);
+      WriteUnlock(&node->version_);
+      return true;
+    }
+
+    auto *inner = static_cast<InnerNode *>(child);
+    uint64_t child_version;
+    if (!ReadLockOrRestart(inner->version_, &child_version) || !CheckOrRestart(node->version_, version)) {
+      return std::nullopt;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = inner;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+std::optional<bool> AdaptiveRadixTree::TryRemove(std::string_view key, const RID &value) {
+  // 从根到叶子的父节点经过的节点，以及通往下一层的byte
+  struct Step {
+    InnerNode *node_;
+    uint64_t version_;
+    uint8_t byte_;
+  };
+  std::vector<Step> path;
+  Leaf *leaf = nullptr;
+  InnerNode *node = root_;
+  uint64_t version;
+  if (!ReadLockOrRestart(node->version_, &version)) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  while (true) {
+    size_t prefix_size = node->prefix_size_;
+    if (PrefixMatch(node, key, depth) < prefix_size || depth + prefix_size >= key.size()) {
+      if (!CheckOrRestart(node->version_, version)) {
+        return std::nullopt;
+      }
+      return false;
+    }
+    depth += prefix_size;
+    auto byte = static_cast<uint8_t>(key[depth]);
+    Node *child = FindChild(node, byte);
+    if (!CheckOrRestart(node->version_, version)) {
+      return std::nullopt;
+    }
+    if (child == nullptr) {
+      return false;
+    }
+    path.push_back({node, version, byte});
+    if (child->type_ == LEAF) {
+      leaf = static_cast<Leaf *>(child);
+      break;
+    }
+    auto *inner = static_cast<InnerNode *>(child);
+    if (!ReadLockOrRestart(inner->version_, &version) || !CheckOrRestart(node->version_, path.back().version_)) {
+      return std::nullopt;
+    }
+    node = inner;
+    depth++;
+  }
+
+  auto found = std::find(leaf->values_.begin(), leaf->values_.end(), value);
+  if (leaf->key_ != key || found == leaf->values_.end()) {
+    return false;
+  }
+  if (leaf->values_.size() > 1) {
+    if (!UpgradeToWriteLockOrRestart(&node->version_, version)) {
+      return std::nullopt;
+    }
+    std::vector<RID> values = leaf->values_;
+    values.erase(values.begin() + (found - leaf->values_.begin()));
+    ReplaceChild(node, path.back().byte_, new Leaf(key, std::move(values)));
+    WriteUnlock(&node->version_);
+    Retire(leaf);
+    return true;
+  }
+
+  // 删掉最后一个孩子的节点整个摘掉，一直向上直到还剩别的孩子的节点top
+  size_t top = path.size() - 1;
+  while (path[top].node_ != root_ && path[top].node_->count_ == 1) {
+    top--;
+  }
+  node = path[top].node_;
+  uint8_t byte = path[top].byte_;
+  // top只剩一个孩子时：叶子存的是完整的key，连同上面只有一个孩子的节点一起换成这个叶子；
+  // 内部节点的前缀放得下时把top的前缀合并进去；否则太空的top换成小一号的节点
+  Node *other = nullptr;
+  uint8_t other_byte = 0;
+  uint64_t other_version = 0;
+  bool merge = false;
+  bool replace = false;
+  // 被替换的节点挂在path[link]下面
+  size_t link = top - 1;
+  if (node != root_) {
+    if (node->count_ == 2) {
+      ForEachChild(node, [&](uint8_t child_byte, Node *child) {
+        if (child_byte != byte) {
+          other = child;
+          other_byte = child_byte;
+        }
+      });
+      if (!CheckOrRestart(node->version_, path[top].version_)) {
+        return std::nullopt;
+      }
+      if (other->type_ == LEAF) {
+        replace = true;
+        while (path[link].node_ != root_ && path[link].node_->count_ == 1) {
+          link--;
+        }
+      } else if (node->prefix_size_ + 1U + static_cast<InnerNode *>(other)->prefix_size_ <= ART_MAX_PREFIX) {
+        if (!ReadLockOrRestart(static_cast<InnerNode *>(other)->version_, &other_version)) {
+          return std::nullopt;
+        }
+        merge = true;
+        replace = true;
+      }
+    }
+    replace = replace || ShouldShrink(node);
+  }
+
+  // 自上而下锁住要修改、替换和摘掉的节点以及合并的孩子，任何一个的版本变了都重来
+  std::vector<InnerNode *> locked;
+  auto lock = [&locked](InnerNode *inner, uint64_t inner_version) {
+    if (!UpgradeToWriteLockOrRestart(&inner->version_, inner_version)) {
+      for (InnerNode *locked_node : locked) {
+        WriteUnlock(&locked_node->version_);
+      }
+      return false;
+    }
+    locked.push_back(inner);
+    return true;
+  };
+  for (size_t i = replace ? link : top; i < path.size(); i++) {
+    if (!lock(path[i].node_, path[i].version_)) {
+      return std::nullopt;
+    }
+  }
+  if (merge && !lock(static_cast<InnerNode *>(other), other_version)) {
+    return std::nullopt;
+  }
+
+  if (!replace) {
+    RemoveChild(node, byte);
+    WriteUnlock(&node->version_);
+    link = top;
+  } else {
+    InnerNode *parent = path[link].node_;
+    if (merge) {
+      auto *inner = static_cast<InnerNode *>(other);
+      InnerNode *merged = CopyAs(inner, inner->type_, -1);
+      memcpy(merged->prefix_, node->prefix_, node->prefix_size_);
+      merged->prefix_[node->prefix_size_] = other_byte;
+      memcpy(merged->prefix_ + node->prefix_size_ + 1, inner->prefix_, inner->prefix_size_);
+      merged->prefix_size_ = node->prefix_size_ + 1 + inner->prefix_size_;
+      ReplaceChild(parent, path[link].byte_, merged);
+      WriteUnlockObsolete(&inner->version_);
+      Retire(inner);
+    } else if (other != nullptr && other->type_ == LEAF) {
+      ReplaceChild(parent, path[link].byte_, other);
+    } else {
+      ReplaceChild(parent, path[link].byte_, CopyAs(node, node->type_ - 1, byte));
+    }
+    WriteUnlock(&parent->version_);
+  }
+  // path[link]下面的节点都不再可达
+  for (size_t i = link + 1; i < path.size(); i++) {
+    WriteUnlockObsolete(&path[i].node_->version_);
+    Retire(path[i].node_);
+  }
+  Retire(leaf);
+  return true;
+}
+
+}  // namespace bustub
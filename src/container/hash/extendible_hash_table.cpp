@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -26,8 +30,26 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                      const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
-  directory_page_id_ = INVALID_PAGE_ID;
+  // 先创建HeaderPage，每个操作开始时pin它，结束时unpin
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id_);
+  assert(page != nullptr);
+  auto *header_page = reinterpret_cast<HashTableDirectoryHeaderPage *>(page->GetData());
+  header_page->SetPageId(header_page_id_);
+  // 然后创建第一个DirectoryPage
+  page_id_t new_page_id_dir;
+  page = buffer_pool_manager_->NewPage(&new_page_id_dir);
+  assert(page != nullptr);
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  dir_page->SetPageId(new_page_id_dir);
+  AddDirectoryPage(header_page, new_page_id_dir);
+  // 最后为空的directory创建第一个bucket
+  page_id_t new_page_id_buc;
+  page = buffer_pool_manager_->NewPage(&new_page_id_buc);
+  assert(page != nullptr);
+  dir_page->SetBucketPageId(0, new_page_id_buc);
+  buffer_pool_manager_->UnpinPage(new_page_id_dir, true);
+  buffer_pool_manager_->UnpinPage(new_page_id_buc, true);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,54 +68,297 @@ uint32_t HASH_TABLE_TYPE::Hash(KeyType key) {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) {
-  return Hash(key) & dir_page->GetGlobalDepthMask();
+inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryHeaderPage *header_page) {
+  return Hash(key) & header_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline uint32_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) {
-  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+inline page_id_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryHeaderPage *header_page) {
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, header_page);
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, bucket_idx);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx % DIRECTORY_ARRAY_SIZE);
+  buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false);
+  return bucket_page_id;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
-  HashTableDirectoryPage *ret;
-  // 创建
-  directory_lock_.lock();
-  if (directory_page_id_ == INVALID_PAGE_ID) {
-    // 先创建DirectoryPage
-    page_id_t new_page_id_dir;
-    Page *page = buffer_pool_manager_->NewPage(&new_page_id_dir);
-    assert(page != nullptr);
-    ret = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
-    directory_page_id_ = new_page_id_dir;
-    ret->SetPageId(directory_page_id_);
-    // 然后创建为空的directory创建第一个bucket
-    page_id_t new_page_id_buc;
-    page = nullptr;
-    page = buffer_pool_manager_->NewPage(&new_page_id_buc);
+HashTableDirectoryHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage() {
+  // 调用者负责Unpin
+  Page *page = buffer_pool_manager_->FetchPage(header_page_id_);
+  assert(page != nullptr);
+  return reinterpret_cast<HashTableDirectoryHeaderPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::GetDirectoryPageId(HashTableDirectoryHeaderPage *header_page, uint32_t directory_idx) {
+  // 每一层索引页解析目录页号中的DIRECTORY_INDEX_PAGE_DEPTH位，header解析剩下的最高位
+  uint32_t shift = DIRECTORY_INDEX_PAGE_DEPTH * header_page->GetIndexLevels();
+  page_id_t page_id = header_page->GetChildPageId(directory_idx >> shift);
+  while (shift > 0) {
+    shift -= DIRECTORY_INDEX_PAGE_DEPTH;
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
     assert(page != nullptr);
-    ret->SetBucketPageId(0, new_page_id_buc);
-    // 最后Unpin这两个页面??????
-    assert(buffer_pool_manager_->UnpinPage(new_page_id_dir, true));
-    assert(buffer_pool_manager_->UnpinPage(new_page_id_buc, true));
-  }
-  directory_lock_.unlock();
-  
-  // 从buffer中获取页面
-  assert(directory_page_id_ != INVALID_PAGE_ID);
-  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+    auto *index_page = reinterpret_cast<HashTableDirectoryIndexPage *>(page->GetData());
+    page_id_t child_page_id = index_page->GetChildPageId((directory_idx >> shift) & (DIRECTORY_INDEX_ARRAY_SIZE - 1));
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child_page_id;
+  }
+  return page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::NewDirectoryIndexPage() {
+  page_id_t index_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&index_page_id);
   assert(page != nullptr);
-  ret = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  reinterpret_cast<HashTableDirectoryIndexPage *>(page->GetData())->SetPageId(index_page_id);
+  buffer_pool_manager_->UnpinPage(index_page_id, true);
+  return index_page_id;
+}
 
-  return ret;
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::AddDirectoryPage(HashTableDirectoryHeaderPage *header_page, page_id_t directory_page_id) {
+  uint32_t directory_idx = header_page->NumDirectoryPages();
+  // header已经满了：把它的孩子整体移到一个新的索引页中，新索引页成为header的第一个孩子，索引树加高一层
+  uint32_t shift = DIRECTORY_INDEX_PAGE_DEPTH * header_page->GetIndexLevels();
+  if ((directory_idx >> shift) == HEADER_ARRAY_SIZE) {
+    page_id_t index_page_id = NewDirectoryIndexPage();
+    Page *page = buffer_pool_manager_->FetchPage(index_page_id);
+    assert(page != nullptr);
+    auto *index_page = reinterpret_cast<HashTableDirectoryIndexPage *>(page->GetData());
+    for(uint32_t i = 0; i < HEADER_ARRAY_SIZE; i++) {
+      index_page->SetChildPageId(i, header_page->GetChildPageId(i));
+    }
+    buffer_pool_manager_->UnpinPage(index_page_id, true);
+    header_page->SetChildPageId(0, index_page_id);
+    header_page->IncrIndexLevels();
+    shift += DIRECTORY_INDEX_PAGE_DEPTH;
+  }
+
+  // 从header往下走，新目录页是某个孩子覆盖的第一个目录页时，这个孩子还不存在，需要新建
+  uint32_t child_idx = directory_idx >> shift;
+  if ((directory_idx & ((1U << shift) - 1)) == 0) {
+    header_page->SetChildPageId(child_idx, shift == 0 ? directory_page_id : NewDirectoryIndexPage());
+  }
+  page_id_t page_id = header_page->GetChildPageId(child_idx);
+  while (shift > 0) {
+    shift -= DIRECTORY_INDEX_PAGE_DEPTH;
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    assert(page != nullptr);
+    auto *index_page = reinterpret_cast<HashTableDirectoryIndexPage *>(page->GetData());
+    child_idx = (directory_idx >> shift) & (DIRECTORY_INDEX_ARRAY_SIZE - 1);
+    bool is_new_child = (directory_idx & ((1U << shift) - 1)) == 0;
+    if (is_new_child) {
+      index_page->SetChildPageId(child_idx, shift == 0 ? directory_page_id : NewDirectoryIndexPage());
+    }
+    page_id_t child_page_id = index_page->GetChildPageId(child_idx);
+    buffer_pool_manager_->UnpinPage(page_id, is_new_child);
+    page_id = child_page_id;
+  }
+  header_page->IncrNumDirectoryPages();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
-  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage(HashTableDirectoryHeaderPage *header_page,
+                                                            uint32_t bucket_idx) {
+  // 目录索引bucket_idx位于第bucket_idx / DIRECTORY_ARRAY_SIZE个目录页，调用者负责Unpin
+  page_id_t dir_page_id = GetDirectoryPageId(header_page, bucket_idx / DIRECTORY_ARRAY_SIZE);
+  Page *page = buffer_pool_manager_->FetchPage(dir_page_id);
   assert(page != nullptr);
-  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id, Page **page) {
+  *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  assert(*page != nullptr);
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>((*page)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::LookupBucket(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx,
+                                        uint32_t *local_depth) {
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, bucket_idx);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx % DIRECTORY_ARRAY_SIZE);
+  *local_depth = dir_page->GetLocalDepth(bucket_idx % DIRECTORY_ARRAY_SIZE);
+  buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::SetBuckets(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx, uint32_t local_depth,
+                                 page_id_t bucket_page_id) {
+  // 与bucket_idx低local_depth位相同的目录项每隔2^local_depth出现一次，可能分布在多个目录页中。
+  // 深度可以到32，所以用64位计算
+  uint64_t diff = uint64_t{1} << local_depth;
+  uint64_t size = uint64_t{1} << header_page->GetGlobalDepth();
+  HashTableDirectoryPage *dir_page = nullptr;
+  uint64_t dir_idx = 0;
+  for(uint64_t i = bucket_idx & (diff - 1); i < size; i += diff) {
+    if (dir_page == nullptr || dir_idx != i / DIRECTORY_ARRAY_SIZE) {
+      if (dir_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), true);
+      }
+      dir_idx = i / DIRECTORY_ARRAY_SIZE;
+      dir_page = FetchDirectoryPage(header_page, static_cast<uint32_t>(i));
+    }
+    dir_page->SetBucketPageId(i % DIRECTORY_ARRAY_SIZE, bucket_page_id);
+    dir_page->SetLocalDepth(i % DIRECTORY_ARRAY_SIZE, local_depth);
+  }
+  buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::GrowDirectory(HashTableDirectoryHeaderPage *header_page) {
+  uint32_t num_dir_pages = header_page->Size();
+  for(uint32_t i = 0; i < num_dir_pages; i++) {
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, i * DIRECTORY_ARRAY_SIZE);
+    dir_page->IncrGlobalDepth();
+    // 一个目录页已经装满，需要把每个目录页复制到后半部分对应的目录页中
+    if (header_page->GetGlobalDepth() >= DIRECTORY_PAGE_DEPTH) {
+      uint32_t image_idx = i + num_dir_pages;
+      Page *image_page;
+      if (image_idx < header_page->NumDirectoryPages()) {
+        image_page = buffer_pool_manager_->FetchPage(GetDirectoryPageId(header_page, image_idx));
+      } else {
+        page_id_t image_page_id;
+        image_page = buffer_pool_manager_->NewPage(&image_page_id);
+        AddDirectoryPage(header_page, image_page_id);
+      }
+      assert(image_page != nullptr);
+      memcpy(image_page->GetData(), reinterpret_cast<char *>(dir_page), PAGE_SIZE);
+      reinterpret_cast<HashTableDirectoryPage *>(image_page->GetData())->SetPageId(image_page->GetPageId());
+      buffer_pool_manager_->UnpinPage(image_page->GetPageId(), true);
+    }
+    buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), true);
+  }
+  header_page->IncrGlobalDepth();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::CanShrink(HashTableDirectoryHeaderPage *header_page) {
+  if (header_page->GetGlobalDepth() == 0) {
+    return false;
+  }
+  // 整个Directory能不能收缩取决于每个目录页中的localdepth是否都比globaldepth小
+  for(uint32_t i = 0; i < header_page->Size(); i++) {
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, i * DIRECTORY_ARRAY_SIZE);
+    bool can_shrink = dir_page->CanShrink();
+    buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false);
+    if (!can_shrink) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ShrinkDirectory(HashTableDirectoryHeaderPage *header_page) {
+  header_page->DecrGlobalDepth();
+  // 后半部分的目录页不再使用，但仍保留在header中，下次扩展时复用
+  for(uint32_t i = 0; i < header_page->Size(); i++) {
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, i * DIRECTORY_ARRAY_SIZE);
+    dir_page->DecrGlobalDepth();
+    buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), true);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::SplitBucketTo(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx,
+                                    page_id_t bucket_page_id, uint32_t local_depth, uint32_t target_depth) {
+  Page *bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id, &bucket_page);
+  bucket_page->WLatch();
+
+  uint32_t origin_array_size = bucket->NumReadable();
+  MappingType *origin_array = bucket->GetArrayCopy();
+  std::vector<uint32_t> origin_hashes(origin_array_size);
+  for(uint32_t i = 0; i < origin_array_size; i++) {
+    origin_hashes[i] = Hash(origin_array[i].first);
+  }
+  bucket->Reset();
+
+  // 第local_depth到target_depth-1位决定数据属于哪个新桶，第0个新桶沿用原来的page。
+  // 每次只pin一个新桶，避免一次分裂出大量桶时占满buffer pool
+  uint32_t num_images = 1 << (target_depth - local_depth);
+  for(uint32_t k = 0; k < num_images; k++) {
+    page_id_t image_page_id = bucket_page_id;
+    HASH_TABLE_BUCKET_TYPE *image_bucket = bucket;
+    if (k != 0) {
+      Page *image_page = buffer_pool_manager_->NewPage(&image_page_id);
+      assert(image_page != nullptr);
+      image_bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData());
+    }
+    for(uint32_t i = 0; i < origin_array_size; i++) {
+      if (((origin_hashes[i] >> local_depth) & (num_images - 1)) == k) {
+        // 原桶中的数据没有重复，每个新桶最多分到原桶那么多数据，插入不会失败
+        [[maybe_unused]] bool inserted =
+            image_bucket->Insert(origin_array[i].first, origin_array[i].second, comparator_);
+        assert(inserted);
+      }
+    }
+    SetBuckets(header_page, bucket_idx | (k << local_depth), target_depth, image_page_id);
+    if (k != 0) {
+      buffer_pool_manager_->UnpinPage(image_page_id, true);
+    }
+  }
+  delete[] origin_array;
+
+  bucket_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::SameHash(HASH_TABLE_BUCKET_TYPE *bucket, uint32_t hash) {
+  for(uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+    if(bucket->IsReadable(i) && Hash(bucket->KeyAt(i)) != hash) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::LatchBucketPage(HashTableDirectoryHeaderPage *header_page, const KeyType &key,
+                                                         bool exclusive, Page **page) {
+  while (true) {
+    // 版本号为奇数说明目录正在被修改，等待修改完成
+    uint64_t version = directory_version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    page_id_t bucket_page_id = KeyToPageId(key, header_page);
+    HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id, page);
+    if (exclusive) {
+      (*page)->WLatch();
+    } else {
+      (*page)->RLatch();
+    }
+    // 拿到桶的latch后版本号没有变化，说明读到的映射有效；分裂/合并在修改目录前会先拿桶的写latch，
+    // 所以在释放桶latch之前这个映射不会再改变
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (directory_version_.load(std::memory_order_relaxed) == version) {
+      return bucket;
+    }
+    if (exclusive) {
+      (*page)->WUnlatch();
+    } else {
+      (*page)->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::BeginDirectoryUpdate() {
+  directory_version_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::EndDirectoryUpdate() {
+  directory_version_.fetch_add(1, std::memory_order_release);
 }
 
 /*****************************************************************************
@@ -101,20 +366,15 @@ HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_i
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  Page *bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  bucket_page->RLatch();
-  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  Page *bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket = LatchBucketPage(header_page, key, false, &bucket_page);
   // 读取数据
   bool ret = bucket->GetValue(key, comparator_, result);
-  bucket_page->RUnlatch(); 
-
-  assert(buffer_pool_manager_->UnpinPage(bucket_page_id, false));
-  assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
+  bucket_page->RUnlatch();
 
-  table_latch_.RUnlock();
+  buffer_pool_manager_->UnpinPage(bucket_page->GetPageId(), false);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
   return ret;
 }
 
@@ -123,154 +383,234 @@ bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  Page *bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  bucket_page->WLatch();
-  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  Page *bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket = LatchBucketPage(header_page, key, true, &bucket_page);
+  page_id_t bucket_page_id = bucket_page->GetPageId();
   // 如果bucket没满，直接插入即可
   if(!bucket->IsFull()) {
     bool ret = bucket->Insert(key, value, comparator_);
+    if(ret) {
+      num_pairs_.fetch_add(1, std::memory_order_relaxed);
+    }
     bucket_page->WUnlatch();
-    assert(buffer_pool_manager_->UnpinPage(bucket_page_id, true));
-    assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
-    table_latch_.RUnlock();
-
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
     return ret;
   }
 
   bucket_page->WUnlatch();
-  assert(buffer_pool_manager_->UnpinPage(bucket_page_id, false));
-  assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
-
-  table_latch_.RUnlock();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
   return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  // table latch只在分裂/合并之间互斥，读写操作不再获取它
   table_latch_.WLock();
-  // 获取目录页，进而得到key对应的桶索引、桶深度
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  int64_t split_bucket_index = KeyToDirectoryIndex(key, dir_page);
-  uint32_t split_bucket_depth = dir_page->GetLocalDepth(split_bucket_index);
-
-  // 容量满了，不能扩展
-  if(split_bucket_depth >= MAX_BUCKET_DEPTH) {
-    assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  // 得到key对应的桶索引、桶深度
+  uint32_t split_bucket_index = KeyToDirectoryIndex(key, header_page);
+  uint32_t split_bucket_depth;
+  page_id_t split_bucket_page_id = LookupBucket(header_page, split_bucket_index, &split_bucket_depth);
+
+  // 先拿到要分裂的桶的写latch，等待正在访问该桶的读写操作结束
+  Page *split_bucket_page;
+  HASH_TABLE_BUCKET_TYPE *split_bucket = FetchBucketPage(split_bucket_page_id, &split_bucket_page);
+  split_bucket_page->WLatch();
+
+  // 容量满了，不能扩展；或者在等待期间有删除让出了空间，直接重试插入。
+  // 桶里的数据和key的hash完全相同时，再怎么分裂也分不开，同样插入失败，而不是把目录一直扩展到最大深度
+  if(split_bucket_depth >= MAX_BUCKET_DEPTH || !split_bucket->IsFull() || SameHash(split_bucket, Hash(key))) {
+    bool full = split_bucket->IsFull();
+    split_bucket_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(split_bucket_page_id, false);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
     table_latch_.WUnlock();
-    return false;
-  }
-  
-  // 目录页是否需要扩展
-  if(split_bucket_depth == dir_page->GetGlobalDepth()) {
-    dir_page->IncrGlobalDepth();
+    return full ? false : Insert(transaction, key, value);
   }
 
-  // 增加local depth
-  dir_page->IncrLocalDepth(split_bucket_index);
+  // 创建一个image bucket，在修改目录之前它对其他线程不可见
+  page_id_t image_bucket_page_id;
+  Page *image_bucket_page = buffer_pool_manager_->NewPage(&image_bucket_page_id);
+  assert(image_bucket_page != nullptr);
+  image_bucket_page->WLatch();
+  auto *image_bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_bucket_page->GetData());
 
-  // 获取当前bucket，先将数据保存下来，然后重新初始化它
-  page_id_t split_bucket_page_id = KeyToPageId(key, dir_page);
-  Page *split_bucket_page = buffer_pool_manager_->FetchPage(split_bucket_page_id);
-  split_bucket_page->WLatch();
+  // 开始修改目录，乐观读者会在版本号变化后重试
+  BeginDirectoryUpdate();
 
-  HASH_TABLE_BUCKET_TYPE *split_bucket = FetchBucketPage(split_bucket_page_id);
+  // 目录是否需要扩展
+  if(split_bucket_depth == header_page->GetGlobalDepth()) {
+    GrowDirectory(header_page);
+  }
+
+  // 分裂后两个桶的local depth都加一，第split_bucket_depth位决定key属于哪个桶
+  uint32_t new_depth = split_bucket_depth + 1;
+  uint32_t high_bit = 1U << split_bucket_depth;
+  uint32_t split_image_bucket_index = (split_bucket_index & (high_bit - 1)) | high_bit;
+  split_bucket_index &= high_bit - 1;
+
+  // 先将当前bucket的数据保存下来，然后重新初始化它
   uint32_t origin_array_size = split_bucket->NumReadable();
   MappingType *origin_array = split_bucket->GetArrayCopy();
   split_bucket->Reset();
 
-  // 创建一个image bucket，并初始化该image bucket
-  page_id_t image_bucket_page_id;
-  Page *image_bucket_page = buffer_pool_manager_->NewPage(&image_bucket_page_id);
-  assert(image_bucket_page != nullptr);
-  image_bucket_page->WLatch();
-  HASH_TABLE_BUCKET_TYPE *image_bucket = FetchBucketPage(image_bucket_page_id);
-  uint32_t split_image_bucket_index = dir_page->GetSplitImageIndex(split_bucket_index);
-  dir_page->SetLocalDepth(split_image_bucket_index, dir_page->GetLocalDepth(split_bucket_index));
-  dir_page->SetBucketPageId(split_image_bucket_index, image_bucket_page_id);
-
   // 重新插入数据
   for(uint32_t i = 0; i < origin_array_size; i++) {
-    uint32_t target_bucket_index = Hash(origin_array[i].first) & dir_page->GetLocalDepthMask(split_bucket_index);
-    page_id_t target_bucket_index_page = dir_page->GetBucketPageId(target_bucket_index);
-    assert(target_bucket_index_page == split_bucket_page_id || target_bucket_index_page == image_bucket_page_id);
     // 这里根据新计算的hash结果决定插入那个bucket
-    if (target_bucket_index_page == split_bucket_page_id) {
-      assert(split_bucket->Insert(origin_array[i].first, origin_array[i].second, comparator_));
-    } else {
-      assert(image_bucket->Insert(origin_array[i].first, origin_array[i].second, comparator_));
-    }
+    HASH_TABLE_BUCKET_TYPE *target = (Hash(origin_array[i].first) & high_bit) == 0 ? split_bucket : image_bucket;
+    // 原桶中的数据没有重复，分到两个同样大小的桶中不会插入失败
+    [[maybe_unused]] bool inserted = target->Insert(origin_array[i].first, origin_array[i].second, comparator_);
+    assert(inserted);
   }
   delete[] origin_array;
 
   // 将同一级的bucket设置为相同的local_depth和page
-  uint32_t diff = 1 << dir_page->GetLocalDepth(split_bucket_index);
-  for(uint32_t i = split_bucket_index; i >= diff; i -= diff) {
-    dir_page->SetBucketPageId(i, split_bucket_page_id);
-    dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(split_bucket_index));
-  }
-  for(uint32_t i = split_bucket_index; i < dir_page->Size(); i += diff) {
-    dir_page->SetBucketPageId(i, split_bucket_page_id);
-    dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(split_bucket_index));
-  }  
-  for(uint32_t i = split_image_bucket_index; i >= diff; i -= diff) {
-    dir_page->SetBucketPageId(i, image_bucket_page_id);
-    dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(split_bucket_index));
-  }
-  for(uint32_t i = split_image_bucket_index; i < dir_page->Size(); i += diff) {
-    dir_page->SetBucketPageId(i, image_bucket_page_id);
-    dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(split_bucket_index));
-  }  
+  SetBuckets(header_page, split_bucket_index, new_depth, split_bucket_page_id);
+  SetBuckets(header_page, split_image_bucket_index, new_depth, image_bucket_page_id);
 
+  EndDirectoryUpdate();
   split_bucket_page->WUnlatch();
   image_bucket_page->WUnlatch();
 
   // Unpin
-  assert(buffer_pool_manager_->UnpinPage(split_bucket_page_id, true));
-  assert(buffer_pool_manager_->UnpinPage(image_bucket_page_id, true));
-  assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), true));
+  buffer_pool_manager_->UnpinPage(split_bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(image_bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 
   table_latch_.WUnlock();
   // 最后重新尝试插入
   return Insert(transaction, key, value);
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::BulkInsert(Transaction *transaction,
+                                 const std::vector<std::pair<KeyType, ValueType>> &entries) {
+  if(entries.empty()) {
+    return true;
+  }
+
+  // 按表中已有的数据加上这一批，每个桶装到3/4估算需要的桶数，据此决定预先扩展到的深度，之后填充时基本不会再分裂。
+  // 分批加载时，每一批都会把已经装满的桶再分裂开
+  const size_t num_pairs = num_pairs_.load(std::memory_order_relaxed) + entries.size();
+  uint32_t depth = 0;
+  while (depth < MAX_BUCKET_DEPTH && (static_cast<size_t>(BUCKET_ARRAY_SIZE * 3 / 4) << depth) < num_pairs) {
+    depth++;
+  }
+
+  table_latch_.WLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  BeginDirectoryUpdate();
+
+  while (header_page->GetGlobalDepth() < depth) {
+    GrowDirectory(header_page);
+  }
+  // 把local depth小于depth的桶一次分裂到depth。按目录索引从小到大遍历，第一次遇到某个桶时
+  // 一定是在它最小的目录索引上，分裂之后后面的目录项都已经更新为depth
+  for(uint32_t i = 0; i < (1U << depth); i++) {
+    uint32_t local_depth;
+    page_id_t bucket_page_id = LookupBucket(header_page, i, &local_depth);
+    if(local_depth < depth) {
+      SplitBucketTo(header_page, i, bucket_page_id, local_depth, depth);
+    }
+  }
+
+  // 按hash的低depth位做计数排序，同一分区的数据都落在同一个桶，或者由它分裂出来的更深的桶中
+  uint32_t num_partitions = 1 << depth;
+  std::vector<uint32_t> hashes(entries.size());
+  std::vector<uint32_t> offsets(num_partitions + 1, 0);
+  for(size_t i = 0; i < entries.size(); i++) {
+    hashes[i] = Hash(entries[i].first);
+    offsets[(hashes[i] & (num_partitions - 1)) + 1]++;
+  }
+  for(uint32_t p = 0; p < num_partitions; p++) {
+    offsets[p + 1] += offsets[p];
+  }
+  std::vector<uint32_t> order(entries.size());
+  std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+  for(size_t i = 0; i < entries.size(); i++) {
+    order[next[hashes[i] & (num_partitions - 1)]++] = i;
+  }
+
+  // 按分区顺序填充，每个桶只latch一次；桶满了的数据留到最后走普通的Insert
+  bool ret = true;
+  std::vector<uint32_t> overflow;
+  uint32_t global_depth_mask = header_page->GetGlobalDepthMask();
+  Page *bucket_page = nullptr;
+  HASH_TABLE_BUCKET_TYPE *bucket = nullptr;
+  for(uint32_t p = 0; p < num_partitions; p++) {
+    if(offsets[p] == offsets[p + 1]) {
+      continue;
+    }
+    uint32_t local_depth;
+    page_id_t partition_page_id = LookupBucket(header_page, p, &local_depth);
+    for(uint32_t j = offsets[p]; j < offsets[p + 1]; j++) {
+      uint32_t e = order[j];
+      page_id_t bucket_page_id = partition_page_id;
+      if(local_depth > depth) {
+        uint32_t unused_depth;
+        bucket_page_id = LookupBucket(header_page, hashes[e] & global_depth_mask, &unused_depth);
+      }
+      if(bucket_page == nullptr || bucket_page->GetPageId() != bucket_page_id) {
+        if(bucket_page != nullptr) {
+          bucket_page->WUnlatch();
+          buffer_pool_manager_->UnpinPage(bucket_page->GetPageId(), true);
+        }
+        bucket = FetchBucketPage(bucket_page_id, &bucket_page);
+        bucket_page->WLatch();
+      }
+      if(bucket->IsFull()) {
+        overflow.push_back(e);
+      } else if(bucket->Insert(entries[e].first, entries[e].second, comparator_)) {
+        num_pairs_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        ret = false;
+      }
+    }
+  }
+  if(bucket_page != nullptr) {
+    bucket_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page->GetPageId(), true);
+  }
+
+  EndDirectoryUpdate();
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  table_latch_.WUnlock();
+
+  num_overflow_pairs_.fetch_add(overflow.size(), std::memory_order_relaxed);
+  for(uint32_t e : overflow) {
+    ret = Insert(transaction, entries[e].first, entries[e].second) && ret;
+  }
+  return ret;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  //uint32_t bucket_index = KeyToDirectoryIndex(key, dir_page);
-  Page *bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  bucket_page->WLatch();
-  
-  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  Page *bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket = LatchBucketPage(header_page, key, true, &bucket_page);
+  page_id_t bucket_page_id = bucket_page->GetPageId();
 
   // 删除Key-value
   bool ret = bucket->Remove(key, value, comparator_);
-
-  // 为空则合并
-  if(bucket->IsEmpty()) {
-    // Unpin
-    bucket_page->WUnlatch();
-    assert(buffer_pool_manager_->UnpinPage(bucket_page_id, true));
-    assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
-
-    table_latch_.RUnlock();
-    Merge(transaction, key, value);
-    return ret;
+  if(ret) {
+    num_pairs_.fetch_sub(1, std::memory_order_relaxed);
   }
+  bool empty = bucket->IsEmpty();
   bucket_page->WUnlatch();
   // Unpin
-  assert(buffer_pool_manager_->UnpinPage(bucket_page_id, true));
-  assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
+  buffer_pool_manager_->UnpinPage(bucket_page_id, ret);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
 
-  table_latch_.RUnlock();
+  // 为空则合并
+  if(empty) {
+    Merge(transaction, key, value);
+  }
   return ret;
 }
 
@@ -280,66 +620,62 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.WLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t target_bucket_index = KeyToDirectoryIndex(key, dir_page);
-  page_id_t target_bucket_page_id = dir_page->GetBucketPageId(target_bucket_index);
-  uint32_t image_bucket_index = dir_page->GetSplitImageIndex(target_bucket_index);
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  uint32_t target_bucket_index = KeyToDirectoryIndex(key, header_page);
+  uint32_t local_depth;
+  page_id_t target_bucket_page_id = LookupBucket(header_page, target_bucket_index, &local_depth);
 
   // local depth为0说明已经最小了，不收缩
-  uint32_t local_depth = dir_page->GetLocalDepth(target_bucket_index);
   if(local_depth == 0) {
-    assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
     table_latch_.WUnlock();
     return ;
   }
 
   // 如果该bucket与其split image深度不同，也不收缩
-  if(local_depth != dir_page->GetLocalDepth(image_bucket_index)) {
-    assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
+  uint32_t image_bucket_index = target_bucket_index ^ (1U << (local_depth - 1));
+  uint32_t image_local_depth;
+  page_id_t image_bucket_page_id = LookupBucket(header_page, image_bucket_index, &image_local_depth);
+  if(local_depth != image_local_depth) {
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
     table_latch_.WUnlock();
     return;
   }
 
-  // 如果target bucket不为空，则不收缩
-  HASH_TABLE_BUCKET_TYPE *target_bucket = FetchBucketPage(target_bucket_page_id);
-  Page *target_bucket_page = buffer_pool_manager_->FetchPage(target_bucket_page_id); 
-  target_bucket_page->RLatch();
+  // 如果target bucket不为空，则不收缩；持有写latch直到目录修改完成，阻止并发插入
+  Page *target_bucket_page;
+  HASH_TABLE_BUCKET_TYPE *target_bucket = FetchBucketPage(target_bucket_page_id, &target_bucket_page);
+  target_bucket_page->WLatch();
 
   if(!target_bucket->IsEmpty()) {
-    target_bucket_page->RUnlatch();
-    assert(buffer_pool_manager_->UnpinPage(target_bucket_page_id, false));
-    assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false));
+    target_bucket_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(target_bucket_page_id, false);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
     table_latch_.WUnlock();
     return;
   }
 
-  target_bucket_page->RUnlatch();
-  // 删除target bucket，此时该bucket已经为空
-  assert(buffer_pool_manager_->UnpinPage(target_bucket_page_id, false));
-  assert(buffer_pool_manager_->DeletePage(target_bucket_page_id));
+  // 开始修改目录，乐观读者会在版本号变化后重试
+  BeginDirectoryUpdate();
 
-  // 设置target bucket的page为split image的page，即合并target和split
-  page_id_t image_bucket_page_id = dir_page->GetBucketPageId(image_bucket_index);
-  dir_page->SetBucketPageId(target_bucket_index, image_bucket_page_id);
-  dir_page->DecrLocalDepth(target_bucket_index);
-  dir_page->DecrLocalDepth(image_bucket_index);
-  assert(dir_page->GetLocalDepth(target_bucket_index) == dir_page->GetLocalDepth(image_bucket_index));
-
-  //  遍历整个directory，将所有指向target bucket page的bucket全部重新指向split image bucket的page
-  for(uint32_t i = 0; i < dir_page->Size(); i++) {
-    if(dir_page->GetBucketPageId(i) == target_bucket_page_id || dir_page->GetBucketPageId(i) == image_bucket_page_id) {
-      dir_page->SetBucketPageId(i, image_bucket_page_id);
-      dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(target_bucket_index));
-    }
-  }
+  // 将所有指向target bucket和split image的目录项全部指向split image bucket的page，即合并target和split
+  SetBuckets(header_page, image_bucket_index, local_depth - 1, image_bucket_page_id);
 
   // 尝试收缩Directory
   // 这里要循环，不能只收缩一次
-  while (dir_page->CanShrink()) {
-    dir_page->DecrGlobalDepth();
+  while (CanShrink(header_page)) {
+    ShrinkDirectory(header_page);
   }
 
-  assert(buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), true));
+  EndDirectoryUpdate();
+  target_bucket_page->WUnlatch();
+
+  // 删除target bucket，此时该bucket已经为空且不在目录中。
+  // 若旧版本的读者仍pin着它则删除失败，该页面只是不再被引用，读者校验版本号后会放弃它
+  buffer_pool_manager_->UnpinPage(target_bucket_page_id, false);
+  buffer_pool_manager_->DeletePage(target_bucket_page_id);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+
   table_latch_.WUnlock();
 }
 
@@ -349,9 +685,9 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  uint32_t global_depth = header_page->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
   table_latch_.RUnlock();
   return global_depth;
 }
@@ -362,9 +698,46 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  uint32_t global_depth = header_page->GetGlobalDepth();
+  if (global_depth <= DIRECTORY_PAGE_DEPTH) {
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, 0);
+    dir_page->VerifyIntegrity();
+    buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false, nullptr);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    table_latch_.RUnlock();
+    return;
+  }
+
+  // 目录跨越多个目录页时，在整个目录上检查相同的不变式
+  std::unordered_map<page_id_t, uint32_t> page_id_to_count;
+  std::unordered_map<page_id_t, uint32_t> page_id_to_ld;
+  for (uint32_t i = 0; i < header_page->Size(); i++) {
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(header_page, i * DIRECTORY_ARRAY_SIZE);
+    assert(dir_page->GetGlobalDepth() == global_depth);
+    for (uint32_t slot = 0; slot < DIRECTORY_ARRAY_SIZE; slot++) {
+      page_id_t curr_page_id = dir_page->GetBucketPageId(slot);
+      uint32_t curr_ld = dir_page->GetLocalDepth(slot);
+      assert(curr_ld <= global_depth);
+      ++page_id_to_count[curr_page_id];
+      if (page_id_to_ld.count(curr_page_id) > 0 && curr_ld != page_id_to_ld[curr_page_id]) {
+        LOG_WARN("Verify Integrity: curr_local_depth: %u, old_local_depth %u, for page_id: %u", curr_ld,
+                 page_id_to_ld[curr_page_id], curr_page_id);
+        assert(curr_ld == page_id_to_ld[curr_page_id]);
+      }
+      page_id_to_ld[curr_page_id] = curr_ld;
+    }
+    buffer_pool_manager_->UnpinPage(dir_page->GetPageId(), false, nullptr);
+  }
+  for (const auto &[curr_page_id, curr_count] : page_id_to_count) {
+    uint32_t required_count = 0x1 << (global_depth - page_id_to_ld[curr_page_id]);
+    if (curr_count != required_count) {
+      LOG_WARN("Verify Integrity: curr_count: %u, required_count %u, for page_id: %u", curr_count, required_count,
+               curr_page_id);
+      assert(curr_count == required_count);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
   table_latch_.RUnlock();
 }
 
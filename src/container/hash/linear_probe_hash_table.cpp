@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -22,25 +23,196 @@
 
 namespace bustub {
 
+// 每次操作前最多迁移的旧block数
+static constexpr size_t MIGRATE_BLOCKS_PER_OP = 2;
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  // header页在整个哈希表的生命周期内保持pin
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id_);
+  assert(page != nullptr);
+  header_page_ = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header_page_->SetPageId(header_page_id_);
+  // 桶数向上取整到整数个block
+  size_t num_blocks = std::max<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    page = buffer_pool_manager_->NewPage(&block_page_id);
+    assert(page != nullptr);
+    header_page_->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  header_page_->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Func>
+bool HASH_TABLE_TYPE::Probe(bool old_table, const KeyType &key, bool is_dirty, Func &&visit) {
+  size_t size = old_table ? header_page_->GetOldSize() : header_page_->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  HASH_TABLE_BLOCK_TYPE *block = nullptr;
+  bool stopped = false;
+  for (size_t i = 0; i < size && !stopped; i++, slot = (slot + 1) % size) {
+    // 探测跨过block边界（或回绕到表头）时换下一个block
+    if (block == nullptr || slot % BLOCK_ARRAY_SIZE == 0) {
+      if (block != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+      }
+      size_t block_index = slot / BLOCK_ARRAY_SIZE;
+      block_page_id =
+          old_table ? header_page_->GetOldBlockPageId(block_index) : header_page_->GetBlockPageId(block_index);
+      Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+      assert(page != nullptr);
+      block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    }
+    stopped = visit(block, slot % BLOCK_ARRAY_SIZE);
+  }
+  if (block != nullptr) {
+    buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+  }
+  return stopped;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::InsertIntoTable(const KeyType &key, const ValueType &value, bool *duplicate) {
+  bool inserted = false;
+  Probe(false, key, true, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      // 占用失败说明其他线程抢先插入了这个slot，继续向后探测
+      inserted = block->Insert(offset, key, value);
+      return inserted;
+    }
+    if (duplicate != nullptr && block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 &&
+        block->ValueAt(offset) == value) {
+      *duplicate = true;
+      return true;
+    }
+    return false;
+  });
+  if (inserted) {
+    num_occupied_++;
+  }
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateBlocks(size_t max_blocks) {
+  for (size_t n = 0; n < max_blocks && header_page_->IsMigrating(); n++) {
+    page_id_t old_page_id = header_page_->GetOldBlockPageId(header_page_->GetNextMigrateIndex());
+    Page *page = buffer_pool_manager_->FetchPage(old_page_id);
+    assert(page != nullptr);
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+      if (!block->IsReadable(offset)) {
+        continue;
+      }
+      // 新表放不下时数据留在旧表中，迁移停在这个block，下次再继续
+      if (!InsertIntoTable(block->KeyAt(offset), block->ValueAt(offset), nullptr)) {
+        LOG_WARN("LinearProbeHashTable: cannot migrate an entry, the new table is full");
+        buffer_pool_manager_->UnpinPage(old_page_id, true);
+        return;
+      }
+      // 旧表中只留下墓碑，经过这里的探测序列不会中断，也不会重复读到已经迁走的数据
+      block->Remove(offset);
+    }
+    buffer_pool_manager_->UnpinPage(old_page_id, true);
+    header_page_->IncrNextMigrateIndex();
+
+    // 旧表已经全部迁移完，释放旧的block页
+    if (header_page_->GetNextMigrateIndex() == header_page_->NumOldBlocks()) {
+      for (size_t i = 0; i < header_page_->NumOldBlocks(); i++) {
+        buffer_pool_manager_->DeletePage(header_page_->GetOldBlockPageId(i));
+      }
+      header_page_->FinishMigration();
+      migrating_ = false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateSome() {
+  if (!migrating_) {
+    return;
+  }
+  table_latch_.WLock();
+  MigrateBlocks(MIGRATE_BLOCKS_PER_OP);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  MigrateSome();
+  table_latch_.RLock();
+  bool found = false;
+  auto collect = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      return true;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+    return false;
+  };
+  // 迁移期间数据可能还在旧表中，两张表都要探测
+  if (header_page_->IsMigrating()) {
+    Probe(true, key, false, collect);
+  }
+  Probe(false, key, false, collect);
+  table_latch_.RUnlock();
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  MigrateSome();
+  table_latch_.RLock();
+  bool duplicate = false;
+  // 迁移期间旧表中可能已经有相同的数据
+  if (header_page_->IsMigrating()) {
+    Probe(true, key, false, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+      if (!block->IsOccupied(offset)) {
+        return true;
+      }
+      duplicate =
+          block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value;
+      return duplicate;
+    });
+  }
+  // 新数据总是插入新表
+  bool inserted = !duplicate && InsertIntoTable(key, value, &duplicate);
+  size_t size = header_page_->GetSize();
+  table_latch_.RUnlock();
+
+  if (duplicate) {
+    return false;
+  }
+  if (!inserted) {
+    // 表已经满了（一般负载因子会先触发扩容），同步扩容后重试；header页放不下更多block时插入失败
+    Resize(size);
+    if (GetSize() == size) {
+      return false;
+    }
+    return Insert(transaction, key, value);
+  }
+  // 被占用的slot超过一半时开始扩容，之后的操作逐步迁移数据
+  if (!migrating_ && num_occupied_ * 2 > size) {
+    Resize(size);
+  }
+  return true;
 }
 
 /*****************************************************************************
@@ -48,21 +220,89 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  MigrateSome();
+  table_latch_.RLock();
+  bool removed = false;
+  auto remove = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      return true;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value) {
+      block->Remove(offset);
+      removed = true;
+      return true;
+    }
+    return false;
+  };
+  if (header_page_->IsMigrating()) {
+    Probe(true, key, true, remove);
+  }
+  if (!removed) {
+    Probe(false, key, true, remove);
+  }
+  table_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  // 其他线程已经扩容过了
+  if (header_page_->GetSize() >= 2 * initial_size) {
+    table_latch_.WUnlock();
+    return;
+  }
+  // 上一次扩容还没有迁移完，先把剩下的block迁移完
+  MigrateBlocks(header_page_->NumOldBlocks());
+  if (header_page_->IsMigrating()) {
+    table_latch_.WUnlock();
+    return;
+  }
+
+  size_t num_blocks = (2 * initial_size + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE;
+  if (header_page_->NumBlocks() + num_blocks > HashTableHeaderPage::MaxBlocks()) {
+    LOG_WARN("LinearProbeHashTable: header page cannot hold %zu more blocks", num_blocks);
+    table_latch_.WUnlock();
+    return;
+  }
+  // 只分配新的block，数据由之后的操作逐步迁移。先分配好所有的页，buffer pool满了就放弃这次扩容
+  std::vector<page_id_t> block_page_ids;
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&block_page_id);
+    if (page == nullptr) {
+      LOG_WARN("LinearProbeHashTable: no free frame to resize the table");
+      for (page_id_t allocated : block_page_ids) {
+        buffer_pool_manager_->DeletePage(allocated);
+      }
+      table_latch_.WUnlock();
+      return;
+    }
+    block_page_ids.push_back(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  header_page_->BeginMigration();
+  for (page_id_t block_page_id : block_page_ids) {
+    header_page_->AddBlockPageId(block_page_id);
+  }
+  header_page_->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  num_occupied_ = 0;
+  migrating_ = true;
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = header_page_->GetSize();
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -9,20 +9,448 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <limits>
 #include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <vector>
 
+#include "common/exception.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/morsel_scheduler.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return The tag a slot stores for a hash, never 0 */
+uint32_t Tag(hash_t hash) { return static_cast<uint32_t>(hash >> 32) | 1; }
+
+/** @return The partition of a group hash, taken from its high bits because the tables use the low ones */
+size_t PartitionOf(hash_t hash) { return (hash >> 56) % AggregationExecutor::NUM_PARTITIONS; }
+
+/** @return `true` if two group-by values belong to the same group */
+bool SameGroup(const Value &left, const Value &right) {
+  if (left.IsNull() || right.IsNull()) {
+    return left.IsNull() && right.IsNull();
+  }
+  return left.CompareEquals(right) == CmpBool::CmpTrue;
+}
+
+bool IsInteger(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+int64_t AsInt64(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return value.GetAs<int64_t>();
+    default:
+      return value.CastAs(TypeId::BIGINT).GetAs<int64_t>();
+  }
+}
+
+/** @return An integer aggregate as a value of the type */
+Value MakeValue(TypeId type, int64_t value) {
+  switch (type) {
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(value));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(value));
+    case TypeId::BIGINT:
+      return Value(type, value);
+    default:
+      if (value < BUSTUB_INT32_MIN || value > BUSTUB_INT32_MAX) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "Integer value out of range.");
+      }
+      return Value(type, static_cast<int32_t>(value));
+  }
+}
+
+void AddInt64(int64_t *result, int64_t input) {
+  if (__builtin_add_overflow(*result, input, result)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+  }
+}
+
+}  // namespace
+
+AggregationHashTable::AggregationHashTable(size_t num_group_bys,
+                                           const std::vector<const AbstractExpression *> &agg_exprs,
+                                           const std::vector<AggregationType> &agg_types)
+    : num_group_bys_{num_group_bys}, agg_types_{agg_types}, slots_(16, Slot{0, 0}) {
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    input_types_.push_back(agg_exprs[i]->GetReturnType());
+    typed_.push_back(agg_types_[i] == AggregationType::CountAggregate || IsInteger(input_types_[i]));
+  }
+}
+
+hash_t AggregationHashTable::HashKey(const std::vector<std::vector<Value>> &group_by_columns, uint32_t row) {
+  hash_t hash = 0;
+  for (const auto &column : group_by_columns) {
+    if (!column[row].IsNull()) {
+      hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&column[row]));
+    }
+  }
+  return HashUtil::MixHash(hash);
+}
+
+template <typename KeyAt>
+uint32_t AggregationHashTable::FindOrInsert(hash_t hash, KeyAt &&key_at) {
+  const uint32_t tag = Tag(hash);
+  const size_t mask = slots_.size() - 1;
+  size_t pos = hash & mask;
+  for (; slots_[pos].tag_ != 0; pos = (pos + 1) & mask) {
+    if (slots_[pos].tag_ != tag) {
+      continue;
+    }
+    const Value *key = &keys_[slots_[pos].group_ * num_group_bys_];
+    size_t i = 0;
+    while (i < num_group_bys_ && SameGroup(key[i], key_at(i))) {
+      i++;
+    }
+    if (i == num_group_bys_) {
+      return slots_[pos].group_;
+    }
+  }
+
+  // A new group, with the initial aggregates
+  auto group = static_cast<uint32_t>(hashes_.size());
+  hashes_.push_back(hash);
+  for (size_t i = 0; i < num_group_bys_; i++) {
+    keys_.push_back(key_at(i));
+  }
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    // The int64_t accumulators start at the 64-bit bounds so that any input, BIGINT included, replaces them
+    int64_t initial = 0;
+    int32_t initial_value = 0;
+    if (agg_types_[i] == AggregationType::MinAggregate) {
+      initial = std::numeric_limits<int64_t>::max();
+      initial_value = BUSTUB_INT32_MAX;
+    } else if (agg_types_[i] == AggregationType::MaxAggregate) {
+      initial = std::numeric_limits<int64_t>::min();
+      initial_value = BUSTUB_INT32_MIN;
+    }
+    ints_.push_back(initial);
+    nulls_.push_back(0);
+    values_.push_back(typed_[i] ? Value{} : ValueFactory::GetIntegerValue(initial_value));
+  }
+  if (2 * hashes_.size() > slots_.size()) {
+    Grow();
+  } else {
+    slots_[pos] = Slot{tag, group};
+  }
+  return group;
+}
+
+uint32_t AggregationHashTable::FindOrInsert(const std::vector<std::vector<Value>> &group_by_columns, uint32_t row,
+                                            hash_t hash) {
+  return FindOrInsert(hash, [&](size_t i) -> const Value & { return group_by_columns[i][row]; });
+}
+
+void AggregationHashTable::Grow() {
+  slots_.assign(2 * slots_.size(), Slot{0, 0});
+  const size_t mask = slots_.size() - 1;
+  for (uint32_t group = 0; group < hashes_.size(); group++) {
+    size_t pos = hashes_[group] & mask;
+    while (slots_[pos].tag_ != 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots_[pos] = Slot{Tag(hashes_[group]), group};
+  }
+}
+
+void AggregationHashTable::Update(uint32_t group, const std::vector<std::vector<Value>> &aggregate_columns,
+                                  uint32_t row) {
+  const size_t base = group * agg_types_.size();
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    const Value &input = aggregate_columns[i][row];
+    if (agg_types_[i] == AggregationType::CountAggregate) {
+      // Count increases by one.
+      ints_[base + i]++;
+      continue;
+    }
+    if (!typed_[i]) {
+      Value &result = values_[base + i];
+      if (agg_types_[i] == AggregationType::SumAggregate) {
+        result = result.Add(input);
+      } else if (agg_types_[i] == AggregationType::MinAggregate) {
+        result = result.Min(input);
+      } else {
+        result = result.Max(input);
+      }
+      continue;
+    }
+    // Like Value arithmetic, a null input makes the aggregate null
+    if (input.IsNull()) {
+      nulls_[base + i] = 1;
+      continue;
+    }
+    const int64_t value = AsInt64(input);
+    if (agg_types_[i] == AggregationType::SumAggregate) {
+      AddInt64(&ints_[base + i], value);
+    } else if (agg_types_[i] == AggregationType::MinAggregate) {
+      ints_[base + i] = std::min(ints_[base + i], value);
+    } else {
+      ints_[base + i] = std::max(ints_[base + i], value);
+    }
+  }
+}
+
+void AggregationHashTable::Merge(const AggregationHashTable &other) {
+  const size_t num_aggregates = agg_types_.size();
+  for (uint32_t other_group = 0; other_group < other.GetSize(); other_group++) {
+    const Value *other_key = &other.keys_[other_group * num_group_bys_];
+    const uint32_t group =
+        FindOrInsert(other.hashes_[other_group], [&](size_t i) -> const Value & { return other_key[i]; });
+    const size_t base = group * num_aggregates;
+    const size_t other_base = other_group * num_aggregates;
+    for (uint32_t i = 0; i < num_aggregates; i++) {
+      const bool is_sum = agg_types_[i] == AggregationType::CountAggregate ||
+                          agg_types_[i] == AggregationType::SumAggregate;
+      if (!typed_[i]) {
+        Value &result = values_[base + i];
+        const Value &input = other.values_[other_base + i];
+        if (is_sum) {
+          result = result.Add(input);
+        } else if (agg_types_[i] == AggregationType::MinAggregate) {
+          result = result.Min(input);
+        } else {
+          result = result.Max(input);
+        }
+        continue;
+      }
+      nulls_[base + i] |= other.nulls_[other_base + i];
+      const int64_t input = other.ints_[other_base + i];
+      if (is_sum) {
+        AddInt64(&ints_[base + i], input);
+      } else if (agg_types_[i] == AggregationType::MinAggregate) {
+        ints_[base + i] = std::min(ints_[base + i], input);
+      } else {
+        ints_[base + i] = std::max(ints_[base + i], input);
+      }
+    }
+  }
+}
+
+void AggregationHashTable::GetGroup(uint32_t group, std::vector<Value> *group_bys,
+                                    std::vector<Value> *aggregates) const {
+  auto key = keys_.begin() + group * num_group_bys_;
+  group_bys->assign(key, key + num_group_bys_);
+  aggregates->clear();
+  const size_t base = group * agg_types_.size();
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    if (!typed_[i]) {
+      aggregates->push_back(values_[base + i]);
+      continue;
+    }
+    // The types Value arithmetic on the initial integer aggregates ends up with
+    TypeId type = input_types_[i];
+    if (agg_types_[i] == AggregationType::CountAggregate) {
+      type = TypeId::INTEGER;
+    } else if (agg_types_[i] == AggregationType::SumAggregate && type != TypeId::BIGINT) {
+      type = TypeId::INTEGER;
+    }
+    aggregates->push_back(nulls_[base + i] != 0 ? ValueFactory::GetNullValueByType(type)
+                                                : MakeValue(type, ints_[base + i]));
+  }
+}
+
+void AggregationHashTable::Clear() {
+  slots_.assign(16, Slot{0, 0});
+  hashes_.clear();
+  keys_.clear();
+  ints_.clear();
+  nulls_.clear();
+  values_.clear();
+}
+
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {}
+
+std::vector<AggregationHashTable> AggregationExecutor::MakePartitions() const {
+  return std::vector<AggregationHashTable>(
+      NUM_PARTITIONS,
+      AggregationHashTable(plan_->GetGroupBys().size(), plan_->GetAggregates(), plan_->GetAggregateTypes()));
+}
+
+void AggregationExecutor::AggregateBatch(const TupleBatch &batch,
+                                         std::vector<AggregationHashTable> *partitions) const {
+  // Every expression is evaluated over a whole column of the batch.
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  std::vector<std::vector<Value>> group_by_columns(group_bys.size());
+  std::vector<std::vector<Value>> aggregate_columns(aggregates.size());
+  for (uint32_t i = 0; i < group_bys.size(); i++) {
+    group_bys[i]->EvaluateBatch(batch, &group_by_columns[i]);
+  }
+  for (uint32_t i = 0; i < aggregates.size(); i++) {
+    aggregates[i]->EvaluateBatch(batch, &aggregate_columns[i]);
+  }
+  for (uint32_t row = 0; row < batch.GetSize(); row++) {
+    hash_t hash = AggregationHashTable::HashKey(group_by_columns, row);
+    auto &table = (*partitions)[PartitionOf(hash)];
+    table.Update(table.FindOrInsert(group_by_columns, row, hash), aggregate_columns, row);
+  }
+}
+
+void AggregationExecutor::Init() {
+  partitions_ = MakePartitions();
+  partition_idx_ = 0;
+  group_idx_ = 0;
+
+  const size_t num_threads = exec_ctx_->GetNumThreads();
+  if (num_threads == 1) {
+    child_->Init();
+    TupleBatch batch;
+    while (child_->NextBatch(&batch)) {
+      AggregateBatch(batch, &partitions_);
+    }
+    return;
+  }
+
+  std::vector<std::vector<AggregationHashTable>> local_partitions(num_threads, partitions_);
+  const auto *child_plan = plan_->GetChildPlan();
+  if (MorselScheduler::CanRunParallel(exec_ctx_) && MorselScheduler::GetPipelineSource(child_plan) != nullptr) {
+    // Every worker runs the child on morsels of its table itself
+    MorselScheduler::RunPipeline(exec_ctx_, child_plan, [&](size_t worker, size_t morsel, const TupleBatch &batch) {
+      AggregateBatch(batch, &local_partitions[worker]);
+      return true;
+    });
+  } else {
+    child_->Init();
+    AggregateChild(&local_partitions);
+  }
+
+  // Every partition is merged by one thread
+  const size_t num_merge_threads = std::min(num_threads, NUM_PARTITIONS);
+  MorselScheduler::RunWorkers(num_merge_threads, [&](size_t t) {
+    for (size_t p = t; p < NUM_PARTITIONS; p += num_merge_threads) {
+      partitions_[p] = std::move(local_partitions[0][p]);
+      for (size_t i = 1; i < num_threads; i++) {
+        partitions_[p].Merge(local_partitions[i][p]);
+      }
+    }
+  });
+}
+
+void AggregationExecutor::AggregateChild(std::vector<std::vector<AggregationHashTable>> *local_partitions) {
+  // The child is read on this thread while the workers aggregate, with up to two batches per worker queued
+  const size_t num_threads = local_partitions->size();
+  std::mutex latch;
+  std::condition_variable cv;
+  std::deque<TupleBatch> queue;
+  bool done = false;
+  std::exception_ptr error;
+  auto fail = [&](std::exception_ptr exception) {
+    std::scoped_lock lock{latch};
+    if (!error) {
+      error = std::move(exception);
+    }
+    done = true;
+    queue.clear();
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < num_threads; t++) {
+    workers.emplace_back([&, t]() {
+      TupleBatch local_batch;
+      while (true) {
+        {
+          std::unique_lock lock{latch};
+          cv.wait(lock, [&]() { return done || !queue.empty(); });
+          if (queue.empty()) {
+            return;
+          }
+          local_batch = std::move(queue.front());
+          queue.pop_front();
+        }
+        cv.notify_all();
+        try {
+          AggregateBatch(local_batch, &(*local_partitions)[t]);
+        } catch (...) {
+          fail(std::current_exception());
+          cv.notify_all();
+          return;
+        }
+      }
+    });
+  }
+  try {
+    TupleBatch batch;
+    while (child_->NextBatch(&batch)) {
+      std::unique_lock lock{latch};
+      cv.wait(lock, [&]() { return done || queue.size() < 2 * num_threads; });
+      // A worker failed
+      if (done) {
+        break;
+      }
+      queue.push_back(std::move(batch));
+      lock.unlock();
+      cv.notify_all();
+    }
+  } catch (...) {
+    fail(std::current_exception());
+  }
+  {
+    std::scoped_lock lock{latch};
+    done = true;
+  }
+  cv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
+  std::vector<Value> values;
+  if (!NextGroup(&values)) {
+    return false;
+  }
+  *tuple = Tuple(values, GetOutputSchema());
+  return true;
+}
 
-void AggregationExecutor::Init() {}
+bool AggregationExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  std::vector<Value> values;
+  while (!batch->IsFull() && NextGroup(&values)) {
+    batch->AppendRow(&values, RID{});
+  }
+  return batch->GetSize() > 0;
+}
 
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool AggregationExecutor::NextGroup(std::vector<Value> *values) {
+  const auto having = plan_->GetHaving();
+  for (; partition_idx_ < partitions_.size(); partition_idx_++, group_idx_ = 0) {
+    const auto &table = partitions_[partition_idx_];
+    while (group_idx_ < table.GetSize()) {
+      table.GetGroup(group_idx_++, &group_bys_, &aggregates_);
+      if (having != nullptr && !having->EvaluateAggregate(group_bys_, aggregates_).GetAs<bool>()) {
+        continue;
+      }
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values->emplace_back(column.GetExpr()->EvaluateAggregate(group_bys_, aggregates_));
+      }
+      return true;
+    }
+  }
+  return false;
+}
 
 const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
 
@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// comparison_kernels.cpp
+//
+// Identification: src/execution/comparison_kernels.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/comparison_kernels.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+template <ComparisonType Op, typename T>
+bool CompareValues(T lhs, T rhs) {
+  if constexpr (Op == ComparisonType::Equal) {
+    return lhs == rhs;
+  } else if constexpr (Op == ComparisonType::NotEqual) {
+    return lhs != rhs;
+  } else if constexpr (Op == ComparisonType::LessThan) {
+    return lhs < rhs;
+  } else if constexpr (Op == ComparisonType::LessThanOrEqual) {
+    return lhs <= rhs;
+  } else if constexpr (Op == ComparisonType::GreaterThan) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+#ifdef __AVX2__
+template <typename T>
+__m256i Broadcast(T value) {
+  if constexpr (sizeof(T) == 4) {
+    return _mm256_set1_epi32(value);
+  } else {
+    return _mm256_set1_epi64x(value);
+  }
+}
+
+template <typename T>
+__m256i LanesEqual(__m256i lhs, __m256i rhs) {
+  if constexpr (sizeof(T) == 4) {
+    return _mm256_cmpeq_epi32(lhs, rhs);
+  } else {
+    return _mm256_cmpeq_epi64(lhs, rhs);
+  }
+}
+
+template <typename T>
+__m256i LanesGreater(__m256i lhs, __m256i rhs) {
+  if constexpr (sizeof(T) == 4) {
+    return _mm256_cmpgt_epi32(lhs, rhs);
+  } else {
+    return _mm256_cmpgt_epi64(lhs, rhs);
+  }
+}
+
+__m256i LanesNot(__m256i mask) { return _mm256_xor_si256(mask, _mm256_set1_epi32(-1)); }
+
+// AVX2 only has == and >, the other comparisons swap the sides or negate the mask
+template <ComparisonType Op, typename T>
+__m256i CompareLanes(__m256i lhs, __m256i rhs) {
+  if constexpr (Op == ComparisonType::Equal) {
+    return LanesEqual<T>(lhs, rhs);
+  } else if constexpr (Op == ComparisonType::NotEqual) {
+    return LanesNot(LanesEqual<T>(lhs, rhs));
+  } else if constexpr (Op == ComparisonType::LessThan) {
+    return LanesGreater<T>(rhs, lhs);
+  } else if constexpr (Op == ComparisonType::LessThanOrEqual) {
+    return LanesNot(LanesGreater<T>(lhs, rhs));
+  } else if constexpr (Op == ComparisonType::GreaterThan) {
+    return LanesGreater<T>(lhs, rhs);
+  } else {
+    return LanesNot(LanesGreater<T>(rhs, lhs));
+  }
+}
+
+/** @return One bit per lane of the mask, from the sign bits of the lanes */
+template <typename T>
+uint64_t LaneBits(__m256i mask) {
+  if constexpr (sizeof(T) == 4) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+  } else {
+    return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+  }
+}
+#endif
+
+template <typename T, ComparisonType Op, bool ConstantRhs>
+void CompareKernel(const T *lhs, const T *rhs, uint32_t count, uint64_t *bitmap) {
+  uint32_t i = 0;
+#ifdef __AVX2__
+  // A bitmap word at a time
+  constexpr uint32_t lanes = 32 / sizeof(T);
+  const __m256i constant = ConstantRhs ? Broadcast<T>(rhs[0]) : _mm256_setzero_si256();
+  for (; i + 64 <= count; i += 64) {
+    uint64_t word = 0;
+    for (uint32_t j = 0; j < 64; j += lanes) {
+      __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i + j));
+      __m256i right = ConstantRhs ? constant : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i + j));
+      word |= LaneBits<T>(CompareLanes<Op, T>(left, right)) << j;
+    }
+    bitmap[i / 64] = word;
+  }
+#endif
+  // The values that are left, one at a time
+  for (; i < count; i += 64) {
+    uint64_t word = 0;
+    for (uint32_t j = 0; j < 64 && i + j < count; j++) {
+      word |= static_cast<uint64_t>(CompareValues<Op>(lhs[i + j], ConstantRhs ? rhs[0] : rhs[i + j])) << j;
+    }
+    bitmap[i / 64] = word;
+  }
+}
+
+template <typename T, bool ConstantRhs>
+ComparisonKernels::Kernel<T> PickKernel(ComparisonType comp_type) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return &CompareKernel<T, ComparisonType::Equal, ConstantRhs>;
+    case ComparisonType::NotEqual:
+      return &CompareKernel<T, ComparisonType::NotEqual, ConstantRhs>;
+    case ComparisonType::LessThan:
+      return &CompareKernel<T, ComparisonType::LessThan, ConstantRhs>;
+    case ComparisonType::LessThanOrEqual:
+      return &CompareKernel<T, ComparisonType::LessThanOrEqual, ConstantRhs>;
+    case ComparisonType::GreaterThan:
+      return &CompareKernel<T, ComparisonType::GreaterThan, ConstantRhs>;
+    case ComparisonType::GreaterThanOrEqual:
+      return &CompareKernel<T, ComparisonType::GreaterThanOrEqual, ConstantRhs>;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+template <typename T>
+ComparisonKernels::Kernel<T> ComparisonKernels::GetKernel(ComparisonType comp_type, bool constant_rhs) {
+  return constant_rhs ? PickKernel<T, true>(comp_type) : PickKernel<T, false>(comp_type);
+}
+
+template ComparisonKernels::Kernel<int32_t> ComparisonKernels::GetKernel<int32_t>(ComparisonType, bool);
+template ComparisonKernels::Kernel<int64_t> ComparisonKernels::GetKernel<int64_t>(ComparisonType, bool);
+
+ComparisonType ComparisonKernels::Flip(ComparisonType comp_type) {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+uint32_t ComparisonKernels::ToSelection(const uint64_t *bitmap, uint32_t count, uint32_t *selection) {
+  uint32_t selected = 0;
+  for (uint32_t word = 0; word < BitmapWords(count); word++) {
+    // Pop the lowest set bit until none is left
+    for (uint64_t bits = bitmap[word]; bits != 0; bits &= bits - 1) {
+      selection[selected++] = word * 64 + __builtin_ctzll(bits);
+    }
+  }
+  return selected;
+}
+
+}  // namespace bustub
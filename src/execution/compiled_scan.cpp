@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_scan.cpp
+//
+// Identification: src/execution/compiled_scan.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/compiled_scan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "execution/comparison_kernels.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+
+namespace bustub {
+
+namespace {
+
+/** Widens an integer column of type S into values of type T */
+template <typename S, typename T>
+void GatherValues(uint32_t offset, const Tuple *tuples, uint32_t count, T *values) {
+  for (uint32_t i = 0; i < count; i++) {
+    S value;
+    memcpy(&value, tuples[i].GetData() + offset, sizeof(S));
+    values[i] = value;
+  }
+}
+
+/**
+ * Gathers an integer column of the tuples.
+ * @return The null of the column, the smallest value of its type, widened to T
+ */
+template <typename T>
+T GatherColumn(TypeId type, uint32_t offset, const Tuple *tuples, uint32_t count, T *values) {
+  switch (type) {
+    case TypeId::TINYINT:
+      GatherValues<int8_t>(offset, tuples, count, values);
+      return std::numeric_limits<int8_t>::min();
+    case TypeId::SMALLINT:
+      GatherValues<int16_t>(offset, tuples, count, values);
+      return std::numeric_limits<int16_t>::min();
+    case TypeId::INTEGER:
+      GatherValues<int32_t>(offset, tuples, count, values);
+      return std::numeric_limits<int32_t>::min();
+    default:
+      GatherValues<int64_t>(offset, tuples, count, values);
+      return static_cast<T>(std::numeric_limits<int64_t>::min());
+  }
+}
+
+bool IsIntegerType(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+}  // namespace
+
+CompiledScan::CompiledScan(const SeqScanPlanNode *plan, const Schema *table_schema)
+    : table_schema_{table_schema}, predicate_{plan->GetPredicate()} {
+  if (predicate_ != nullptr) {
+    has_kernel_ = CompileFilter(predicate_, table_schema);
+  }
+
+  for (const auto &column : plan->OutputSchema()->GetColumns()) {
+    const auto *expr = dynamic_cast<const ColumnValueExpression *>(column.GetExpr());
+    if (expr == nullptr || expr->GetTupleIdx() != 0 ||
+        table_schema->GetColumn(expr->GetColIdx()).GetType() != column.GetType()) {
+      outputs_.push_back(OutputColumn{column.GetExpr(), column.GetType(), 0, true});
+      continue;
+    }
+    const auto &table_column = table_schema->GetColumn(expr->GetColIdx());
+    outputs_.push_back(
+        OutputColumn{nullptr, table_column.GetType(), table_column.GetOffset(), table_column.IsInlined()});
+  }
+}
+
+std::optional<CompiledScan::Operand> CompiledScan::CompileOperand(const AbstractExpression *expr,
+                                                                  const Schema *table_schema) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    const auto &table_column = table_schema->GetColumn(column->GetColIdx());
+    if (column->GetTupleIdx() != 0 || !IsIntegerType(table_column.GetType())) {
+      return std::nullopt;
+    }
+    return Operand{true, table_column.GetType(), table_column.GetOffset(), 0};
+  }
+  if (const auto *constant = dynamic_cast<const ConstantValueExpression *>(expr); constant != nullptr) {
+    Value value = constant->Evaluate(nullptr, nullptr);
+    if (!IsIntegerType(value.GetTypeId()) || value.IsNull()) {
+      return std::nullopt;
+    }
+    return Operand{false, value.GetTypeId(), 0, value.CastAs(TypeId::BIGINT).GetAs<int64_t>()};
+  }
+  return std::nullopt;
+}
+
+bool CompiledScan::CompileFilter(const AbstractExpression *predicate, const Schema *table_schema) {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison == nullptr) {
+    return false;
+  }
+  auto left = CompileOperand(comparison->GetChildAt(0), table_schema);
+  auto right = CompileOperand(comparison->GetChildAt(1), table_schema);
+  if (!left.has_value() || !right.has_value() || (!left->is_column_ && !right->is_column_)) {
+    return false;
+  }
+  comp_type_ = comparison->GetComparisonType();
+  // The kernels take the constant on the right
+  if (!left->is_column_) {
+    std::swap(left, right);
+    comp_type_ = ComparisonKernels::Flip(comp_type_);
+  }
+  left_ = *left;
+  right_ = *right;
+  wide_ = left_.type_ == TypeId::BIGINT || (right_.is_column_ && right_.type_ == TypeId::BIGINT) ||
+          (!right_.is_column_ && (right_.constant_ < std::numeric_limits<int32_t>::min() ||
+                                  right_.constant_ > std::numeric_limits<int32_t>::max()));
+  return true;
+}
+
+template <typename T>
+uint32_t CompiledScan::SelectWithKernel(const Tuple *tuples, uint32_t count, std::vector<T> *lhs,
+                                        std::vector<T> *rhs) {
+  const uint32_t words = ComparisonKernels::BitmapWords(count);
+  bitmap_.resize(words);
+  valid_.resize(words);
+  lhs->resize(count);
+  const auto not_null = ComparisonKernels::GetKernel<T>(ComparisonType::NotEqual, true);
+
+  // A comparison with null is not true, so rows with a null operand are not selected
+  T left_null = GatherColumn(left_.type_, left_.offset_, tuples, count, lhs->data());
+  not_null(lhs->data(), &left_null, count, valid_.data());
+  if (right_.is_column_) {
+    rhs->resize(count);
+    T right_null = GatherColumn(right_.type_, right_.offset_, tuples, count, rhs->data());
+    not_null(rhs->data(), &right_null, count, bitmap_.data());
+    for (uint32_t i = 0; i < words; i++) {
+      valid_[i] &= bitmap_[i];
+    }
+    ComparisonKernels::GetKernel<T>(comp_type_, false)(lhs->data(), rhs->data(), count, bitmap_.data());
+  } else {
+    auto constant = static_cast<T>(right_.constant_);
+    ComparisonKernels::GetKernel<T>(comp_type_, true)(lhs->data(), &constant, count, bitmap_.data());
+  }
+  for (uint32_t i = 0; i < words; i++) {
+    bitmap_[i] &= valid_[i];
+  }
+  return ComparisonKernels::ToSelection(bitmap_.data(), count, selection_.data());
+}
+
+uint32_t CompiledScan::FilterTuples(const std::vector<Tuple> &tuples, TupleBatch *batch) {
+  const auto count = std::min(static_cast<uint32_t>(tuples.size()), batch->GetCapacity() - batch->GetRowCount());
+  selection_.resize(count);
+  uint32_t selected = count;
+  if (has_kernel_) {
+    selected = wide_ ? SelectWithKernel(tuples.data(), count, &wide_lhs_, &wide_rhs_)
+                     : SelectWithKernel(tuples.data(), count, &narrow_lhs_, &narrow_rhs_);
+  } else if (predicate_ != nullptr) {
+    // A predicate that is null, e.g. comparing a null column, is not satisfied
+    selected = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      Value satisfied = predicate_->Evaluate(&tuples[i], table_schema_);
+      selection_[selected] = i;
+      selected += static_cast<uint32_t>(!satisfied.IsNull() && satisfied.GetAs<bool>());
+    }
+  } else {
+    std::iota(selection_.begin(), selection_.end(), 0);
+  }
+
+  for (uint32_t i = 0; i < selected; i++) {
+    const Tuple &tuple = tuples[selection_[i]];
+    for (const auto &column : outputs_) {
+      if (column.expr_ != nullptr) {
+        values_.push_back(column.expr_->Evaluate(&tuple, table_schema_));
+        continue;
+      }
+      const char *data = tuple.GetData() + column.offset_;
+      if (!column.inlined_) {
+        data = tuple.GetData() + *reinterpret_cast<const uint32_t *>(data);
+      }
+      values_.push_back(Value::DeserializeFrom(data, column.type_));
+    }
+    batch->AppendRow(&values_, tuple.GetRid());
+  }
+  return count;
+}
+
+}  // namespace bustub
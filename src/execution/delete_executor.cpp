@@ -12,16 +12,48 @@
 
 #include <memory>
 
+#include "common/exception.h"
 #include "execution/executors/delete_executor.h"
 
 namespace bustub {
 
 DeleteExecutor::DeleteExecutor(ExecutorContext *exec_ctx, const DeletePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->TableOid())),
+      indexes_(exec_ctx->GetCatalog()->GetTableIndexes(table_info_->name_)) {}
 
-void DeleteExecutor::Init() {}
+void DeleteExecutor::Init() { child_executor_->Init(); }
 
-bool DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
+bool DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  auto txn = exec_ctx_->GetTransaction();
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+      // The child has recorded the read of this rid, the delete is installed by TransactionManager::Commit.
+      txn->AppendOptimisticWriteRecord(
+          OptimisticWriteRecord(child_rid, WType::DELETE, Tuple{}, plan_->TableOid(), exec_ctx_->GetCatalog()));
+      continue;
+    }
+
+    // The child may project away key columns, so the index keys are built from the stored tuple.
+    Tuple old_tuple;
+    if (!table_info_->table_->GetTuple(child_rid, &old_tuple, txn) ||
+        !table_info_->table_->MarkDelete(child_rid, txn)) {
+      throw Exception("DeleteExecutor: failed to delete the tuple");
+    }
+    for (auto index_info : indexes_) {
+      auto index = index_info->index_.get();
+      index->DeleteEntry(old_tuple.KeyFromTuple(table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()),
+                         child_rid, txn);
+      txn->GetIndexWriteSet()->emplace_back(child_rid, plan_->TableOid(), WType::DELETE, old_tuple,
+                                            index_info->index_oid_, exec_ctx_->GetCatalog());
+    }
+  }
+  return false;
+}
 
 }  // namespace bustub
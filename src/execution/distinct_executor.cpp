@@ -12,14 +12,54 @@
 
 #include "execution/executors/distinct_executor.h"
 
+#include <vector>
+
 namespace bustub {
 
 DistinctExecutor::DistinctExecutor(ExecutorContext *exec_ctx, const DistinctPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void DistinctExecutor::Init() {
+  child_executor_->Init();
+  seen_.clear();
+}
 
-void DistinctExecutor::Init() {}
+bool DistinctExecutor::Next(Tuple *tuple, RID *rid) {
+  const auto schema = child_executor_->GetOutputSchema();
+  while (child_executor_->Next(tuple, rid)) {
+    DistinctKey key;
+    key.values_.reserve(schema->GetColumnCount());
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      key.values_.emplace_back(tuple->GetValue(schema, i));
+    }
+    if (seen_.insert(std::move(key)).second) {
+      return true;
+    }
+  }
+  return false;
+}
 
-bool DistinctExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool DistinctExecutor::NextBatch(TupleBatch *batch) {
+  while (child_executor_->NextBatch(batch)) {
+    std::vector<uint32_t> selection;
+    for (auto row : batch->GetSelection()) {
+      DistinctKey key;
+      key.values_.reserve(batch->GetSchema()->GetColumnCount());
+      for (uint32_t i = 0; i < batch->GetSchema()->GetColumnCount(); i++) {
+        key.values_.emplace_back(batch->GetValue(row, i));
+      }
+      if (seen_.insert(std::move(key)).second) {
+        selection.push_back(row);
+      }
+    }
+    // The rows stay where they are, only the duplicates are dropped from the selection
+    if (!selection.empty()) {
+      batch->SetSelection(std::move(selection));
+      return true;
+    }
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -9,18 +9,465 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
-
 #include "execution/executors/hash_join_executor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <numeric>
+
+#include "common/exception.h"
+#include "execution/morsel_scheduler.h"
+
 namespace bustub {
 
+namespace {
+
+/** @return the tag a slot stores for a hash, never 0 */
+uint32_t Tag(hash_t hash) { return static_cast<uint32_t>(hash >> 32) | 1; }
+
+/** Calls f on every tuple of a temporary page, then deletes the page. */
+template <typename F>
+void ConsumeTmpTuplePage(BufferPoolManager *bpm, page_id_t page_id, F &&f) {
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a temporary page of the hash join");
+  }
+  Tuple tuple;
+  for (size_t offset = page->GetFreeSpacePointer(); offset < PAGE_SIZE;) {
+    offset = page->Get(offset, &tuple);
+    f(tuple);
+  }
+  bpm->UnpinPage(page_id, false);
+  bpm->DeletePage(page_id);
+}
+
+}  // namespace
+
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_child_(std::move(left_child)),
+      right_child_(std::move(right_child)) {}
+
+HashJoinExecutor::~HashJoinExecutor() { DropSpillPages(); }
+
+hash_t HashJoinExecutor::HashKey(const Value &key) {
+  // HashValue leaves the high bits of small integers unused
+  return HashUtil::MixHash(HashUtil::HashValue(&key));
+}
+
+void HashJoinExecutor::Init() {
+  right_child_->Init();
+  DropSpillPages();
+  build_rows_.clear();
+  build_bytes_ = 0;
+  tables_.clear();
+  slots_.clear();
+  spilled_ = false;
+  spilled_build_.clear();
+  spilled_probe_.clear();
+  spill_levels_.clear();
+  spill_pages_.clear();
+  spill_idx_ = 0;
+  probe_rows_.clear();
+  probe_keys_.clear();
+  probe_hashes_.clear();
+  probe_idx_ = 0;
+  slot_pos_ = SIZE_MAX;
+  right_tuple_valid_ = false;
+  out_batch_.Reset(nullptr);
+  out_idx_ = 0;
+
+  // A parallel build that does not fit in the budget falls back to reading the build side here, spilling it
+  const auto *left_plan = plan_->GetLeftPlan();
+  if (MorselScheduler::CanRunParallel(exec_ctx_) && MorselScheduler::GetPipelineSource(left_plan) != nullptr &&
+      BuildInParallel()) {
+    BuildTables();
+    return;
+  }
+
+  left_child_->Init();
+  const size_t memory_budget = exec_ctx_->GetMemoryBudget();
+  TupleBatch batch;
+  std::vector<Value> keys;
+  while (left_child_->NextBatch(&batch)) {
+    plan_->LeftJoinKeyExpression()->EvaluateBatch(batch, &keys);
+    for (uint32_t i = 0; i < batch.GetSize(); i++) {
+      // A null key never equals anything
+      if (keys[i].IsNull()) {
+        continue;
+      }
+      Tuple tuple = batch.GetTuple(batch.GetSelection()[i]);
+      hash_t hash = HashKey(keys[i]);
+      if (spilled_) {
+        SpillTuple(&spilled_build_, hash, tuple);
+        continue;
+      }
+      build_bytes_ += sizeof(BuildRow) + 2 * sizeof(Slot) + tuple.GetLength();
+      build_rows_.push_back(BuildRow{hash, keys[i], std::move(tuple)});
+      if (build_bytes_ > memory_budget) {
+        StartSpilling();
+      }
+    }
+  }
+  if (!spilled_) {
+    BuildTables();
+    return;
+  }
+
+  // The probe side is partitioned the same way, then the partitions are joined one by one
+  FinishSpilling();
+  while (right_child_->NextBatch(&batch)) {
+    plan_->RightJoinKeyExpression()->EvaluateBatch(batch, &keys);
+    for (uint32_t i = 0; i < batch.GetSize(); i++) {
+      if (!keys[i].IsNull()) {
+        SpillTuple(&spilled_probe_, HashKey(keys[i]), batch.GetTuple(batch.GetSelection()[i]));
+      }
+    }
+  }
+  FinishSpilling();
+  LoadSpillPartition();
+}
+
+bool HashJoinExecutor::BuildInParallel() {
+  const size_t memory_budget = exec_ctx_->GetMemoryBudget();
+  std::vector<std::vector<BuildRow>> worker_rows(exec_ctx_->GetNumThreads());
+  std::atomic<size_t> bytes{0};
+  std::atomic<bool> too_big{false};
+  auto sink = [&](size_t worker, size_t /*morsel*/, const TupleBatch &batch) {
+    std::vector<Value> keys;
+    plan_->LeftJoinKeyExpression()->EvaluateBatch(batch, &keys);
+    size_t batch_bytes = 0;
+    for (uint32_t i = 0; i < batch.GetSize(); i++) {
+      if (!keys[i].IsNull()) {
+        Tuple tuple = batch.GetTuple(batch.GetSelection()[i]);
+        batch_bytes += sizeof(BuildRow) + 2 * sizeof(Slot) + tuple.GetLength();
+        worker_rows[worker].push_back(BuildRow{HashKey(keys[i]), keys[i], std::move(tuple)});
+      }
+    }
+    if (bytes.fetch_add(batch_bytes) + batch_bytes > memory_budget) {
+      too_big = true;
+    }
+    return !too_big;
+  };
+  MorselScheduler::RunPipeline(exec_ctx_, plan_->GetLeftPlan(), sink);
+  if (too_big) {
+    return false;
+  }
+
+  build_bytes_ = bytes;
+  build_rows_.reserve(std::accumulate(worker_rows.begin(), worker_rows.end(), size_t{0},
+                                      [](size_t count, const auto &rows) { return count + rows.size(); }));
+  for (auto &rows : worker_rows) {
+    std::move(rows.begin(), rows.end(), std::back_inserter(build_rows_));
+  }
+  return true;
+}
+
+void HashJoinExecutor::BuildTables() {
+  // Enough partitions for the rows of each to fit in PARTITION_SIZE
+  size_t num_partitions = 1;
+  partition_bits_ = 0;
+  while (num_partitions * PARTITION_SIZE < build_bytes_ && partition_bits_ < 16) {
+    num_partitions <<= 1;
+    partition_bits_++;
+  }
+  const size_t partition_mask = num_partitions - 1;
+
+  // Radix partition the rows with a counting sort on the low bits of their hash
+  std::vector<size_t> starts(num_partitions + 1, 0);
+  for (const auto &row : build_rows_) {
+    starts[(row.hash_ & partition_mask) + 1]++;
+  }
+  for (size_t p = 0; p < num_partitions; p++) {
+    starts[p + 1] += starts[p];
+  }
+  if (num_partitions > 1) {
+    std::vector<size_t> next(starts.begin(), starts.end() - 1);
+    std::vector<BuildRow> partitioned(build_rows_.size());
+    for (auto &row : build_rows_) {
+      partitioned[next[row.hash_ & partition_mask]++] = std::move(row);
+    }
+    build_rows_ = std::move(partitioned);
+  }
+
+  // A table per partition with at least twice as many slots as rows, built while the partition is in cache
+  tables_.resize(num_partitions);
+  size_t num_slots = 0;
+  for (size_t p = 0; p < num_partitions; p++) {
+    size_t capacity = 2;
+    while (capacity < 2 * (starts[p + 1] - starts[p])) {
+      capacity <<= 1;
+    }
+    tables_[p] = PartitionTable{num_slots, capacity - 1};
+    num_slots += capacity;
+  }
+  slots_.assign(num_slots, Slot{0, 0});
+  for (size_t p = 0; p < num_partitions; p++) {
+    const auto &table = tables_[p];
+    for (size_t row = starts[p]; row < starts[p + 1]; row++) {
+      hash_t hash = build_rows_[row].hash_;
+      size_t pos = (hash >> partition_bits_) & table.mask_;
+      while (slots_[table.offset_ + pos].tag_ != 0) {
+        pos = (pos + 1) & table.mask_;
+      }
+      slots_[table.offset_ + pos] = Slot{Tag(hash), static_cast<uint32_t>(row)};
+    }
+  }
+}
+
+void HashJoinExecutor::StartSpilling() {
+  // Every spill partition keeps the page it writes to pinned, leave most of the buffer pool to the children.
+  // The fanout is a power of two, so that a partition takes whole bits of the hash
+  const size_t max_fanout =
+      std::clamp<size_t>(exec_ctx_->GetBufferPoolManager()->GetPoolSize() / 4, 1, SPILL_PARTITIONS);
+  size_t fanout = 1;
+  while (fanout * 2 <= max_fanout) {
+    fanout *= 2;
+  }
+  spilled_ = true;
+  spilled_build_.assign(fanout, {});
+  spilled_probe_.assign(fanout, {});
+  spill_levels_.assign(fanout, 0);
+  spill_pages_.assign(fanout, nullptr);
+  for (const auto &row : build_rows_) {
+    SpillTuple(&spilled_build_, row.hash_, row.tuple_);
+  }
+  build_rows_.clear();
+  build_rows_.shrink_to_fit();
+  build_bytes_ = 0;
+}
+
+void HashJoinExecutor::SpillTuple(std::vector<std::vector<page_id_t>> *partitions, hash_t hash, const Tuple &tuple) {
+  // Level l takes the 4 bits of the hash below the 4 * l highest ones, the in-memory partitions and slots of a spill
+  // partition use the low bits
+  const size_t fanout = spill_pages_.size();
+  const size_t partition = (hash >> (60 - 4 * spill_levels_.back())) & (fanout - 1);
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  auto &page = spill_pages_[partition];
+  if (page != nullptr && page->Insert(tuple, &tmp_tuple)) {
+    return;
+  }
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  if (page != nullptr) {
+    bpm->UnpinPage(page->GetPageId(), true);
+  }
+  page_id_t page_id;
+  page = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill the hash join to");
+  }
+  page->Init(page_id, PAGE_SIZE);
+  (*partitions)[partitions->size() - fanout + partition].push_back(page_id);
+  if (!page->Insert(tuple, &tmp_tuple)) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "a tuple of the hash join does not fit in a temporary page");
+  }
+}
+
+void HashJoinExecutor::RepartitionSpill() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  const size_t fanout = spill_pages_.size();
+  const size_t first = spilled_build_.size();
+  const size_t level = spill_levels_[spill_idx_] + 1;
+  spilled_build_.resize(first + fanout);
+  spilled_probe_.resize(first + fanout);
+  spill_levels_.resize(first + fanout, level);
+
+  // The pages of the partition are deleted as they are read, so the others can reuse their frames
+  const auto left_schema = left_child_->GetOutputSchema();
+  const auto right_schema = right_child_->GetOutputSchema();
+  while (!spilled_build_[spill_idx_].empty()) {
+    page_id_t page_id = spilled_build_[spill_idx_].back();
+    spilled_build_[spill_idx_].pop_back();
+    ConsumeTmpTuplePage(bpm, page_id, [&](const Tuple &tuple) {
+      SpillTuple(&spilled_build_, HashKey(plan_->LeftJoinKeyExpression()->Evaluate(&tuple, left_schema)), tuple);
+    });
+  }
+  FinishSpilling();
+  while (!spilled_probe_[spill_idx_].empty()) {
+    page_id_t page_id = spilled_probe_[spill_idx_].back();
+    spilled_probe_[spill_idx_].pop_back();
+    ConsumeTmpTuplePage(bpm, page_id, [&](const Tuple &tuple) {
+      SpillTuple(&spilled_probe_, HashKey(plan_->RightJoinKeyExpression()->Evaluate(&tuple, right_schema)), tuple);
+    });
+  }
+  FinishSpilling();
+
+  // Rows that all went to one partition share their hash bits, mostly their keys, and would not spread out again
+  size_t non_empty = std::count_if(spilled_build_.begin() + first, spilled_build_.end(),
+                                   [](const std::vector<page_id_t> &pages) { return !pages.empty(); });
+  if (non_empty == 1) {
+    std::fill(spill_levels_.begin() + first, spill_levels_.end(), MAX_SPILL_LEVELS);
+  }
+}
+
+void HashJoinExecutor::FinishSpilling() {
+  for (auto &page : spill_pages_) {
+    if (page != nullptr) {
+      exec_ctx_->GetBufferPoolManager()->UnpinPage(page->GetPageId(), true);
+      page = nullptr;
+    }
+  }
+}
+
+void HashJoinExecutor::LoadSpillPartition() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  const size_t memory_budget = exec_ctx_->GetMemoryBudget();
+  const auto left_schema = left_child_->GetOutputSchema();
+  build_rows_.clear();
+  for (; spill_idx_ < spilled_build_.size(); spill_idx_++) {
+    auto &build_pages = spilled_build_[spill_idx_];
+    auto &probe_pages = spilled_probe_[spill_idx_];
+    if (build_pages.empty() || probe_pages.empty()) {
+      // Nothing to join in this partition
+      for (page_id_t page_id : build_pages) {
+        bpm->DeletePage(page_id);
+      }
+      for (page_id_t page_id : probe_pages) {
+        bpm->DeletePage(page_id);
+      }
+      build_pages.clear();
+      probe_pages.clear();
+      continue;
+    }
+    // The rows take more memory than their pages, so a partition whose pages exceed the budget does not fit
+    if (build_pages.size() * PAGE_SIZE > memory_budget && spill_levels_[spill_idx_] + 1 < MAX_SPILL_LEVELS) {
+      RepartitionSpill();
+      continue;
+    }
+    build_bytes_ = 0;
+    for (page_id_t page_id : build_pages) {
+      ConsumeTmpTuplePage(bpm, page_id, [&](const Tuple &tuple) {
+        Value key = plan_->LeftJoinKeyExpression()->Evaluate(&tuple, left_schema);
+        build_bytes_ += sizeof(BuildRow) + 2 * sizeof(Slot) + tuple.GetLength();
+        build_rows_.push_back(BuildRow{HashKey(key), key, tuple});
+      });
+    }
+    build_pages.clear();
+    BuildTables();
+    return;
+  }
+}
+
+bool HashJoinExecutor::ReadProbeBatch() {
+  probe_rows_.clear();
+  probe_keys_.clear();
+  probe_hashes_.clear();
+  probe_idx_ = 0;
+  if (!spilled_) {
+    if (build_rows_.empty() || !right_child_->NextBatch(&probe_batch_)) {
+      return false;
+    }
+  } else {
+    while (spill_idx_ < spilled_probe_.size() && spilled_probe_[spill_idx_].empty()) {
+      spill_idx_++;
+      LoadSpillPartition();
+    }
+    if (spill_idx_ == spilled_probe_.size()) {
+      return false;
+    }
+    // A page holds fewer tuples than a batch
+    auto &probe_pages = spilled_probe_[spill_idx_];
+    page_id_t page_id = probe_pages.back();
+    probe_pages.pop_back();
+    probe_batch_.Reset(right_child_->GetOutputSchema());
+    ConsumeTmpTuplePage(exec_ctx_->GetBufferPoolManager(), page_id,
+                        [&](const Tuple &tuple) { probe_batch_.AppendTuple(tuple, RID{}); });
+  }
+
+  std::vector<Value> keys;
+  plan_->RightJoinKeyExpression()->EvaluateBatch(probe_batch_, &keys);
+  for (uint32_t i = 0; i < probe_batch_.GetSize(); i++) {
+    if (!keys[i].IsNull()) {
+      probe_rows_.push_back(probe_batch_.GetSelection()[i]);
+      probe_hashes_.push_back(HashKey(keys[i]));
+      probe_keys_.emplace_back(std::move(keys[i]));
+    }
+  }
+  // Start loading the first slot of every row before probing any of them
+  for (hash_t hash : probe_hashes_) {
+    const auto &table = tables_[hash & (tables_.size() - 1)];
+    __builtin_prefetch(&slots_[table.offset_ + ((hash >> partition_bits_) & table.mask_)]);
+  }
+  return true;
+}
+
+void HashJoinExecutor::ProbeRow(TupleBatch *batch) {
+  const hash_t hash = probe_hashes_[probe_idx_];
+  const uint32_t tag = Tag(hash);
+  const auto &table = tables_[hash & (tables_.size() - 1)];
+  size_t pos = slot_pos_ == SIZE_MAX ? (hash >> partition_bits_) & table.mask_ : slot_pos_;
+  std::vector<Value> values;
+  while (slots_[table.offset_ + pos].tag_ != 0) {
+    const Slot &slot = slots_[table.offset_ + pos];
+    pos = (pos + 1) & table.mask_;
+    const auto &build_row = build_rows_[slot.row_];
+    if (slot.tag_ != tag || build_row.key_.CompareEquals(probe_keys_[probe_idx_]) != CmpBool::CmpTrue) {
+      continue;
+    }
+    // Only the right rows that have matches are turned into tuples
+    if (!right_tuple_valid_) {
+      right_tuple_ = probe_batch_.GetTuple(probe_rows_[probe_idx_]);
+      right_tuple_valid_ = true;
+    }
+    JoinValues(build_row.tuple_, &values);
+    batch->AppendRow(&values, RID{});
+    if (batch->IsFull()) {
+      slot_pos_ = pos;
+      return;
+    }
+  }
+  probe_idx_++;
+  slot_pos_ = SIZE_MAX;
+  right_tuple_valid_ = false;
+}
+
+void HashJoinExecutor::JoinValues(const Tuple &left_tuple, std::vector<Value> *values) {
+  const auto left_schema = left_child_->GetOutputSchema();
+  const auto right_schema = right_child_->GetOutputSchema();
+  for (const auto &column : GetOutputSchema()->GetColumns()) {
+    values->emplace_back(column.GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple_, right_schema));
+  }
+}
+
+void HashJoinExecutor::DropSpillPages() {
+  FinishSpilling();
+  for (auto *partitions : {&spilled_build_, &spilled_probe_}) {
+    for (auto &pages : *partitions) {
+      for (page_id_t page_id : pages) {
+        exec_ctx_->GetBufferPoolManager()->DeletePage(page_id);
+      }
+      pages.clear();
+    }
+  }
+}
 
-void HashJoinExecutor::Init() {}
+bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (out_idx_ == out_batch_.GetSize()) {
+    if (!NextBatch(&out_batch_)) {
+      return false;
+    }
+    out_idx_ = 0;
+  }
+  *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_idx_++]);
+  return true;
+}
 
-bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool HashJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (probe_idx_ < probe_rows_.size()) {
+      ProbeRow(batch);
+      continue;
+    }
+    if (!ReadProbeBatch()) {
+      break;
+    }
+  }
+  return batch->GetSize() > 0;
+}
 
 }  // namespace bustub
@@ -11,12 +11,89 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/expressions/column_value_expression.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      index_info_(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexOid())),
+      table_info_(exec_ctx->GetCatalog()->GetTable(index_info_->table_name_)) {}
+
+void IndexScanExecutor::Init() {
+  auto txn = exec_ctx_->GetTransaction();
+  auto index = index_info_->index_.get();
+  cursor_ = index->Scan(txn);
+  if (cursor_ == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "IndexScanExecutor: the index does not support ordered scans");
+  }
+
+  // Optimistic transactions have to record the version of every tuple before reading it, so they read the heap.
+  index_only_ = index->CanReturnEntries() && txn->GetIsolationLevel() != IsolationLevel::OPTIMISTIC &&
+                (plan_->GetPredicate() == nullptr || IsCovered(plan_->GetPredicate()));
+  for (const auto &column : GetOutputSchema()->GetColumns()) {
+    index_only_ = index_only_ && IsCovered(column.GetExpr());
+  }
+  if (index_only_) {
+    row_.clear();
+    for (const auto &column : table_info_->schema_.GetColumns()) {
+      row_.emplace_back(ValueFactory::GetNullValueByType(column.GetType()));
+    }
+  }
+}
+
+bool IndexScanExecutor::IsCovered(const AbstractExpression *expr) const {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    const auto &entry_attrs = index_info_->index_->GetEntryAttrs();
+    return std::find(entry_attrs.begin(), entry_attrs.end(), column->GetColIdx()) != entry_attrs.end();
+  }
+  return std::all_of(expr->GetChildren().begin(), expr->GetChildren().end(),
+                     [this](const AbstractExpression *child) { return IsCovered(child); });
+}
 
-void IndexScanExecutor::Init() {}
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  auto txn = exec_ctx_->GetTransaction();
+  const auto &schema = table_info_->schema_;
+  const auto &entry_attrs = index_info_->index_->GetEntryAttrs();
+  Tuple entry;
+  RID raw_rid;
+  while (cursor_->Next(&raw_rid, index_only_ ? &entry : nullptr)) {
+    Tuple raw_tuple;
+    if (index_only_) {
+      // The entry columns are put back at their table positions, so the plan's expressions apply unchanged.
+      for (uint32_t i = 0; i < entry_attrs.size(); i++) {
+        row_[entry_attrs[i]] = entry.GetValue(index_info_->index_->GetEntrySchema(), i);
+      }
+      raw_tuple = Tuple(row_, &schema);
+    } else {
+      if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+        exec_ctx_->GetTransactionManager()->RecordRead(txn, raw_rid);
+      }
+      if (!table_info_->table_->GetTuple(raw_rid, &raw_tuple, txn)) {
+        continue;
+      }
+    }
+    const auto predicate = plan_->GetPredicate();
+    if (predicate != nullptr && !predicate->Evaluate(&raw_tuple, &schema).GetAs<bool>()) {
+      continue;
+    }
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+    const auto output_schema = GetOutputSchema();
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values.emplace_back(column.GetExpr()->Evaluate(&raw_tuple, &schema));
+    }
+    *tuple = Tuple(values, output_schema);
+    *rid = raw_rid;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -12,16 +12,62 @@
 
 #include <memory>
 
+#include "common/exception.h"
 #include "execution/executors/insert_executor.h"
 
 namespace bustub {
 
 InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->TableOid())),
+      indexes_(exec_ctx->GetCatalog()->GetTableIndexes(table_info_->name_)),
+      child_executor_(std::move(child_executor)) {}
 
-void InsertExecutor::Init() {}
+void InsertExecutor::Init() {
+  if (child_executor_ != nullptr) {
+    child_executor_->Init();
+  }
+}
 
-bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
+bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  if (plan_->IsRawInsert()) {
+    for (const auto &values : plan_->RawValues()) {
+      Tuple raw_tuple(values, &table_info_->schema_);
+      InsertTuple(&raw_tuple);
+    }
+    return false;
+  }
+
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    InsertTuple(&child_tuple);
+  }
+  return false;
+}
+
+void InsertExecutor::InsertTuple(Tuple *tuple) {
+  auto txn = exec_ctx_->GetTransaction();
+  if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+    // Installed, together with the index entries, by TransactionManager::Commit.
+    txn->AppendOptimisticWriteRecord(
+        OptimisticWriteRecord(RID{}, WType::INSERT, *tuple, plan_->TableOid(), exec_ctx_->GetCatalog()));
+    return;
+  }
+
+  RID rid;
+  if (!table_info_->table_->InsertTuple(*tuple, &rid, txn)) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "InsertExecutor: failed to insert the tuple");
+  }
+  for (auto index_info : indexes_) {
+    auto index = index_info->index_.get();
+    index->InsertEntry(tuple->KeyFromTuple(table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()), rid,
+                       txn);
+    txn->GetIndexWriteSet()->emplace_back(rid, plan_->TableOid(), WType::INSERT, *tuple, index_info->index_oid_,
+                                          exec_ctx_->GetCatalog());
+  }
+}
 
 }  // namespace bustub
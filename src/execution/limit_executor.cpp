@@ -12,14 +12,39 @@
 
 #include "execution/executors/limit_executor.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace bustub {
 
 LimitExecutor::LimitExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *plan,
                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void LimitExecutor::Init() {
+  child_executor_->Init();
+  count_ = 0;
+}
 
-void LimitExecutor::Init() {}
+bool LimitExecutor::Next(Tuple *tuple, RID *rid) {
+  if (count_ >= plan_->GetLimit() || !child_executor_->Next(tuple, rid)) {
+    return false;
+  }
+  count_++;
+  return true;
+}
 
-bool LimitExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool LimitExecutor::NextBatch(TupleBatch *batch) {
+  if (count_ >= plan_->GetLimit() || !child_executor_->NextBatch(batch)) {
+    return false;
+  }
+  size_t remaining = plan_->GetLimit() - count_;
+  if (batch->GetSize() > remaining) {
+    std::vector<uint32_t> selection(batch->GetSelection().begin(), batch->GetSelection().begin() + remaining);
+    batch->SetSelection(std::move(selection));
+  }
+  count_ += batch->GetSize();
+  return true;
+}
 
 }  // namespace bustub
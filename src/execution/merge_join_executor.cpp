@@ -0,0 +1,195 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/merge_join_executor.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_child,
+                                     std::unique_ptr<AbstractExecutor> &&right_child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_child_(std::move(left_child)),
+      right_child_(std::move(right_child)) {}
+
+MergeJoinExecutor::~MergeJoinExecutor() { DropGroupPages(); }
+
+void MergeJoinExecutor::Init() {
+  left_child_->Init();
+  right_child_->Init();
+  DropGroupPages();
+  group_valid_ = false;
+  group_.clear();
+  group_bytes_ = 0;
+  RewindGroup();
+  out_batch_.Reset(nullptr);
+  out_idx_ = 0;
+  AdvanceLeft();
+  AdvanceRight();
+}
+
+void MergeJoinExecutor::AdvanceLeft() {
+  RID rid;
+  while ((left_valid_ = left_child_->Next(&left_tuple_, &rid))) {
+    left_key_ = plan_->LeftJoinKeyExpression()->Evaluate(&left_tuple_, left_child_->GetOutputSchema());
+    // A null key never equals anything
+    if (!left_key_.IsNull()) {
+      return;
+    }
+  }
+}
+
+void MergeJoinExecutor::AdvanceRight() {
+  RID rid;
+  while ((right_valid_ = right_child_->Next(&right_tuple_, &rid))) {
+    right_key_ = plan_->RightJoinKeyExpression()->Evaluate(&right_tuple_, right_child_->GetOutputSchema());
+    if (!right_key_.IsNull()) {
+      return;
+    }
+  }
+}
+
+void MergeJoinExecutor::LoadGroup() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  const size_t memory_budget = exec_ctx_->GetMemoryBudget();
+  DropGroupPages();
+  group_.clear();
+  group_bytes_ = 0;
+  group_key_ = right_key_;
+  group_valid_ = true;
+  do {
+    if (group_bytes_ <= memory_budget) {
+      group_bytes_ += sizeof(Tuple) + right_tuple_.GetLength();
+      group_.push_back(std::move(right_tuple_));
+    } else {
+      TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+      if (spill_page_ == nullptr || !spill_page_->Insert(right_tuple_, &tmp_tuple)) {
+        if (spill_page_ != nullptr) {
+          bpm->UnpinPage(spill_page_->GetPageId(), true);
+          spill_page_ = nullptr;
+        }
+        page_id_t page_id;
+        spill_page_ = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+        if (spill_page_ == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill the merge join to");
+        }
+        spill_page_->Init(page_id, PAGE_SIZE);
+        group_pages_.push_back(page_id);
+        if (!spill_page_->Insert(right_tuple_, &tmp_tuple)) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "a tuple of the merge join does not fit in a temporary page");
+        }
+      }
+    }
+    AdvanceRight();
+  } while (right_valid_ && right_key_.CompareEquals(group_key_) == CmpBool::CmpTrue);
+  if (spill_page_ != nullptr) {
+    bpm->UnpinPage(spill_page_->GetPageId(), true);
+    spill_page_ = nullptr;
+  }
+  RewindGroup();
+}
+
+const Tuple *MergeJoinExecutor::NextGroupTuple() {
+  if (group_idx_ < group_.size()) {
+    return &group_[group_idx_++];
+  }
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  while (page_tuple_idx_ == page_tuples_.size()) {
+    if (group_page_idx_ == group_pages_.size()) {
+      return nullptr;
+    }
+    // The pages are kept for the next left rows of the key
+    page_id_t page_id = group_pages_[group_page_idx_++];
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a group of the merge join");
+    }
+    page_tuples_.clear();
+    Tuple tuple;
+    for (size_t offset = page->GetFreeSpacePointer(); offset < PAGE_SIZE;) {
+      offset = page->Get(offset, &tuple);
+      page_tuples_.push_back(tuple);
+    }
+    bpm->UnpinPage(page_id, false);
+    page_tuple_idx_ = 0;
+  }
+  return &page_tuples_[page_tuple_idx_++];
+}
+
+void MergeJoinExecutor::RewindGroup() {
+  group_idx_ = 0;
+  group_page_idx_ = 0;
+  page_tuples_.clear();
+  page_tuple_idx_ = 0;
+}
+
+void MergeJoinExecutor::DropGroupPages() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  if (spill_page_ != nullptr) {
+    bpm->UnpinPage(spill_page_->GetPageId(), false);
+    spill_page_ = nullptr;
+  }
+  for (auto page_id : group_pages_) {
+    bpm->DeletePage(page_id);
+  }
+  group_pages_.clear();
+}
+
+bool MergeJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (out_idx_ == out_batch_.GetSize()) {
+    if (!NextBatch(&out_batch_)) {
+      return false;
+    }
+    out_idx_ = 0;
+  }
+  *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_idx_++]);
+  return true;
+}
+
+bool MergeJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  const auto left_schema = left_child_->GetOutputSchema();
+  const auto right_schema = right_child_->GetOutputSchema();
+  std::vector<Value> values;
+  while (!batch->IsFull() && left_valid_) {
+    // The left row joins the group of its key, and the next left row may have the same key
+    if (group_valid_ && left_key_.CompareEquals(group_key_) == CmpBool::CmpTrue) {
+      const Tuple *right_tuple = NextGroupTuple();
+      if (right_tuple == nullptr) {
+        AdvanceLeft();
+        RewindGroup();
+        continue;
+      }
+      values.clear();
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateJoin(&left_tuple_, left_schema, right_tuple, right_schema));
+      }
+      batch->AppendRow(&values, RID{});
+      continue;
+    }
+    if (!right_valid_) {
+      break;
+    }
+    if (left_key_.CompareLessThan(right_key_) == CmpBool::CmpTrue) {
+      AdvanceLeft();
+    } else if (left_key_.CompareGreaterThan(right_key_) == CmpBool::CmpTrue) {
+      AdvanceRight();
+    } else {
+      LoadGroup();
+    }
+  }
+  return batch->GetSize() > 0;
+}
+
+}  // namespace bustub
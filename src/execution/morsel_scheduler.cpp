@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_scheduler.cpp
+//
+// Identification: src/execution/morsel_scheduler.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/morsel_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "concurrency/transaction.h"
+#include "execution/executor_factory.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+MorselQueue::MorselQueue(TableHeap *table, BufferPoolManager *bpm, size_t num_workers, size_t morsel_pages)
+    : morsel_pages_{morsel_pages}, queues_(num_workers) {
+  for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+    pages_.push_back(page_id);
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to split the table into morsels");
+    }
+    page->RLatch();
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  // Worker w starts with the w-th of num_workers contiguous ranges of morsels
+  const size_t num_morsels = GetNumMorsels();
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    for (size_t morsel = worker * num_morsels / num_workers; morsel < (worker + 1) * num_morsels / num_workers;
+         morsel++) {
+      queues_[worker].morsels_.push_back(morsel);
+    }
+  }
+}
+
+bool MorselQueue::Next(size_t worker, Morsel *morsel) {
+  bool found = false;
+  {
+    auto &queue = queues_[worker];
+    std::scoped_lock lock{queue.latch_};
+    if (!queue.morsels_.empty()) {
+      morsel->index_ = queue.morsels_.front();
+      queue.morsels_.pop_front();
+      found = true;
+    }
+  }
+  // Steal the last morsel of the next worker that has any
+  for (size_t i = 1; !found && i < queues_.size(); i++) {
+    auto &queue = queues_[(worker + i) % queues_.size()];
+    std::scoped_lock lock{queue.latch_};
+    if (!queue.morsels_.empty()) {
+      morsel->index_ = queue.morsels_.back();
+      queue.morsels_.pop_back();
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+  auto first = pages_.begin() + morsel->index_ * morsel_pages_;
+  morsel->pages_.assign(first, first + std::min<size_t>(morsel_pages_, pages_.end() - first));
+  return true;
+}
+
+bool MorselScheduler::CanRunParallel(ExecutorContext *exec_ctx) {
+  // Reads under optimistic concurrency control and with logging enabled write to the transaction, which is not
+  // thread-safe
+  return exec_ctx->GetNumThreads() > 1 &&
+         exec_ctx->GetTransaction()->GetIsolationLevel() != IsolationLevel::OPTIMISTIC && !enable_logging;
+}
+
+const SeqScanPlanNode *MorselScheduler::GetPipelineSource(const AbstractPlanNode *plan) {
+  if (plan->GetType() == PlanType::SeqScan) {
+    return dynamic_cast<const SeqScanPlanNode *>(plan);
+  }
+  return nullptr;
+}
+
+void MorselScheduler::RunWorkers(size_t num_workers, const std::function<void(size_t)> &task) {
+  std::mutex latch;
+  std::exception_ptr error;
+  auto run = [&](size_t worker) {
+    try {
+      task(worker);
+    } catch (...) {
+      std::scoped_lock lock{latch};
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t worker = 1; worker < num_workers; worker++) {
+    threads.emplace_back(run, worker);
+  }
+  run(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void MorselScheduler::RunPipeline(ExecutorContext *exec_ctx, const AbstractPlanNode *plan, const Sink &sink) {
+  const auto *source = GetPipelineSource(plan);
+  const size_t num_workers = exec_ctx->GetNumThreads();
+  MorselQueue morsels(exec_ctx->GetCatalog()->GetTable(source->GetTableOid())->table_.get(),
+                      exec_ctx->GetBufferPoolManager(), num_workers);
+  // Once a worker failed the others stop at their next batch
+  std::atomic<bool> failed{false};
+  RunWorkers(num_workers, [&](size_t worker) {
+    try {
+      PipelineWorker pipeline{source, &morsels, worker};
+      auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan, &pipeline);
+      executor->Init();
+      TupleBatch batch;
+      while (!failed && executor->NextBatch(&batch)) {
+        if (!sink(worker, pipeline.morsel_, batch)) {
+          break;
+        }
+      }
+    } catch (...) {
+      failed = true;
+      throw;
+    }
+  });
+}
+
+}  // namespace bustub
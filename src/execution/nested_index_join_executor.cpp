@@ -12,14 +12,148 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include <algorithm>
+#include <numeric>
+
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  auto *catalog = exec_ctx_->GetCatalog();
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  index_info_ = catalog->GetIndex(plan_->GetIndexName(), inner_table_info_->name_);
+  if (index_info_ == Catalog::NULL_INDEX_INFO || index_info_->index_->GetIndexColumnCount() != 1) {
+    throw Exception(ExceptionType::INVALID, "NestIndexJoinExecutor: the join needs an index on one inner column");
+  }
+  child_done_ = false;
+  outer_tuples_.clear();
+  outer_keys_.clear();
+  matches_.clear();
+  inner_tuples_.clear();
+  outer_idx_ = 0;
+  match_idx_ = 0;
+  out_batch_.Reset(nullptr);
+  out_idx_ = 0;
+}
+
+bool NestIndexJoinExecutor::ProbeBatch() {
+  auto *txn = exec_ctx_->GetTransaction();
+  const auto *key_expr = plan_->Predicate()->GetChildAt(0);
+  const auto *key_schema = index_info_->index_->GetKeySchema();
+  const TypeId key_type = key_schema->GetColumn(0).GetType();
+  outer_tuples_.clear();
+  inner_tuples_.clear();
+  outer_idx_ = 0;
+  match_idx_ = 0;
+
+  std::vector<Value> keys;
+  TupleBatch batch;
+  std::vector<Value> batch_keys;
+  while (!child_done_ && outer_tuples_.size() < PROBE_BATCH_SIZE) {
+    if (!child_executor_->NextBatch(&batch)) {
+      child_done_ = true;
+      break;
+    }
+    key_expr->EvaluateBatch(batch, &batch_keys);
+    for (uint32_t i = 0; i < batch.GetSize(); i++) {
+      // A null key never equals anything
+      if (batch_keys[i].IsNull()) {
+        continue;
+      }
+      outer_tuples_.push_back(batch.GetTuple(batch.GetSelection()[i]));
+      keys.push_back(batch_keys[i].GetTypeId() == key_type ? batch_keys[i] : batch_keys[i].CastAs(key_type));
+    }
+  }
+  if (outer_tuples_.empty()) {
+    return false;
+  }
+
+  // Each distinct key is looked up once, in key order
+  std::vector<uint32_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&keys](uint32_t a, uint32_t b) { return keys[a].CompareLessThan(keys[b]) == CmpBool::CmpTrue; });
+  outer_keys_.resize(keys.size());
+  std::vector<Tuple> key_tuples;
+  for (size_t i = 0; i < order.size(); i++) {
+    if (i == 0 || keys[order[i]].CompareEquals(keys[order[i - 1]]) != CmpBool::CmpTrue) {
+      key_tuples.emplace_back(std::vector<Value>{keys[order[i]]}, key_schema);
+    }
+    outer_keys_[order[i]] = static_cast<uint32_t>(key_tuples.size() - 1);
+  }
+  index_info_->index_->ScanKeys(key_tuples, &matches_, txn);
+
+  // The inner tuples are read page by page
+  std::vector<RID> rids;
+  for (const auto &match : matches_) {
+    rids.insert(rids.end(), match.begin(), match.end());
+  }
+  std::sort(rids.begin(), rids.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+  rids.erase(std::unique(rids.begin(), rids.end()), rids.end());
+  for (const auto &rid : rids) {
+    if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+      exec_ctx_->GetTransactionManager()->RecordRead(txn, rid);
+    }
+    Tuple tuple;
+    if (inner_table_info_->table_->GetTuple(rid, &tuple, txn)) {
+      inner_tuples_.emplace(rid, std::move(tuple));
+    }
+  }
+  return true;
+}
 
-void NestIndexJoinExecutor::Init() {}
+bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (out_idx_ == out_batch_.GetSize()) {
+    if (!NextBatch(&out_batch_)) {
+      return false;
+    }
+    out_idx_ = 0;
+  }
+  *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_idx_++]);
+  return true;
+}
 
-bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool NestIndexJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  const auto *outer_schema = child_executor_->GetOutputSchema();
+  const auto *inner_schema = &inner_table_info_->schema_;
+  std::vector<Value> values;
+  while (!batch->IsFull()) {
+    if (outer_idx_ == outer_tuples_.size()) {
+      if (!ProbeBatch()) {
+        break;
+      }
+      continue;
+    }
+    const auto &match = matches_[outer_keys_[outer_idx_]];
+    if (match_idx_ == match.size()) {
+      outer_idx_++;
+      match_idx_ = 0;
+      continue;
+    }
+    auto inner = inner_tuples_.find(match[match_idx_++]);
+    if (inner == inner_tuples_.end()) {
+      continue;
+    }
+    const Tuple &outer_tuple = outer_tuples_[outer_idx_];
+    Value result = plan_->Predicate()->EvaluateJoin(&outer_tuple, outer_schema, &inner->second, inner_schema);
+    if (result.IsNull() || !result.GetAs<bool>()) {
+      continue;
+    }
+    values.clear();
+    for (const auto &column : GetOutputSchema()->GetColumns()) {
+      values.emplace_back(column.GetExpr()->EvaluateJoin(&outer_tuple, outer_schema, &inner->second, inner_schema));
+    }
+    batch->AppendRow(&values, RID{});
+  }
+  return batch->GetSize() > 0;
+}
 
 }  // namespace bustub
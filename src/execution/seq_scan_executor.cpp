@@ -12,12 +12,191 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "storage/page/table_page.h"
+
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())) {}
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, PipelineWorker *pipeline)
+    : SeqScanExecutor(exec_ctx, plan) {
+  pipeline_ = pipeline;
+}
+
+void SeqScanExecutor::Init() {
+  compiled_.reset();
+  if (!enable_logging && exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::OPTIMISTIC) {
+    compiled_ = std::make_unique<CompiledScan>(plan_, &table_info_->schema_);
+  }
+  out_batch_.Reset(nullptr);
+  out_idx_ = 0;
+  if (pipeline_ != nullptr) {
+    morsel_rids_.clear();
+    rid_idx_ = 0;
+    morsel_pages_.clear();
+    page_id_ = INVALID_PAGE_ID;
+    return;
+  }
+  if (compiled_ != nullptr) {
+    page_id_ = table_info_->table_->GetFirstPageId();
+    slot_num_ = 0;
+    return;
+  }
+  table_iter_ = std::make_unique<TableIterator>(table_info_->table_->Begin(exec_ctx_->GetTransaction()));
+}
+
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  if (compiled_ != nullptr) {
+    while (out_idx_ == out_batch_.GetSize()) {
+      if (!NextBatch(&out_batch_)) {
+        return false;
+      }
+      out_idx_ = 0;
+    }
+    uint32_t row = out_batch_.GetSelection()[out_idx_++];
+    *tuple = out_batch_.GetTuple(row);
+    *rid = out_batch_.GetRid(row);
+    return true;
+  }
+
+  std::vector<Value> values;
+  while (!NextRow(&values, rid)) {
+    if (pipeline_ == nullptr || !NextMorsel()) {
+      return false;
+    }
+  }
+  *tuple = Tuple(values, GetOutputSchema());
+  return true;
+}
+
+bool SeqScanExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  if (compiled_ != nullptr) {
+    NextCompiledBatch(batch);
+    return batch->GetSize() > 0;
+  }
+  std::vector<Value> values;
+  RID rid;
+  while (!batch->IsFull()) {
+    if (NextRow(&values, &rid)) {
+      batch->AppendRow(&values, rid);
+      continue;
+    }
+    // The sink of a pipeline tells the morsels of the batches apart
+    if (pipeline_ == nullptr || batch->GetSize() > 0 || !NextMorsel()) {
+      break;
+    }
+  }
+  return batch->GetSize() > 0;
+}
+
+bool SeqScanExecutor::NextMorsel() {
+  Morsel morsel;
+  if (!pipeline_->morsels_->Next(pipeline_->worker_, &morsel)) {
+    return false;
+  }
+  pipeline_->morsel_ = morsel.index_;
+  if (compiled_ != nullptr) {
+    morsel_pages_ = std::move(morsel.pages_);
+    page_idx_ = 1;
+    page_id_ = morsel_pages_[0];
+    slot_num_ = 0;
+    return true;
+  }
+  morsel_rids_.clear();
+  rid_idx_ = 0;
+  auto bpm = exec_ctx_->GetBufferPoolManager();
+  for (page_id_t page_id : morsel.pages_) {
+    auto page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a morsel of the scan");
+    }
+    page->RLatch();
+    RID rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      morsel_rids_.push_back(rid);
+    }
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+  }
+  return true;
+}
+
+void SeqScanExecutor::NextCompiledBatch(TupleBatch *batch) {
+  auto filter = [&](const std::vector<Tuple> &tuples) { return compiled_->FilterTuples(tuples, batch); };
+  while (!batch->IsFull()) {
+    if (page_id_ == INVALID_PAGE_ID) {
+      // The sink of a pipeline tells the morsels of the batches apart
+      if (pipeline_ == nullptr || batch->GetSize() > 0 || !NextMorsel()) {
+        return;
+      }
+      continue;
+    }
+    const page_id_t next_page_id = table_info_->table_->ScanPage(page_id_, &slot_num_, filter);
+    // A morsel ends with its last page, the table with the end of the page chain
+    if (next_page_id != page_id_) {
+      if (pipeline_ == nullptr) {
+        page_id_ = next_page_id;
+      } else {
+        page_id_ = page_idx_ < morsel_pages_.size() ? morsel_pages_[page_idx_++] : INVALID_PAGE_ID;
+      }
+    }
+  }
+}
 
-void SeqScanExecutor::Init() {}
+bool SeqScanExecutor::NextRow(std::vector<Value> *values, RID *rid) {
+  auto txn = exec_ctx_->GetTransaction();
+  const auto end = table_info_->table_->End();
+  Tuple raw_tuple;
+  while (true) {
+    RID raw_rid;
+    if (pipeline_ == nullptr) {
+      if (*table_iter_ == end) {
+        return false;
+      }
+      raw_tuple = **table_iter_;
+      raw_rid = raw_tuple.GetRid();
+      ++(*table_iter_);
+    } else {
+      if (rid_idx_ == morsel_rids_.size()) {
+        return false;
+      }
+      raw_rid = morsel_rids_[rid_idx_++];
+    }
+    if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+      // The version has to be sampled before the tuple is read, so read the tuple again after recording it.
+      exec_ctx_->GetTransactionManager()->RecordRead(txn, raw_rid);
+      if (!table_info_->table_->GetTuple(raw_rid, &raw_tuple, txn)) {
+        continue;
+      }
+    } else if (pipeline_ != nullptr && !table_info_->table_->GetTuple(raw_rid, &raw_tuple, txn)) {
+      continue;
+    }
+    const auto predicate = plan_->GetPredicate();
+    if (predicate != nullptr) {
+      // A predicate that is null, e.g. comparing a null column, is not satisfied
+      Value satisfied = predicate->Evaluate(&raw_tuple, &table_info_->schema_);
+      if (satisfied.IsNull() || !satisfied.GetAs<bool>()) {
+        continue;
+      }
+    }
 
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+    const auto output_schema = GetOutputSchema();
+    values->reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values->emplace_back(column.GetExpr()->Evaluate(&raw_tuple, &table_info_->schema_));
+    }
+    *rid = raw_rid;
+    return true;
+  }
+}
 
 }  // namespace bustub
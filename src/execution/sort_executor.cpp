@@ -0,0 +1,318 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/sort_executor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "storage/index/key_normalizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return The first 8 bytes of a key, big-endian and padded with zeros */
+uint64_t KeyPrefix(const std::string &key) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    prefix = (prefix << 8) | (i < key.size() ? static_cast<uint8_t>(key[i]) : 0);
+  }
+  return prefix;
+}
+
+/** @return A negative number, zero or a positive number if key a sorts before, with or after key b */
+int CompareKeys(const std::string &a, const std::string &b) {
+  int cmp = memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+/** @return `true` if row a sorts before row b, the earlier row first if their keys are equal */
+template <typename Row>
+bool KeyOrder(const Row &a, const Row &b) {
+  int cmp = CompareKeys(a.key_, b.key_);
+  return cmp < 0 || (cmp == 0 && a.seq_ < b.seq_);
+}
+
+}  // namespace
+
+SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor, std::optional<size_t> limit)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)), limit_(limit) {}
+
+SortExecutor::~SortExecutor() { DropRuns(); }
+
+void SortExecutor::Init() {
+  child_executor_->Init();
+  DropRuns();
+  top_n_ = limit_.has_value();
+  seq_ = 0;
+  rows_.clear();
+  entries_.clear();
+  entry_idx_ = 0;
+  row_bytes_ = 0;
+
+  const auto &order_bys = plan_->GetOrderBys();
+  std::vector<std::vector<Value>> values(order_bys.size());
+  std::vector<Value> row_values(order_bys.size());
+  TupleBatch batch;
+  while (child_executor_->NextBatch(&batch)) {
+    for (size_t i = 0; i < order_bys.size(); i++) {
+      order_bys[i].second->EvaluateBatch(batch, &values[i]);
+    }
+    for (uint32_t i = 0; i < batch.GetSize(); i++) {
+      for (size_t j = 0; j < order_bys.size(); j++) {
+        row_values[j] = values[j][i];
+      }
+      uint32_t row = batch.GetSelection()[i];
+      AddRow(MakeKey(row_values), batch.GetTuple(row), batch.GetRid(row));
+    }
+  }
+  SortRows();
+  if (runs_.empty()) {
+    return;
+  }
+
+  // The rows left in memory are the last run, then the runs are merged
+  SpillRun();
+  run_valid_.resize(runs_.size());
+  for (size_t run = 0; run < runs_.size(); run++) {
+    run_valid_[run] = AdvanceRun(&runs_[run]);
+  }
+  // Every node starts with the virtual run runs_.size(), which beats all runs and is pushed out as they play
+  loser_tree_.assign(runs_.size(), runs_.size());
+  for (size_t run = runs_.size(); run-- > 0;) {
+    AdjustLoserTree(run);
+  }
+}
+
+std::string SortExecutor::MakeKey(const std::vector<Value> &values) const {
+  const auto &order_bys = plan_->GetOrderBys();
+  std::string key;
+  for (size_t i = 0; i < order_bys.size(); i++) {
+    size_t start = key.size();
+    KeyNormalizer::AppendValue(values[i], &key);
+    // Flipping the bytes of an encoding reverses its order, nulls included
+    if (order_bys[i].first == OrderByType::Descending) {
+      for (size_t j = start; j < key.size(); j++) {
+        key[j] = static_cast<char>(~key[j]);
+      }
+    }
+  }
+  return key;
+}
+
+std::string SortExecutor::TupleKey(const Tuple &tuple) const {
+  const auto &order_bys = plan_->GetOrderBys();
+  std::vector<Value> values;
+  values.reserve(order_bys.size());
+  for (const auto &order_by : order_bys) {
+    values.push_back(order_by.second->Evaluate(&tuple, child_executor_->GetOutputSchema()));
+  }
+  return MakeKey(values);
+}
+
+bool SortExecutor::RowLess(const SortEntry &a, const SortEntry &b) const {
+  if (a.prefix_ != b.prefix_) {
+    return a.prefix_ < b.prefix_;
+  }
+  return KeyOrder(rows_[a.row_], rows_[b.row_]);
+}
+
+void SortExecutor::AddRow(std::string &&key, Tuple &&tuple, RID rid) {
+  const size_t memory_budget = exec_ctx_->GetMemoryBudget();
+  SortRow row{std::move(key), std::move(tuple), rid, seq_++};
+  const size_t bytes = sizeof(SortRow) + sizeof(SortEntry) + row.key_.size() + row.tuple_.GetLength();
+  if (!top_n_) {
+    row_bytes_ += bytes;
+    rows_.push_back(std::move(row));
+    if (row_bytes_ > memory_budget) {
+      SortRows();
+      SpillRun();
+    }
+    return;
+  }
+
+  // rows_ is a heap of the first rows so far, the last of them on top
+  if (rows_.size() == *limit_) {
+    if (rows_.empty() || !KeyOrder(row, rows_.front())) {
+      return;
+    }
+    std::pop_heap(rows_.begin(), rows_.end(), KeyOrder<SortRow>);
+    row_bytes_ -= sizeof(SortRow) + sizeof(SortEntry) + rows_.back().key_.size() + rows_.back().tuple_.GetLength();
+    rows_.pop_back();
+  }
+  row_bytes_ += bytes;
+  rows_.push_back(std::move(row));
+  std::push_heap(rows_.begin(), rows_.end(), KeyOrder<SortRow>);
+  if (row_bytes_ > memory_budget) {
+    // The first rows do not fit in memory, so all the rows that can still be among them are sorted
+    top_n_ = false;
+    SortRows();
+    SpillRun();
+  }
+}
+
+void SortExecutor::SortRows() {
+  entries_.clear();
+  entries_.reserve(rows_.size());
+  for (uint32_t row = 0; row < rows_.size(); row++) {
+    entries_.push_back(SortEntry{KeyPrefix(rows_[row].key_), row});
+  }
+  std::sort(entries_.begin(), entries_.end(), [this](const SortEntry &a, const SortEntry &b) { return RowLess(a, b); });
+  entry_idx_ = 0;
+}
+
+void SortExecutor::SpillRun() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  // The run is added first so that its pages are dropped if the buffer pool runs out of frames
+  auto &run = runs_.emplace_back();
+  for (const auto &entry : entries_) {
+    const auto &row = rows_[entry.row_];
+    TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+    if (spill_page_ != nullptr && spill_page_->Insert(row.tuple_, row.rid_, &tmp_tuple)) {
+      continue;
+    }
+    if (spill_page_ != nullptr) {
+      bpm->UnpinPage(spill_page_->GetPageId(), true);
+      spill_page_ = nullptr;
+    }
+    page_id_t page_id;
+    spill_page_ = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+    if (spill_page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill the sort to");
+    }
+    spill_page_->Init(page_id, PAGE_SIZE);
+    run.pages_.push_back(page_id);
+    if (!spill_page_->Insert(row.tuple_, row.rid_, &tmp_tuple)) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "a tuple of the sort does not fit in a temporary page");
+    }
+  }
+  if (spill_page_ != nullptr) {
+    bpm->UnpinPage(spill_page_->GetPageId(), true);
+    spill_page_ = nullptr;
+  }
+  rows_.clear();
+  entries_.clear();
+  row_bytes_ = 0;
+}
+
+bool SortExecutor::AdvanceRun(Run *run) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  run->tuple_idx_++;
+  while (run->tuple_idx_ >= run->tuples_.size()) {
+    if (run->page_idx_ == run->pages_.size()) {
+      return false;
+    }
+    page_id_t page_id = run->pages_[run->page_idx_++];
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a run of the sort");
+    }
+    run->tuples_.clear();
+    run->rids_.clear();
+    Tuple tuple;
+    RID rid;
+    for (size_t offset = page->GetFreeSpacePointer(); offset < PAGE_SIZE;) {
+      offset = page->Get(offset, &tuple, &rid);
+      run->tuples_.push_back(tuple);
+      run->rids_.push_back(rid);
+    }
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    // A page is read from its last tuple to its first
+    std::reverse(run->tuples_.begin(), run->tuples_.end());
+    std::reverse(run->rids_.begin(), run->rids_.end());
+    run->tuple_idx_ = 0;
+  }
+  run->key_ = TupleKey(run->tuples_[run->tuple_idx_]);
+  return true;
+}
+
+bool SortExecutor::RunBeats(size_t a, size_t b) const {
+  if (a == runs_.size() || b == runs_.size()) {
+    return a == runs_.size();
+  }
+  // An exhausted run loses every match
+  if (!run_valid_[a] || !run_valid_[b]) {
+    return run_valid_[a];
+  }
+  // Runs hold consecutive rows of the child, so the earlier run wins a tie
+  int cmp = CompareKeys(runs_[a].key_, runs_[b].key_);
+  return cmp < 0 || (cmp == 0 && a < b);
+}
+
+void SortExecutor::AdjustLoserTree(size_t run) {
+  size_t winner = run;
+  for (size_t node = (run + runs_.size()) / 2; node > 0; node /= 2) {
+    if (RunBeats(loser_tree_[node], winner)) {
+      std::swap(winner, loser_tree_[node]);
+    }
+  }
+  loser_tree_[0] = winner;
+}
+
+void SortExecutor::DropRuns() {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  if (spill_page_ != nullptr) {
+    bpm->UnpinPage(spill_page_->GetPageId(), false);
+    spill_page_ = nullptr;
+  }
+  for (const auto &run : runs_) {
+    for (size_t i = run.page_idx_; i < run.pages_.size(); i++) {
+      bpm->DeletePage(run.pages_[i]);
+    }
+  }
+  runs_.clear();
+  run_valid_.clear();
+  loser_tree_.clear();
+}
+
+bool SortExecutor::NextRow(Tuple *tuple, RID *rid) {
+  if (runs_.empty()) {
+    if (entry_idx_ == entries_.size()) {
+      return false;
+    }
+    const auto &row = rows_[entries_[entry_idx_++].row_];
+    *tuple = row.tuple_;
+    *rid = row.rid_;
+    return true;
+  }
+
+  size_t winner = loser_tree_[0];
+  if (!run_valid_[winner]) {
+    return false;
+  }
+  Run &run = runs_[winner];
+  *tuple = run.tuples_[run.tuple_idx_];
+  *rid = run.rids_[run.tuple_idx_];
+  run_valid_[winner] = AdvanceRun(&run);
+  AdjustLoserTree(winner);
+  return true;
+}
+
+bool SortExecutor::Next(Tuple *tuple, RID *rid) { return NextRow(tuple, rid); }
+
+bool SortExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  Tuple tuple;
+  RID rid;
+  while (!batch->IsFull() && NextRow(&tuple, &rid)) {
+    batch->AppendTuple(tuple, rid);
+  }
+  return batch->GetSize() > 0;
+}
+
+}  // namespace bustub
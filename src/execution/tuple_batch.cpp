@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  // Clearing keeps the capacity of the vectors, so a batch that is reused does not allocate again.
+  // Executors that produce no tuples, such as inserts, have no output schema
+  columns_.resize(schema == nullptr ? 0 : schema->GetColumnCount());
+  for (auto &column : columns_) {
+    column.clear();
+    column.reserve(capacity_);
+  }
+  rids_.clear();
+  selection_.clear();
+}
+
+void TupleBatch::AppendRow(std::vector<Value> *values, RID rid) {
+  BUSTUB_ASSERT(values->size() == columns_.size(), "the row does not match the schema of the batch");
+  selection_.push_back(GetRowCount());
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].emplace_back((*values)[i]);
+  }
+  rids_.push_back(rid);
+  values->clear();
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, RID rid) {
+  selection_.push_back(GetRowCount());
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].emplace_back(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+}
+
+Tuple TupleBatch::GetTuple(uint32_t row) const {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  return Tuple(values, schema_);
+}
+
+}  // namespace bustub
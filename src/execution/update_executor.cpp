@@ -11,17 +11,56 @@
 //===----------------------------------------------------------------------===//
 #include <memory>
 
+#include "common/exception.h"
 #include "execution/executors/update_executor.h"
 
 namespace bustub {
 
 UpdateExecutor::UpdateExecutor(ExecutorContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->TableOid())),
+      child_executor_(std::move(child_executor)),
+      indexes_(exec_ctx->GetCatalog()->GetTableIndexes(table_info_->name_)) {}
 
-void UpdateExecutor::Init() {}
+void UpdateExecutor::Init() { child_executor_->Init(); }
 
-bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
+bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  auto txn = exec_ctx_->GetTransaction();
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    // The child may project away columns, so the update is computed from the stored tuple.
+    Tuple old_tuple;
+    if (!table_info_->table_->GetTuple(child_rid, &old_tuple, txn)) {
+      throw Exception("UpdateExecutor: failed to read the tuple");
+    }
+    Tuple new_tuple = GenerateUpdatedTuple(old_tuple);
+
+    if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+      // The child has recorded the read of this rid, the update is installed by TransactionManager::Commit.
+      txn->AppendOptimisticWriteRecord(
+          OptimisticWriteRecord(child_rid, WType::UPDATE, new_tuple, plan_->TableOid(), exec_ctx_->GetCatalog()));
+      continue;
+    }
+
+    if (!table_info_->table_->UpdateTuple(new_tuple, child_rid, txn)) {
+      throw Exception("UpdateExecutor: failed to update the tuple");
+    }
+    for (auto index_info : indexes_) {
+      auto index = index_info->index_.get();
+      index->DeleteEntry(old_tuple.KeyFromTuple(table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()),
+                         child_rid, txn);
+      index->InsertEntry(new_tuple.KeyFromTuple(table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()),
+                         child_rid, txn);
+      txn->GetIndexWriteSet()->emplace_back(child_rid, plan_->TableOid(), WType::UPDATE, new_tuple,
+                                            index_info->index_oid_, exec_ctx_->GetCatalog());
+      txn->GetIndexWriteSet()->back().old_tuple_ = old_tuple;
+    }
+  }
+  return false;
+}
 
 Tuple UpdateExecutor::GenerateUpdatedTuple(const Tuple &src_tuple) {
   const auto &update_attrs = plan_->GetUpdateAttr();
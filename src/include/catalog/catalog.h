@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -20,9 +21,13 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/art_index.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/varlen_b_plus_tree_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -34,6 +39,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The data structures an index can be built on. */
+enum class IndexType { HASH_TABLE, ART, B_PLUS_TREE, VARLEN_B_PLUS_TREE };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -186,12 +194,19 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The data structure of the index; ART and variable-length B+ tree indexes ignore the key type
+   * and hash function
+   * @param include_attrs Table columns stored in the index entries next to the key, so that scans reading only
+   * key and included columns need not read the table; only B+ tree indexes support them, they must be inlined and
+   * keysize must cover them
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         std::size_t keysize, HashFunction<KeyType> hash_function) {
+                         std::size_t keysize, HashFunction<KeyType> hash_function,
+                         IndexType index_type = IndexType::HASH_TABLE,
+                         const std::vector<uint32_t> &include_attrs = {}) {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -207,22 +222,59 @@ class Catalog {
       return NULL_INDEX_INFO;
     }
 
+    // Hash tables, ART and the variable-length B+ tree hash or encode the whole entry, so they cannot carry extra
+    // columns
+    if (!include_attrs.empty() && index_type != IndexType::B_PLUS_TREE) {
+      return NULL_INDEX_INFO;
+    }
+
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, include_attrs);
+
+    // The entries are copied into the keys as raw tuples, so they must be inlined and fit into keysize
+    if (!include_attrs.empty()) {
+      for (auto attr : include_attrs) {
+        if (!schema.GetColumn(attr).IsInlined()) {
+          throw Exception(ExceptionType::INVALID, "INCLUDE columns must be inlined");
+        }
+      }
+      if (meta->GetEntrySchema()->GetLength() > keysize) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "the index key size cannot hold the key and INCLUDE columns");
+      }
+    }
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::ART) {
+      index = std::make_unique<ArtIndex>(std::move(meta));
+    } else if (index_type == IndexType::B_PLUS_TREE) {
+      index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    } else if (index_type == IndexType::VARLEN_B_PLUS_TREE) {
+      index = std::make_unique<VarlenBPlusTreeIndex>(std::move(meta), bpm_);
+    } else {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                            hash_function);
+    }
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, loading them in batches of index_build_batch_size_ entries so
+    // that only one batch is held in memory. A B+ tree writes the batches out as sorted runs and bulk loads them as
+    // one sorted stream when the load is finished. In-memory indexes such as ART are not persisted, this is also how
+    // they are rebuilt
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
+    std::vector<std::pair<Tuple, RID>> entries;
     for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      entries.emplace_back(tuple->KeyFromTuple(schema, *index->GetEntrySchema(), index->GetEntryAttrs()),
+                           tuple->GetRid());
+      if (entries.size() == index_build_batch_size_) {
+        index->BulkInsertEntries(entries, txn);
+        entries.clear();
+      }
+    }
+    if (!entries.empty()) {
+      index->BulkInsertEntries(entries, txn);
     }
+    index->FinishBulkInsert(txn);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -322,6 +374,12 @@ class Catalog {
     return indexes;
   }
 
+  /** @return The number of entries loaded into a new index at once */
+  size_t GetIndexBuildBatchSize() const { return index_build_batch_size_; }
+
+  /** Sets the number of entries loaded into a new index at once, INDEX_BUILD_BATCH_SIZE by default. */
+  void SetIndexBuildBatchSize(size_t batch_size) { index_build_batch_size_ = std::max<size_t>(batch_size, 1); }
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -352,6 +410,9 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** The number of entries loaded into a new index at once */
+  size_t index_build_batch_size_{INDEX_BUILD_BATCH_SIZE};
 };
 
 }  // namespace bustub
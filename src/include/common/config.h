@@ -35,6 +35,8 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr size_t OPERATOR_MEMORY_BUDGET = 64 << 20;                    // bytes an operator may keep in memory
+static constexpr size_t INDEX_BUILD_BATCH_SIZE = 1 << 16;                     // entries loaded into a new index at once
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -42,5 +44,6 @@ using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
+using version_t = uint64_t;    // tuple version type (optimistic concurrency control)
 
 }  // namespace bustub
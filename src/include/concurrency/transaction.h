@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
 
 #include "common/config.h"
@@ -40,13 +41,19 @@ namespace bustub {
  * GROWING  -> COMMITTED     ABORTED
  *    |_________________________^
  *
+ * OPTIMISTIC transactions never take locks and follow the Non-2PL diagram; they may still move
+ * from GROWING to ABORTED inside Commit() if validation fails.
+ *
  **/
 enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
 /**
  * Transaction isolation level.
+ *
+ * OPTIMISTIC transactions run without the LockManager: they record the version of every tuple they read, buffer
+ * their writes, and are validated (backward validation against committed writers) in TransactionManager::Commit.
  */
-enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
+enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED, OPTIMISTIC };
 
 /**
  * Type of write operation.
@@ -99,6 +106,26 @@ class IndexWriteRecord {
   Catalog *catalog_;
 };
 
+/**
+ * OptimisticWriteRecord buffers a write of an OPTIMISTIC transaction until it is installed at commit time.
+ */
+class OptimisticWriteRecord {
+ public:
+  OptimisticWriteRecord(RID rid, WType wtype, const Tuple &tuple, table_oid_t table_oid, Catalog *catalog)
+      : rid_(rid), wtype_(wtype), tuple_(tuple), table_oid_(table_oid), catalog_(catalog) {}
+
+  /** The target rid; ignored for inserts, whose rid is only known once the write is installed. */
+  RID rid_;
+  /** Write type. */
+  WType wtype_;
+  /** The new tuple image, unused for deletes. */
+  Tuple tuple_;
+  /** Table oid. */
+  table_oid_t table_oid_;
+  /** The catalog is used to locate the table heap and its indexes at install time. */
+  Catalog *catalog_;
+};
+
 /**
  * Reason to a transaction abortion
  */
@@ -107,7 +134,8 @@ enum class AbortReason {
   UNLOCK_ON_SHRINKING,
   UPGRADE_CONFLICT,
   DEADLOCK,
-  LOCKSHARED_ON_READ_UNCOMMITTED
+  LOCKSHARED_ON_READ_UNCOMMITTED,
+  VALIDATION_FAILED
 };
 
 /**
@@ -137,6 +165,8 @@ class TransactionAbortException : public std::exception {
         return "Transaction " + std::to_string(txn_id_) + " aborted on deadlock\n";
       case AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED:
         return "Transaction " + std::to_string(txn_id_) + " aborted on lockshared on READ_UNCOMMITTED\n";
+      case AbortReason::VALIDATION_FAILED:
+        return "Transaction " + std::to_string(txn_id_) + " aborted because optimistic validation failed\n";
     }
     // Todo: Should fail with unreachable.
     return "";
@@ -161,6 +191,8 @@ class Transaction {
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
     page_set_ = std::make_shared<std::deque<bustub::Page *>>();
     deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
+    read_set_ = std::make_shared<std::unordered_map<RID, version_t>>();
+    optimistic_write_set_ = std::make_shared<std::deque<OptimisticWriteRecord>>();
   }
 
   ~Transaction() = default;
@@ -222,6 +254,28 @@ class Transaction {
   /** @return the set of resources under an exclusive lock */
   inline std::shared_ptr<std::unordered_set<RID>> GetExclusiveLockSet() { return exclusive_lock_set_; }
 
+  /** @return the versions of the tuples read by this (OPTIMISTIC) transaction */
+  inline std::shared_ptr<std::unordered_map<RID, version_t>> GetReadSet() { return read_set_; }
+
+  /**
+   * Records a read for optimistic validation. Only the first version observed for a rid is kept, so a later
+   * re-read cannot hide a concurrent update.
+   * @param rid the rid that was read
+   * @param version the version of the tuple observed before reading it
+   */
+  inline void AddIntoReadSet(const RID &rid, version_t version) { read_set_->emplace(rid, version); }
+
+  /** @return the writes buffered by this (OPTIMISTIC) transaction */
+  inline std::shared_ptr<std::deque<OptimisticWriteRecord>> GetOptimisticWriteSet() { return optimistic_write_set_; }
+
+  /**
+   * Buffers a write until commit.
+   * @param write_record write record to be added
+   */
+  inline void AppendOptimisticWriteRecord(const OptimisticWriteRecord &write_record) {
+    optimistic_write_set_->push_back(write_record);
+  }
+
   /** @return true if rid is shared locked by this transaction */
   bool IsSharedLocked(const RID &rid) { return shared_lock_set_->find(rid) != shared_lock_set_->end(); }
 
@@ -272,6 +326,11 @@ class Transaction {
   std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
   /** LockManager: the set of exclusive-locked tuples held by this transaction. */
   std::shared_ptr<std::unordered_set<RID>> exclusive_lock_set_;
+
+  /** OCC: the version of every tuple read by this transaction. */
+  std::shared_ptr<std::unordered_map<RID, version_t>> read_set_;
+  /** OCC: the writes that are installed when this transaction commits. */
+  std::shared_ptr<std::deque<OptimisticWriteRecord>> optimistic_write_set_;
 };
 
 }  // namespace bustub
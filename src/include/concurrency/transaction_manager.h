@@ -13,9 +13,11 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -45,9 +47,15 @@ class TransactionManager {
 
   /**
    * Commits a transaction.
+   *
+   * An OPTIMISTIC transaction is validated first: if any tuple in its read set has been overwritten by a
+   * transaction that committed (or aborted) since it was read, the transaction is aborted instead.
+   * Otherwise its buffered writes are installed into the tables and indexes.
+   *
    * @param txn the transaction to commit
+   * @return true if the transaction committed, false if it failed validation and was aborted
    */
-  void Commit(Transaction *txn);
+  bool Commit(Transaction *txn);
 
   /**
    * Aborts a transaction
@@ -77,6 +85,22 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * Returns the current version of a tuple. The version is bumped every time a transaction that wrote the tuple
+   * finishes, so OPTIMISTIC readers must sample it *before* reading the tuple.
+   * @param rid the rid of the tuple
+   * @return the current version of the tuple
+   */
+  version_t GetTupleVersion(const RID &rid);
+
+  /**
+   * Records a read of the given tuple in the read set of an OPTIMISTIC transaction; a no-op for other isolation
+   * levels.
+   * @param txn the reading transaction
+   * @param rid the rid of the tuple about to be read
+   */
+  void RecordRead(Transaction *txn, const RID &rid);
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -101,12 +125,47 @@ class TransactionManager {
     }
   }
 
+  /**
+   * Checks that no tuple read by an OPTIMISTIC transaction has changed since it was read.
+   * Must be called with validation_latch_ held.
+   * @param txn the transaction to validate
+   * @return true if validation succeeded
+   */
+  bool Validate(Transaction *txn);
+
+  /**
+   * Installs the buffered writes of an OPTIMISTIC transaction. The installed writes are recorded in the regular
+   * table/index write sets, so a partially installed transaction can be rolled back by Abort().
+   * Must be called with validation_latch_ held.
+   * @param txn the transaction whose writes are installed
+   * @return true if every write was installed
+   */
+  bool InstallWrites(Transaction *txn);
+
+  /** @return The RIDs in the write set of a transaction, taken before the write set is applied or rolled back */
+  static std::vector<RID> WrittenRids(Transaction *txn);
+
+  /**
+   * Bumps the version of the tuples a finishing transaction wrote, once its writes are applied or rolled back.
+   * @param rids the RIDs of the tuples
+   */
+  void BumpVersions(const std::vector<RID> &rids);
+
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** OCC: serializes the validation and write phases of OPTIMISTIC transactions. */
+  std::mutex validation_latch_;
+  /** OCC: protects tuple_versions_. */
+  std::mutex version_latch_;
+  /** OCC: the version of every tuple that has been written; tuples that were never written have version 0. */
+  std::unordered_map<RID, version_t> tuple_versions_;
+  /** OCC: the next version handed out to a finishing writer. */
+  version_t next_version_{1};
 };
 
 }  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/container/art/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+// bytes of compressed path stored in an inner node, longer common prefixes become chains of nodes
+static constexpr size_t ART_MAX_PREFIX = 8;
+
+/**
+ * In-memory adaptive radix tree mapping byte string keys to RIDs. Non-unique
+ * keys are supported, a key maps to the set of RIDs inserted with it.
+ *
+ * Inner nodes adapt their size to their number of children: 4, 16, 48 or 256.
+ * A key ends in a leaf as soon as no other key shares its path (lazy expansion),
+ * and the bytes all keys below a node share are stored in the node (path
+ * compression). Keys must be prefix-free, i.e. no key is a proper prefix of
+ * another one, which holds for the KeyNormalizer encodings of one key schema.
+ *
+ * Concurrency uses optimistic lock coupling. Every inner node has a version
+ * with a lock bit. Readers do not write shared memory: they check that the
+ * versions of the nodes they went through did not change and restart otherwise.
+ * Writers lock the nodes they modify or replace. A removal unlinks the whole
+ * chain of nodes it leaves empty, and folds a node left with a single child
+ * into that child when their prefixes fit into one. Leaves are never modified but
+ * replaced, and a replaced node is only freed once every operation that may
+ * still be reading it has finished (epoch based reclamation).
+ */
+class AdaptiveRadixTree {
+ public:
+  AdaptiveRadixTree();
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  /**
+   * Inserts a key-value pair.
+   * @return false if the pair already exists
+   * @throws Exception if key is a proper prefix of a key in the tree or the other way around
+   */
+  bool Insert(std::string_view key, const RID &value);
+
+  /**
+   * Removes a key-value pair.
+   * @return false if the pair does not exist
+   */
+  bool Remove(std::string_view key, const RID &value);
+
+  /**
+   * Appends the values associated with key to result.
+   * @return true if any value was found
+   */
+  bool GetValue(std::string_view key, std::vector<RID> *result);
+
+  /** @return the number of inner nodes, the root included; not thread safe, for tests */
+  size_t GetInnerNodeCount() const;
+
+ private:
+  struct Node;
+  struct Leaf;
+  struct InnerNode;
+  // Node4 and Node16
+  template <int Capacity>
+  struct SmallNode;
+  struct Node48;
+  struct Node256;
+  class EpochGuard;
+
+  static InnerNode *NewNode(uint8_t type);
+  static Node *FindChild(const InnerNode *node, uint8_t byte);
+  template <typename F>
+  static void ForEachChild(const InnerNode *node, F &&f);
+  static bool IsFull(const InnerNode *node);
+  // true if removing a child should move the node to the next smaller type
+  static bool ShouldShrink(const InnerNode *node);
+  static void AddChild(InnerNode *node, uint8_t byte, Node *child);
+  static void ReplaceChild(InnerNode *node, uint8_t byte, Node *child);
+  static void RemoveChild(InnerNode *node, uint8_t byte);
+  /** @return a copy of node of the given type, without the child at skip if skip is a byte */
+  static InnerNode *CopyAs(const InnerNode *node, uint8_t type, int skip);
+  /** @return the number of bytes of the node's prefix that match key from depth on */
+  static size_t PrefixMatch(const InnerNode *node, std::string_view key, size_t depth);
+  /** Builds the nodes telling two leaves apart, their keys being equal up to depth. */
+  static Node *MakeBranch(Leaf *first, Leaf *second, size_t depth);
+  static void FreeNode(Node *node);
+  static void FreeTree(Node *node);
+  static size_t CountInnerNodes(const Node *node);
+
+  // each returns std::nullopt when it has to restart from the root
+  std::optional<bool> TryInsert(std::string_view key, const RID &value);
+  std::optional<bool> TryRemove(std::string_view key, const RID &value);
+  std::optional<bool> TryGetValue(std::string_view key, std::vector<RID> *result);
+
+  /** Hands an unlinked node over to epoch based reclamation. */
+  void Retire(Node *node);
+  /** Starts the next epoch and frees the nodes nobody can reach any more, if all older operations have finished. */
+  void TryAdvanceEpoch();
+
+  // the root is a Node256 without prefix that is never replaced
+  InnerNode *root_;
+
+  // 三个epoch轮流使用：epoch e里退休的节点在epoch e + 2开始时释放
+  std::mutex epoch_latch_;
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<int> active_[3] = {};
+  std::vector<Node *> retired_[3];
+  std::atomic<size_t> retired_count_{0};
+};
+
+}  // namespace bustub
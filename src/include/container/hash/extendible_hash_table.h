@@ -12,14 +12,18 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_header_page.h"
+#include "storage/page/hash_table_directory_index_page.h"
 #include "storage/page/hash_table_directory_page.h"
 
 namespace bustub {
@@ -30,6 +34,15 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * The directory is a header page pointing to up to HEADER_ARRAY_SIZE directory
+ * pages, so a lookup costs one directory page access on top of the bucket. Larger
+ * directories add levels of directory index pages in between, one access each,
+ * up to a global depth of MAX_BUCKET_DEPTH.
+ *
+ * Lookups, inserts and removes only latch the bucket they touch: the directory
+ * is read optimistically and validated against a version counter that splits
+ * and merges bump around every directory modification.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
@@ -50,10 +63,29 @@ class ExtendibleHashTable {
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
-   * @return true if insert succeeded, false otherwise
+   * @return true if insert succeeded, false if the pair is already in the table or the bucket of the key is full
+   * of pairs with the same hash, which no split can separate
    */
   bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Inserts a batch of key-value pairs into the hash table.
+   *
+   * The directory is first grown so that the pairs already in the table and the batch
+   * spread over enough buckets, so that a table loaded batch after batch keeps its
+   * buckets at most about 3/4 full. The pairs are then partitioned by the low bits of
+   * their hash and every bucket is filled in one go, latching it once instead of once
+   * per pair. Pairs that land in a bucket that is already full fall back to Insert
+   * once the batch is done.
+   *
+   * Concurrent operations wait until the batch has been loaded.
+   *
+   * @param transaction the current transaction
+   * @param entries the key-value pairs to insert
+   * @return true if every pair was inserted, false if any insert failed
+   */
+  bool BulkInsert(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &entries);
+
   /**
    * Deletes the associated value for the given key.
    *
@@ -74,6 +106,11 @@ class ExtendibleHashTable {
    */
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result);
 
+  /**
+   * @return the number of pairs bulk inserts could not place in their bucket, which went through Insert
+   */
+  size_t GetNumOverflowPairs() const { return num_overflow_pairs_.load(std::memory_order_relaxed); }
+
   /**
    * Returns the global depth.  Do not touch.
    */
@@ -107,34 +144,134 @@ class ExtendibleHashTable {
    * representation.
    *
    * @param key the key to use for lookup
-   * @param dir_page to use for lookup of global depth
+   * @param header_page to use for lookup of global depth
    * @return the directory index
    */
-  inline uint32_t KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page);
+  inline uint32_t KeyToDirectoryIndex(KeyType key, HashTableDirectoryHeaderPage *header_page);
 
   /**
    * Get the bucket page_id corresponding to a key.
    *
    * @param key the key for lookup
-   * @param dir_page a pointer to the hash table's directory page
+   * @param header_page a pointer to the hash table's header page
    * @return the bucket page_id corresponding to the input key
    */
-  inline uint32_t KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page);
+  inline page_id_t KeyToPageId(KeyType key, HashTableDirectoryHeaderPage *header_page);
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Fetches the header page from the buffer pool manager. Every operation pins it once and unpins it at the end.
    *
+   * @return a pointer to the header page
+   */
+  HashTableDirectoryHeaderPage *FetchHeaderPage();
+
+  /**
+   * Looks up the page_id of a directory page, going down the directory index pages between the header and it.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param directory_idx the number of the directory page, i.e. a directory index / DIRECTORY_ARRAY_SIZE
+   * @return the page_id of the directory page
+   */
+  page_id_t GetDirectoryPageId(HashTableDirectoryHeaderPage *header_page, uint32_t directory_idx);
+
+  /**
+   * Appends a directory page to the directory, adding directory index pages and index levels as needed.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param directory_page_id the page_id of the new directory page
+   */
+  void AddDirectoryPage(HashTableDirectoryHeaderPage *header_page, page_id_t directory_page_id);
+
+  /** @return the page_id of a new directory index page */
+  page_id_t NewDirectoryIndexPage();
+
+  /**
+   * Fetches the directory page holding a directory index from the buffer pool manager.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param bucket_idx the directory index
    * @return a pointer to the directory page
    */
-  HashTableDirectoryPage *FetchDirectoryPage();
+  HashTableDirectoryPage *FetchDirectoryPage(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx);
+
+  /**
+   * Looks up the bucket page_id and local depth stored at a directory index.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param bucket_idx the directory index
+   * @param[out] local_depth the local depth of the bucket
+   * @return the bucket page_id
+   */
+  page_id_t LookupBucket(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx, uint32_t *local_depth);
+
+  /**
+   * Points every directory index that shares the low local_depth bits with bucket_idx to a bucket.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param bucket_idx a directory index of the bucket
+   * @param local_depth the local depth of the bucket
+   * @param bucket_page_id the bucket page_id
+   */
+  void SetBuckets(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx, uint32_t local_depth,
+                  page_id_t bucket_page_id);
+
+  /** Doubles the directory, copying directory pages once it no longer fits in a single page. */
+  void GrowDirectory(HashTableDirectoryHeaderPage *header_page);
+
+  /**
+   * Splits the bucket at a directory index into 2^(target_depth - local_depth) buckets of local depth
+   * target_depth. The global depth must be at least target_depth.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param bucket_idx the lowest directory index of the bucket
+   * @param bucket_page_id the page_id of the bucket
+   * @param local_depth the local depth of the bucket
+   * @param target_depth the local depth of the resulting buckets
+   */
+  void SplitBucketTo(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx, page_id_t bucket_page_id,
+                     uint32_t local_depth, uint32_t target_depth);
+
+  /** @return true if no bucket has local depth equal to the global depth */
+  bool CanShrink(HashTableDirectoryHeaderPage *header_page);
+
+  /** Halves the directory. Directory pages that fall out of use stay allocated for later growth. */
+  void ShrinkDirectory(HashTableDirectoryHeaderPage *header_page);
 
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
    * @param bucket_page_id the page_id to fetch
+   * @param[out] page the pinned page holding the bucket
    * @return a pointer to a bucket page
    */
-  HASH_TABLE_BUCKET_TYPE *FetchBucketPage(page_id_t bucket_page_id);
+  HASH_TABLE_BUCKET_TYPE *FetchBucketPage(page_id_t bucket_page_id, Page **page);
+
+  /**
+   * Fetches and latches the bucket page a key maps to. The directory is read without
+   * any latch and the mapping is re-validated against the directory version once the
+   * bucket latch is held, retrying if a split or merge got in between.
+   *
+   * @param header_page a pointer to the hash table's header page
+   * @param key the key for lookup
+   * @param exclusive whether to take the bucket latch in write mode
+   * @param[out] page the pinned and latched page holding the bucket
+   * @return a pointer to the bucket page
+   */
+  HASH_TABLE_BUCKET_TYPE *LatchBucketPage(HashTableDirectoryHeaderPage *header_page, const KeyType &key,
+                                          bool exclusive, Page **page);
+
+  /**
+   * @param bucket a bucket page
+   * @param hash a hash
+   * @return true if every pair of the bucket has this hash, so that no split can move them apart
+   */
+  bool SameHash(HASH_TABLE_BUCKET_TYPE *bucket, uint32_t hash);
+
+  /** Marks the start of a directory modification, the directory version becomes odd. */
+  void BeginDirectoryUpdate();
+
+  /** Marks the end of a directory modification, the directory version becomes even. */
+  void EndDirectoryUpdate();
 
   /**
    * Performs insertion with an optional bucket splitting.
@@ -161,15 +298,18 @@ class ExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
-  // 创建Directory的锁
-  std::mutex directory_lock_;
-
   // member variables
-  page_id_t directory_page_id_;
+  page_id_t header_page_id_;
+  // 目录版本号，分裂/合并修改目录期间为奇数
+  std::atomic<uint64_t> directory_version_{0};
+  // 表中的数据条数，只在内存中维护，批量插入用它估算目录深度
+  std::atomic<size_t> num_pairs_{0};
+  // 批量插入时桶已满、改走Insert的数据条数
+  std::atomic<size_t> num_overflow_pairs_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Only splits and merges take this latch (as writers), inserts and removes latch single buckets
   ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -31,7 +32,12 @@ namespace bustub {
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table dynamically grows once full.
+ * table dynamically grows once half of its buckets are occupied.
+ *
+ * Growing is incremental: a resize only allocates the new blocks, and every
+ * following operation moves a few blocks of the old table into the new one
+ * before it runs. Until the old table is drained, lookups and removes probe
+ * both tables and inserts go to the new table.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -75,7 +81,9 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. Any resize in
+   * progress is finished first; the entries of the current table are then moved
+   * into the new blocks by the following operations.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -87,8 +95,52 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  /**
+   * Calls visit on every bucket of the old or the new table in probing order,
+   * starting at the bucket the key hashes to, until visit returns true or
+   * every bucket has been visited.
+   *
+   * @param old_table whether to probe the old table of a resize in progress
+   * @param key the key to probe for
+   * @param is_dirty whether visit modifies the blocks
+   * @param visit called with a block and an index in the block
+   * @return true if visit returned true
+   */
+  template <typename Func>
+  bool Probe(bool old_table, const KeyType &key, bool is_dirty, Func &&visit);
+
+  /**
+   * Inserts a key-value pair into the new table.
+   *
+   * @param key the key to insert
+   * @param value the value to insert
+   * @param[out] duplicate set to true if the pair is already present, pass nullptr to skip the check
+   * @return true if inserted, false if the pair is a duplicate or the table is full
+   */
+  bool InsertIntoTable(const KeyType &key, const ValueType &value, bool *duplicate);
+
+  /**
+   * Moves up to max_blocks blocks of the old table into the new table, and
+   * finishes the resize once the old table is drained. Must be called with
+   * table_latch_ held in write mode.
+   *
+   * @param max_blocks the maximum number of blocks to move
+   */
+  void MigrateBlocks(size_t max_blocks);
+
+  /**
+   * Moves a few blocks if a resize is in progress, called before every operation.
+   */
+  void MigrateSome();
+
   // member variable
   page_id_t header_page_id_;
+  // header页在哈希表的生命周期内一直pin在buffer pool中
+  HashTableHeaderPage *header_page_;
+  // 是否正在迁移，操作开始时无锁检查
+  std::atomic<bool> migrating_{false};
+  // 新表中被占用（含墓碑）的slot数，用于决定何时扩容
+  std::atomic<size_t> num_occupied_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
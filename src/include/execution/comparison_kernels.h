@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// comparison_kernels.h
+//
+// Identification: src/include/execution/comparison_kernels.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "execution/expressions/comparison_expression.h"
+
+namespace bustub {
+
+/**
+ * ComparisonKernels compares vectors of integers, a column against a column or against a constant,
+ * producing a selection bitmap: bit i % 64 of word i / 64 is set if the comparison is true for value i.
+ *
+ * There is a kernel for every ComparisonType and for 32 and 64 bit integers; narrower columns are
+ * compared as 32 bit integers. With AVX2 the kernels compare 8 (32 bit) or 4 (64 bit) values per
+ * instruction, and the leftover values one at a time.
+ */
+class ComparisonKernels {
+ public:
+  /**
+   * A comparison kernel.
+   * The arguments are the left values, the right values (a single value if the kernel compares against a
+   * constant), the number of values and the bitmap, which must have room for them.
+   */
+  template <typename T>
+  using Kernel = void (*)(const T *, const T *, uint32_t, uint64_t *);
+
+  /**
+   * @param comp_type the comparison
+   * @param constant_rhs whether the right side is a single constant
+   * @return The kernel for the comparison of values of type T, int32_t or int64_t
+   */
+  template <typename T>
+  static Kernel<T> GetKernel(ComparisonType comp_type, bool constant_rhs);
+
+  /**
+   * @param comp_type a comparison
+   * @return The comparison with its sides swapped, e.g. GreaterThan for LessThan
+   */
+  static ComparisonType Flip(ComparisonType comp_type);
+
+  /** @return The number of 64 bit words of a bitmap of count values */
+  static uint32_t BitmapWords(uint32_t count) { return (count + 63) / 64; }
+
+  /**
+   * Turns a bitmap into a selection vector.
+   * @param bitmap the bitmap
+   * @param count the number of values of the bitmap
+   * @param[out] selection the positions of the set bits, in increasing order
+   * @return The number of set bits
+   */
+  static uint32_t ToSelection(const uint64_t *bitmap, uint32_t count, uint32_t *selection);
+};
+
+}  // namespace bustub
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_scan.h
+//
+// Identification: src/include/execution/compiled_scan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * CompiledScan is the filter and the projection of a sequential scan plan, applied to the tuples of a
+ * table page while they are still in the page (see TableHeap::ScanPage()). Only the tuples that satisfy
+ * the predicate are materialized, and only their output columns.
+ *
+ * A predicate that compares an integer column with an integer column or a non-null integer constant is
+ * compiled: the columns it compares are gathered into vectors of 32 or 64 bit integers, which a
+ * ComparisonKernels kernel picked once per plan compares into a selection bitmap, together with the null
+ * checks. Output columns that are columns of the table are deserialized straight from the page into the
+ * batch. Other predicates and output columns are interpreted, against the tuples in place.
+ */
+class CompiledScan {
+ public:
+  /**
+   * Compiles a sequential scan plan.
+   * @param plan the plan
+   * @param table_schema the schema of the table the plan scans
+   */
+  CompiledScan(const SeqScanPlanNode *plan, const Schema *table_schema);
+
+  /** @return `true` if the predicate runs on comparison kernels, `false` if it is interpreted or there is none */
+  bool HasKernelFilter() const { return has_kernel_; }
+
+  /**
+   * Appends the tuples that satisfy the predicate to a batch, until the batch is full.
+   * @param tuples the tuples of a page, pointing into the latched page
+   * @param batch the batch
+   * @return The number of tuples consumed, fewer than all if the batch filled up
+   */
+  uint32_t FilterTuples(const std::vector<Tuple> &tuples, TupleBatch *batch);
+
+ private:
+  /** An operand of the comparison of the predicate: an integer column, or an integer constant */
+  struct Operand {
+    /** `true` for a column, `false` for a constant */
+    bool is_column_;
+    /** The type of the column */
+    TypeId type_;
+    /** The offset of the column in the tuple */
+    uint32_t offset_;
+    /** The constant, widened to 64 bits */
+    int64_t constant_;
+  };
+
+  /** A column of the output */
+  struct OutputColumn {
+    /** The expression of the column, `nullptr` if the column is deserialized from the tuple */
+    const AbstractExpression *expr_;
+    /** The type of the column */
+    TypeId type_;
+    /** The offset of the column in the tuple, which holds the offset of the data if the column is not inlined */
+    uint32_t offset_;
+    /** Whether the column is stored in place */
+    bool inlined_;
+  };
+
+  /** @return The operand, std::nullopt if the expression is not an integer column or non-null constant */
+  static std::optional<Operand> CompileOperand(const AbstractExpression *expr, const Schema *table_schema);
+
+  /** @return `false` if the predicate does not compile to a kernel */
+  bool CompileFilter(const AbstractExpression *predicate, const Schema *table_schema);
+
+  /**
+   * Selects the tuples that satisfy the compiled predicate, comparing values of type T.
+   * @param tuples the tuples
+   * @param count the number of tuples to filter
+   * @param lhs, rhs the buffers the operands are gathered into
+   * @return The number of selected tuples, whose positions are written to selection_
+   */
+  template <typename T>
+  uint32_t SelectWithKernel(const Tuple *tuples, uint32_t count, std::vector<T> *lhs, std::vector<T> *rhs);
+
+  /** The schema of the table */
+  const Schema *table_schema_;
+  /** The predicate, `nullptr` if there is none */
+  const AbstractExpression *predicate_;
+  /** Whether the predicate is compiled to a kernel */
+  bool has_kernel_{false};
+  /** The operands of the comparison of the compiled predicate, the left one being a column */
+  Operand left_{};
+  Operand right_{};
+  /** The comparison of the compiled predicate */
+  ComparisonType comp_type_{ComparisonType::Equal};
+  /** Whether the operands are compared as 64 bit integers, 32 bit integers being enough otherwise */
+  bool wide_{false};
+  /** The output columns */
+  std::vector<OutputColumn> outputs_;
+
+  /** The positions of the selected tuples */
+  std::vector<uint32_t> selection_;
+  /** The gathered operands, and the selection bitmaps of the comparison and of the null checks */
+  std::vector<int32_t> narrow_lhs_;
+  std::vector<int32_t> narrow_rhs_;
+  std::vector<int64_t> wide_lhs_;
+  std::vector<int64_t> wide_rhs_;
+  std::vector<uint64_t> bitmap_;
+  std::vector<uint64_t> valid_;
+  /** The values of the output row being appended */
+  std::vector<Value> values_;
+};
+
+}  // namespace bustub
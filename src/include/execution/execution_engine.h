@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -19,6 +23,7 @@
 #include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
+#include "execution/morsel_scheduler.h"
 #include "execution/plans/abstract_plan.h"
 #include "storage/table/tuple.h"
 namespace bustub {
@@ -45,33 +50,72 @@ class ExecutionEngine {
    * @param result_set The set of tuples produced by executing the plan
    * @param txn The transaction context in which the query executes
    * @param exec_ctx The executor context in which the query executes
-   * @return `true` if execution of the query plan succeeds, `false` otherwise
+   * @return `true` once the query plan ran to completion
+   * @throws the first exception an executor threw, whether the plan ran on one thread or several; result_set then
+   * holds none of the tuples of the query
    */
   bool Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
                ExecutorContext *exec_ctx) {
+    // A plan that is a single pipeline runs on all threads
+    if (MorselScheduler::CanRunParallel(exec_ctx) && MorselScheduler::GetPipelineSource(plan) != nullptr) {
+      ExecuteParallel(plan, result_set, exec_ctx);
+      return true;
+    }
+
     // Construct and executor for the plan
     auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
 
     // Prepare the root executor
     executor->Init();
 
-    // Execute the query plan
+    // Execute the query plan; like on the parallel path, a failed query returns no partial result
+    const size_t num_results = result_set != nullptr ? result_set->size() : 0;
     try {
-      Tuple tuple;
-      RID rid;
-      while (executor->Next(&tuple, &rid)) {
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
         if (result_set != nullptr) {
-          result_set->push_back(tuple);
+          for (auto row : batch.GetSelection()) {
+            result_set->emplace_back(batch.GetTuple(row));
+          }
         }
       }
-    } catch (Exception &e) {
-      // TODO(student): handle exceptions
+    } catch (...) {
+      if (result_set != nullptr) {
+        result_set->erase(result_set->begin() + num_results, result_set->end());
+      }
+      throw;
     }
 
     return true;
   }
 
  private:
+  /** Executes a plan that is a pipeline on the threads of the executor context, keeping the order of the tuples. */
+  void ExecuteParallel(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, ExecutorContext *exec_ctx) {
+    // Every worker keeps the tuples of the morsels it read, which are put back into table order at the end
+    std::vector<std::map<size_t, std::vector<Tuple>>> worker_results(exec_ctx->GetNumThreads());
+    // The first exception of a worker is rethrown once all workers stopped, and the partial results are dropped
+    MorselScheduler::RunPipeline(exec_ctx, plan, [&](size_t worker, size_t morsel, const TupleBatch &batch) {
+      if (result_set != nullptr) {
+        auto &tuples = worker_results[worker][morsel];
+        for (auto row : batch.GetSelection()) {
+          tuples.emplace_back(batch.GetTuple(row));
+        }
+      }
+      return true;
+    });
+
+    if (result_set != nullptr) {
+      std::map<size_t, std::vector<Tuple>> morsel_results;
+      for (auto &results : worker_results) {
+        morsel_results.merge(results);
+      }
+      for (auto &[morsel, tuples] : morsel_results) {
+        std::move(tuples.begin(), tuples.end(), std::back_inserter(*result_set));
+      }
+    }
+  }
+
   /** The buffer pool manager used during query execution */
   [[maybe_unused]] BufferPoolManager *bpm_;
   /** The transaction manager used during query execution */
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <thread>  // NOLINT
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -60,6 +62,18 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the bytes of memory an executor may use for its state before it spills to disk */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
+  /** Sets the bytes of memory an executor may use for its state before it spills to disk. */
+  void SetMemoryBudget(size_t memory_budget) { memory_budget_ = memory_budget; }
+
+  /** @return the number of threads an executor may run its work on */
+  size_t GetNumThreads() const { return num_threads_; }
+
+  /** Sets the number of threads an executor may run its work on. */
+  void SetNumThreads(size_t num_threads) { num_threads_ = std::max<size_t>(num_threads, 1); }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +85,10 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The memory budget of each executor, in bytes */
+  size_t memory_budget_{OPERATOR_MEMORY_BUDGET};
+  /** The number of threads of each executor, one per core by default */
+  size_t num_threads_{std::max(std::thread::hardware_concurrency(), 1U)};
 };
 
 }  // namespace bustub
@@ -18,6 +18,8 @@
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
+struct PipelineWorker;
+
 /**
  * ExecutorFactory creates executors for arbitrary plan nodes.
  */
@@ -27,8 +29,10 @@ class ExecutorFactory {
    * Creates a new executor given the executor context and plan node.
    * @param exec_ctx The executor context for the created executor
    * @param plan The plan node that needs to be executed
+   * @param pipeline The worker the executors run a pipeline on, `nullptr` if they do not run on morsels
    * @return An executor for the given plan in the provided context
    */
-  static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
+  static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                                                          PipelineWorker *pipeline = nullptr);
 };
 }  // namespace bustub
@@ -13,12 +13,10 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/util/hash_util.h"
-#include "container/hash/hash_function.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
@@ -29,132 +27,107 @@
 namespace bustub {
 
 /**
- * A simplified hash table that has all the necessary functionality for aggregations.
+ * The hash table of an aggregation, mapping the group-by values of a group to its running aggregates.
+ *
+ * The table is flat: the groups are numbered in insertion order and their keys, hashes and aggregates
+ * are stored in arrays indexed by group number. The slots of the open addressing table hold a tag of the
+ * hash and the group number, so looking up a group takes one probe sequence that rarely compares a key.
+ *
+ * An aggregate over an integer input, and any COUNT, is accumulated in an int64_t. Other aggregates,
+ * e.g. the SUM of a decimal, fall back to Value arithmetic. Null group-by values are equal to each other.
  */
-class SimpleAggregationHashTable {
+class AggregationHashTable {
  public:
   /**
-   * Construct a new SimpleAggregationHashTable instance.
+   * Construct a new AggregationHashTable instance.
+   * @param num_group_bys the number of group-by values of a key
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
    */
-  SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return The initial aggregrate value for this aggregation executor */
-  AggregateValue GenerateInitialAggregateValue() {
-    std::vector<Value> values{};
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountAggregate:
-          // Count starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::MinAggregate:
-          // Min starts at INT_MAX.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX));
-          break;
-        case AggregationType::MaxAggregate:
-          // Max starts at INT_MIN.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN));
-          break;
-      }
-    }
-    return {values};
-  }
+  AggregationHashTable(size_t num_group_bys, const std::vector<const AbstractExpression *> &agg_exprs,
+                       const std::vector<AggregationType> &agg_types);
+
+  /** @return The hash of the group-by values of a row, given one column per group-by */
+  static hash_t HashKey(const std::vector<std::vector<Value>> &group_by_columns, uint32_t row);
 
   /**
-   * Combines the input into the aggregation result.
-   * @param[out] result The output aggregate value
-   * @param input The input value
+   * Finds the group of the group-by values of a row, creating it if it does not exist yet.
+   * @param group_by_columns one column per group-by
+   * @param row the row in the columns
+   * @param hash the hash of the key, from HashKey()
+   * @return The group number
    */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountAggregate:
-          // Count increases by one.
-          result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum increases by addition.
-          result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
-          break;
-        case AggregationType::MinAggregate:
-          // Min is just the min.
-          result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
-          break;
-        case AggregationType::MaxAggregate:
-          // Max is just the max.
-          result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
-          break;
-      }
-    }
-  }
+  uint32_t FindOrInsert(const std::vector<std::vector<Value>> &group_by_columns, uint32_t row, hash_t hash);
 
   /**
-   * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
-   * @param agg_val the value to be inserted
+   * Combines the inputs of a row into the aggregates of a group.
+   * @param group the group number
+   * @param aggregate_columns one column per aggregate
+   * @param row the row in the columns
    */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
-  }
-
-  /** An iterator over the aggregation hash table */
-  class Iterator {
-   public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
-
-    /** @return The key of the iterator */
-    const AggregateKey &Key() { return iter_->first; }
-
-    /** @return The value of the iterator */
-    const AggregateValue &Val() { return iter_->second; }
-
-    /** @return The iterator before it is incremented */
-    Iterator &operator++() {
-      ++iter_;
-      return *this;
-    }
-
-    /** @return `true` if both iterators are identical */
-    bool operator==(const Iterator &other) { return this->iter_ == other.iter_; }
-
-    /** @return `true` if both iterators are different */
-    bool operator!=(const Iterator &other) { return this->iter_ != other.iter_; }
-
-   private:
-    /** Aggregates map */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
-  };
+  void Update(uint32_t group, const std::vector<std::vector<Value>> &aggregate_columns, uint32_t row);
+
+  /** Combines all groups of another table, for the same aggregation, into this one. */
+  void Merge(const AggregationHashTable &other);
 
-  /** @return Iterator to the start of the hash table */
-  Iterator Begin() { return Iterator{ht_.cbegin()}; }
+  /** @return The number of groups */
+  size_t GetSize() const { return hashes_.size(); }
+
+  /**
+   * Reads the key and the aggregates of a group.
+   * @param group the group number
+   * @param[out] group_bys the group-by values, replacing the contents of the vector
+   * @param[out] aggregates the aggregates, replacing the contents of the vector
+   */
+  void GetGroup(uint32_t group, std::vector<Value> *group_bys, std::vector<Value> *aggregates) const;
 
-  /** @return Iterator to the end of the hash table */
-  Iterator End() { return Iterator{ht_.cend()}; }
+  /** Removes all the groups from the hash table. */
+  void Clear();
 
  private:
-  /** The hash table is just a map from aggregate keys to aggregate values */
-  std::unordered_map<AggregateKey, AggregateValue> ht_{};
-  /** The aggregate expressions that we have */
-  const std::vector<const AbstractExpression *> &agg_exprs_;
+  /** A slot of the open addressing table, an empty slot has tag 0 */
+  struct Slot {
+    uint32_t tag_;
+    uint32_t group_;
+  };
+
+  /** @return The group whose key has the hash and the values key_at(0), key_at(1), ..., after creating it */
+  template <typename KeyAt>
+  uint32_t FindOrInsert(hash_t hash, KeyAt &&key_at);
+
+  /** Doubles the number of slots. */
+  void Grow();
+
+  /** The number of group-by values of a key */
+  size_t num_group_bys_;
   /** The types of aggregations that we have */
-  const std::vector<AggregationType> &agg_types_;
+  std::vector<AggregationType> agg_types_;
+  /** The input types of the aggregations */
+  std::vector<TypeId> input_types_;
+  /** Whether an aggregate is accumulated in ints_ rather than values_ */
+  std::vector<bool> typed_;
+
+  /** The slots, a power of two of them */
+  std::vector<Slot> slots_;
+  /** The hash of every group */
+  std::vector<hash_t> hashes_;
+  /** The group-by values of every group, num_group_bys_ per group */
+  std::vector<Value> keys_;
+  /** The aggregates of every group, one entry per aggregate in ints_ and nulls_, or values_ if it is not typed */
+  std::vector<int64_t> ints_;
+  std::vector<uint8_t> nulls_;
+  std::vector<Value> values_;
 };
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * The aggregation runs on the threads of the executor context. If the child is a pipeline, every worker
+ * runs it on morsels of the table itself; otherwise the calling thread reads the child a batch at a time
+ * and hands the batches to the workers. A worker aggregates into a thread-local table for each radix
+ * partition of the group hashes. The partitions are then merged in parallel, each by one thread, so the
+ * merge needs no latching either.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -178,39 +151,51 @@ class AggregationExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation.
+   * @param[out] batch The batch of tuples produced by the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the aggregation */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
   /** Do not use or remove this function, otherwise you will get zero points. */
   const AbstractExecutor *GetChildExecutor() const;
 
+  /** The number of radix partitions of the group hashes, the most threads the merge runs on */
+  static constexpr size_t NUM_PARTITIONS = 16;
+
  private:
-  /** @return The tuple as an AggregateKey */
-  AggregateKey MakeAggregateKey(const Tuple *tuple) {
-    std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {keys};
-  }
-
-  /** @return The tuple as an AggregateValue */
-  AggregateValue MakeAggregateValue(const Tuple *tuple) {
-    std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {vals};
-  }
+  /** @return A hash table per partition */
+  std::vector<AggregationHashTable> MakePartitions() const;
+
+  /** Aggregates a batch of the child into a hash table per partition. */
+  void AggregateBatch(const TupleBatch &batch, std::vector<AggregationHashTable> *partitions) const;
+
+  /** Reads the child on this thread and aggregates its batches on worker threads, into a table per partition each. */
+  void AggregateChild(std::vector<std::vector<AggregationHashTable>> *local_partitions);
+
+  /**
+   * Move to the next group that satisfies the HAVING clause.
+   * @param[out] values The output columns of the group, appended to the (empty) vector
+   * @return `false` if there are no more groups
+   */
+  bool NextGroup(std::vector<Value> *values);
 
  private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  // TODO(Student): Uncomment SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator */
-  // TODO(Student): Uncomment SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The aggregation hash table of each partition */
+  std::vector<AggregationHashTable> partitions_;
+  /** The partition and the group of it to output next */
+  size_t partition_idx_{0};
+  uint32_t group_idx_{0};
+  /** The group-by values and the aggregates of the group being output */
+  std::vector<Value> group_bys_;
+  std::vector<Value> aggregates_;
 };
 }  // namespace bustub
@@ -60,5 +60,9 @@ class DeleteExecutor : public AbstractExecutor {
   const DeletePlanNode *plan_;
   /** The child executor from which RIDs for deleted tuples are pulled */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Metadata identifying the table that should be deleted from */
+  const TableInfo *table_info_;
+  /** The indexes of the table that must be maintained */
+  std::vector<IndexInfo *> indexes_;
 };
 }  // namespace bustub
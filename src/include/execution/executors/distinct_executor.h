@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_set>
 #include <utility>
 
 #include "execution/executors/abstract_executor.h"
@@ -45,6 +46,13 @@ class DistinctExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the distinct, which removes the duplicates from the selection vector.
+   * @param[out] batch The batch of tuples produced by the distinct
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the distinct */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
@@ -53,5 +61,7 @@ class DistinctExecutor : public AbstractExecutor {
   const DistinctPlanNode *plan_;
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The rows produced so far */
+  std::unordered_set<DistinctKey> seen_;
 };
 }  // namespace bustub
@@ -12,18 +12,42 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/abstract_expression.h"
 #include "execution/plans/hash_join_plan.h"
+#include "storage/page/tmp_tuple_page.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hash JOIN on two tables.
+ *
+ * The left child is the build side: Init() reads it into a hash table keyed on the left join key.
+ * The right child is the probe side and is read as the join produces its output.
+ *
+ * The build rows are radix partitioned on the low bits of their hash so that the hash table of each
+ * partition fits in the L2 cache. The tables use open addressing with linear probing, a slot storing a
+ * 32-bit tag of the hash next to the row, so most mismatches are rejected without touching the row.
+ * The right rows are probed a batch at a time: the hashes of the whole batch are computed and their
+ * slots prefetched before any of them is looked up.
+ *
+ * If the left child is a pipeline, the workers of the executor context each run it on morsels of its table,
+ * collecting the build rows in parallel. A build side that turns out not to fit in the memory budget is read
+ * again on the calling thread, as below.
+ *
+ * If the build side does not fit in the memory budget of the executor context, the join turns into a
+ * Grace hash join: both sides are partitioned on the high bits of their hash and written to temporary
+ * pages of the buffer pool, then joined one partition at a time. A partition whose build side does not
+ * fit in the budget either is partitioned again on the next bits of the hash, up to MAX_SPILL_LEVELS
+ * times. A partition is only joined in memory without fitting if its build rows did not spread out over
+ * the last partitioning, i.e. for heavily skewed keys.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -37,6 +61,9 @@ class HashJoinExecutor : public AbstractExecutor {
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
 
+  /** Deletes the temporary pages of a join that did not run to the end */
+  ~HashJoinExecutor() override;
+
   /** Initialize the join */
   void Init() override;
 
@@ -48,12 +75,136 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the join, probing the hash table with a batch of right tuples at a time.
+   * @param[out] batch The batch of tuples produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the join */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
+  /** @return `true` if the build side did not fit in memory and the join spilled to temporary pages */
+  bool IsSpilled() const { return spilled_; }
+
+  /** @return The number of spill partitions written so far, those partitioned again included */
+  size_t GetNumSpillPartitions() const { return spilled_build_.size(); }
+
+  /** The size in bytes the build rows of one in-memory partition are aimed at, about an L2 cache */
+  static constexpr size_t PARTITION_SIZE = 256 * 1024;
+  /** The largest number of partitions a spilled join writes each side to, a power of two */
+  static constexpr size_t SPILL_PARTITIONS = 16;
+  /** How many times the rows of a spill partition may be partitioned, each time on the next 4 bits of the hash */
+  static constexpr size_t MAX_SPILL_LEVELS = 8;
+
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** A row of the build side */
+  struct BuildRow {
+    hash_t hash_;
+    Value key_;
+    Tuple tuple_;
+  };
+
+  /** A slot of an open addressing hash table, an empty slot has tag 0 */
+  struct Slot {
+    uint32_t tag_;
+    uint32_t row_;
+  };
+
+  /** The hash table of one radix partition, a power of two number of slots starting at offset_ in slots_ */
+  struct PartitionTable {
+    size_t offset_;
+    size_t mask_;
+  };
+
+  /** @return the hash of a (non-null) join key */
+  static hash_t HashKey(const Value &key);
+
+  /**
+   * Reads the build side into build_rows_ on the threads of the executor context, the left child being a pipeline.
+   * @return `false`, with build_rows_ empty, if the build side does not fit in the memory budget
+   */
+  bool BuildInParallel();
+
+  /** Partitions build_rows_ and builds the hash table of each partition. */
+  void BuildTables();
+
+  /** Turns the join into a Grace hash join, spilling build_rows_ and then every row read after them. */
+  void StartSpilling();
+
+  /** Writes a tuple to the temporary pages of the spill partition of its hash, among the last ones added. */
+  void SpillTuple(std::vector<std::vector<page_id_t>> *partitions, hash_t hash, const Tuple &tuple);
+
+  /** Partitions both sides of the spill partition spill_idx_ again, into new partitions added at the end. */
+  void RepartitionSpill();
+
+  /** Unpins the temporary pages being written to. */
+  void FinishSpilling();
+
+  /** Reads the build side of the first spilled partition from spill_idx_ on with rows on both sides into memory. */
+  void LoadSpillPartition();
+
+  /** Reads the next batch of right rows into probe_batch_ and computes their hashes. */
+  bool ReadProbeBatch();
+
+  /** Joins the current right row with the build rows matching it, until the batch is full. */
+  void ProbeRow(TupleBatch *batch);
+
+  /** Append the output columns of the join of a left tuple with right_tuple_ to the (empty) vector. */
+  void JoinValues(const Tuple &left_tuple, std::vector<Value> *values);
+
+  /** Deletes the temporary pages that were not read yet. */
+  void DropSpillPages();
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  /** The build side of the join */
+  std::unique_ptr<AbstractExecutor> left_child_;
+  /** The probe side of the join */
+  std::unique_ptr<AbstractExecutor> right_child_;
+
+  /** The build rows in memory, grouped by partition once the tables are built */
+  std::vector<BuildRow> build_rows_;
+  /** The bytes of memory taken by build_rows_ and their slots */
+  size_t build_bytes_{0};
+  /** The number of low hash bits selecting the partition */
+  size_t partition_bits_{0};
+  /** The hash tables of the partitions */
+  std::vector<PartitionTable> tables_;
+  /** The slots of all hash tables */
+  std::vector<Slot> slots_;
+
+  /** Whether the join spilled to temporary pages */
+  bool spilled_{false};
+  /** The temporary pages of each spill partition of the build and the probe side, not read yet */
+  std::vector<std::vector<page_id_t>> spilled_build_;
+  std::vector<std::vector<page_id_t>> spilled_probe_;
+  /** How many times the rows of each spill partition were partitioned, the first time being level 0 */
+  std::vector<size_t> spill_levels_;
+  /** The pinned page being written to of each spill partition being written, one per partition of the fanout */
+  std::vector<TmpTuplePage *> spill_pages_;
+  /** The spill partition being joined */
+  size_t spill_idx_{0};
+
+  /** The batch of right rows being probed */
+  TupleBatch probe_batch_;
+  /** The rows of probe_batch_ with a non-null join key, their keys and their hashes */
+  std::vector<uint32_t> probe_rows_;
+  std::vector<Value> probe_keys_;
+  std::vector<hash_t> probe_hashes_;
+  /** The next entry of probe_rows_ to probe */
+  size_t probe_idx_{0};
+  /** Where the probe of the current right row continues, SIZE_MAX if it has not started */
+  size_t slot_pos_{SIZE_MAX};
+  /** The current right row as a tuple, once it has a match */
+  Tuple right_tuple_;
+  bool right_tuple_valid_{false};
+
+  /** The output of NextBatch() handed out one tuple at a time by Next() */
+  TupleBatch out_batch_;
+  /** The next selected row of out_batch_ to hand out */
+  size_t out_idx_{0};
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
@@ -23,7 +24,11 @@
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table, returning the tuples in key order.
+ *
+ * When the scan reads no column besides the ones the index stores (its key and
+ * INCLUDE columns), the output is built from the index entries alone and the
+ * table heap is never read (index-only scan).
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -41,8 +46,24 @@ class IndexScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** @return `true` if the scan reads the index entries only, valid after Init() */
+  bool IsIndexOnly() const { return index_only_; }
+
  private:
+  /** @return `true` if expr reads no table column besides the ones stored in the index entries */
+  bool IsCovered(const AbstractExpression *expr) const;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** Metadata identifying the index that is scanned */
+  const IndexInfo *index_info_;
+  /** Metadata identifying the table the index is built on */
+  const TableInfo *table_info_;
+  /** The cursor over the index, created in Init() */
+  std::unique_ptr<IndexCursor> cursor_;
+  /** Whether the output is built from the index entries */
+  bool index_only_{false};
+  /** A table row holding nulls in the columns the index does not store, filled from the entries */
+  std::vector<Value> row_;
 };
 }  // namespace bustub
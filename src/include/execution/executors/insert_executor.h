@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -57,8 +58,20 @@ class InsertExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
  private:
+  /**
+   * Insert a single tuple into the table and its indexes, or buffer it if the transaction is OPTIMISTIC.
+   * @param tuple The tuple to be inserted
+   */
+  void InsertTuple(Tuple *tuple);
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /** Metadata identifying the table that should be inserted into */
+  const TableInfo *table_info_;
+  /** The indexes of the table that must be maintained */
+  std::vector<IndexInfo *> indexes_;
+  /** The child executor to obtain values from (may be `nullptr`) */
+  std::unique_ptr<AbstractExecutor> child_executor_;
 };
 
 }  // namespace bustub
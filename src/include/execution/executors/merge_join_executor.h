@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/merge_join_plan.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinExecutor executes a merge JOIN on two inputs sorted in ascending order of their join keys.
+ *
+ * Both children are read once, in step: the side with the smaller key moves on until the keys are equal.
+ * The right rows that share a key (a group) are then buffered, and joined with every left row of that key.
+ * Rows whose key is null never match and are skipped.
+ *
+ * Only the current group is held, so a join of unique keys, e.g. two index scans, runs in constant memory.
+ * The rows of a group beyond the memory budget of the executor context are written to temporary pages of
+ * the buffer pool, which are read again for every left row of the key.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new MergeJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The merge join plan to be executed
+   * @param left_child The child executor that produces tuples for the left side of join
+   * @param right_child The child executor that produces tuples for the right side of join
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
+
+  /** Deletes the temporary pages of a group that was not read to the end */
+  ~MergeJoinExecutor() override;
+
+  /** Initialize the join. */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the join.
+   * @param[out] tuple The next tuple produced by the join
+   * @param[out] rid The next tuple RID produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The batch of tuples produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return The output schema for the join */
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  /** @return The number of temporary pages of the current group */
+  size_t GetNumGroupPages() const { return group_pages_.size(); }
+
+ private:
+  /** Moves to the next left row whose key is not null, `left_valid_` being `false` at the end. */
+  void AdvanceLeft();
+
+  /** Moves to the next right row whose key is not null, `right_valid_` being `false` at the end. */
+  void AdvanceRight();
+
+  /** Buffers the right rows that have the key of the current right row as the group. */
+  void LoadGroup();
+
+  /** @return The next right row of the group for the current left row, `nullptr` after the last one */
+  const Tuple *NextGroupTuple();
+
+  /** Starts reading the group from its first row. */
+  void RewindGroup();
+
+  /** Deletes the temporary pages of the group. */
+  void DropGroupPages();
+
+  /** The merge join plan node to be executed */
+  const MergeJoinPlanNode *plan_;
+  /** The child executors from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> left_child_;
+  std::unique_ptr<AbstractExecutor> right_child_;
+
+  /** The current left row and its key */
+  Tuple left_tuple_;
+  Value left_key_;
+  bool left_valid_{false};
+  /** The first right row after the group and its key */
+  Tuple right_tuple_;
+  Value right_key_;
+  bool right_valid_{false};
+
+  /** The key of the group, the rows of the group in memory and their size */
+  Value group_key_;
+  bool group_valid_{false};
+  std::vector<Tuple> group_;
+  size_t group_bytes_{0};
+  /** The temporary pages holding the rest of the group, and the page being written */
+  std::vector<page_id_t> group_pages_;
+  TmpTuplePage *spill_page_{nullptr};
+
+  /** The position in the group of the next right row for the current left row */
+  size_t group_idx_{0};
+  size_t group_page_idx_{0};
+  std::vector<Tuple> page_tuples_;
+  size_t page_tuple_idx_{0};
+
+  /** The output of Next(), read a batch at a time */
+  TupleBatch out_batch_;
+  uint32_t out_idx_{0};
+};
+
+}  // namespace bustub
@@ -29,9 +29,22 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ *
+ * The predicate compares an expression of the outer tuple, its left side, with the inner table's column that
+ * the index is built on; the left side is the key that is looked up in the index for every outer tuple. The
+ * inner tuples the index returns are checked against the whole predicate.
+ *
+ * The outer tuples are probed a batch at a time rather than one by one: the keys of the batch are sorted and
+ * each distinct key is looked up once, in key order, so a B+ tree index reads consecutive keys from the same
+ * leaf instead of descending from the root for each of them (see Index::ScanKeys()). The inner tuples the batch
+ * matches are then read in RID order, i.e. page by page, before the batch is joined. The output keeps the
+ * order of the outer tuples.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
+  /** The number of outer tuples probed together */
+  static constexpr size_t PROBE_BATCH_SIZE = 1024;
+
   /**
    * Creates a new nested index join executor.
    * @param exec_ctx the context that the hash join should be performed in
@@ -47,8 +60,37 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
  private:
+  /**
+   * Reads the next batch of outer tuples and looks up their keys.
+   * @return `false` if the child has no more tuples
+   */
+  bool ProbeBatch();
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The child executor producing the outer tuples */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Whether the child has no more tuples */
+  bool child_done_{false};
+  /** The inner table and its index */
+  const TableInfo *inner_table_info_{nullptr};
+  const IndexInfo *index_info_{nullptr};
+
+  /** The outer tuples of the batch whose key is not null, and the distinct key each of them has */
+  std::vector<Tuple> outer_tuples_;
+  std::vector<uint32_t> outer_keys_;
+  /** The RIDs each distinct key of the batch matches, and the inner tuples at those RIDs */
+  std::vector<std::vector<RID>> matches_;
+  std::unordered_map<RID, Tuple> inner_tuples_;
+  /** The outer tuple being joined and its next match */
+  size_t outer_idx_{0};
+  size_t match_idx_{0};
+
+  /** The output of Next(), read a batch at a time */
+  TupleBatch out_batch_;
+  uint32_t out_idx_{0};
 };
 }  // namespace bustub
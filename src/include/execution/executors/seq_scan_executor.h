@@ -12,17 +12,26 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "execution/compiled_scan.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/morsel_scheduler.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * When tuples can be read in place, the predicate and the projection are pushed down to the table pages
+ * (see CompiledScan and TableHeap::ScanPage()), so only the tuples that qualify are materialized. That is
+ * the case without logging, as no locks are taken on the tuples, and without optimistic concurrency
+ * control, as no reads are recorded. Otherwise every tuple is copied out of its page and then filtered.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -33,6 +42,14 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
 
+  /**
+   * Construct a new SeqScanExecutor instance that reads the morsels a worker of a pipeline takes.
+   * @param exec_ctx The executor context
+   * @param plan The sequential scan plan to be executed
+   * @param pipeline The worker, whose morsel_ is set to the morsel being read
+   */
+  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, PipelineWorker *pipeline);
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -44,11 +61,56 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan, evaluated straight into the columns of the batch.
+   * When reading morsels, a batch never spans two morsels.
+   * @param[out] batch The batch of tuples produced by the scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the sequential scan */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
+  /**
+   * Move to the next tuple that satisfies the predicate.
+   * @param[out] values The output columns of the tuple, appended to the (empty) vector
+   * @param[out] rid The RID of the tuple
+   * @return `false` if there are no more tuples
+   */
+  bool NextRow(std::vector<Value> *values, RID *rid);
+
+  /**
+   * Move to the next morsel of the worker, collecting the RIDs of its tuples unless the scan is pushed down.
+   * @return `false` if there are no more morsels
+   */
+  bool NextMorsel();
+
+  /** Fill a batch by scanning the pages with the pushed down filter. */
+  void NextCompiledBatch(TupleBatch *batch);
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** Metadata identifying the table that is scanned */
+  const TableInfo *table_info_;
+  /** The iterator over the table heap, created in Init() */
+  std::unique_ptr<TableIterator> table_iter_;
+  /** The worker of the pipeline the scan reads morsels for, `nullptr` if it reads the whole table */
+  PipelineWorker *pipeline_{nullptr};
+  /** The RIDs of the tuples of the morsel being read, and the next one to read */
+  std::vector<RID> morsel_rids_;
+  size_t rid_idx_{0};
+  /** The filter pushed down to the pages, created in Init(), `nullptr` if the tuples are copied out */
+  std::unique_ptr<CompiledScan> compiled_;
+  /** The page the pushed down scan reads, and the next slot to read */
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint32_t slot_num_{0};
+  /** The pages of the morsel being read by the pushed down scan, and the next one to read */
+  std::vector<page_id_t> morsel_pages_;
+  size_t page_idx_{0};
+  /** The batch Next() returns the tuples of when the scan is pushed down, and the next one to return */
+  TupleBatch out_batch_;
+  uint32_t out_idx_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortExecutor executes an ORDER BY.
+ *
+ * Every row is given a normalized key (see KeyNormalizer), the bytes of its ORDER BY values, flipped for
+ * descending terms, so that rows compare with a memcmp of their keys. The rows are sorted through an array
+ * of entries holding the first 8 bytes of the key and the position of the row: most comparisons are
+ * decided by the prefixes, without touching the rows.
+ *
+ * Rows beyond the memory budget of the executor context are sorted into runs, which are written to
+ * temporary pages of the buffer pool, together with their RIDs, and the runs are merged with a loser tree
+ * as the output is read.
+ *
+ * With a limit (a LIMIT directly above the ORDER BY), only the first rows are kept, in a heap, so the
+ * child's rows are never all sorted or held in memory.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new SortExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The sort plan to be executed
+   * @param child_executor The child executor from which tuples are pulled
+   * @param limit The number of rows that are read from the sort, std::nullopt if all of them are
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor,
+               std::optional<size_t> limit = std::nullopt);
+
+  /** Deletes the temporary pages of a sort that did not run to the end */
+  ~SortExecutor() override;
+
+  /** Initialize the sort, which reads and sorts all the tuples of the child */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the sort.
+   * @param[out] tuple The next tuple produced by the sort
+   * @param[out] rid The next tuple RID produced by the sort
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  /**
+   * Yield the next batch of tuples from the sort.
+   * @param[out] batch The batch of tuples produced by the sort
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return The output schema for the sort */
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  /** @return The number of runs written to temporary pages */
+  size_t GetNumRuns() const { return runs_.size(); }
+
+ private:
+  /** A row being sorted */
+  struct SortRow {
+    /** The normalized key */
+    std::string key_;
+    /** The tuple */
+    Tuple tuple_;
+    /** The RID of the tuple */
+    RID rid_;
+    /** The position of the row in the child's output, which breaks ties */
+    size_t seq_;
+  };
+
+  /** An entry of the sort array */
+  struct SortEntry {
+    /** The first 8 bytes of the key, big-endian and padded with zeros */
+    uint64_t prefix_;
+    /** The position of the row */
+    uint32_t row_;
+  };
+
+  /** A sorted run on temporary pages, merged with the other runs */
+  struct Run {
+    /** The pages of the run, in order, that are still to be read */
+    std::vector<page_id_t> pages_;
+    size_t page_idx_{0};
+    /** The tuples of the page being read and their RIDs, in order, and the next one */
+    std::vector<Tuple> tuples_;
+    std::vector<RID> rids_;
+    size_t tuple_idx_{0};
+    /** The key of the next tuple */
+    std::string key_;
+  };
+
+  /** @return The normalized key of the ORDER BY values of a row, one per term */
+  std::string MakeKey(const std::vector<Value> &values) const;
+
+  /** @return The normalized key of a tuple of the child */
+  std::string TupleKey(const Tuple &tuple) const;
+
+  /** @return `true` if row a sorts before row b, rows that are equal keeping their order */
+  bool RowLess(const SortEntry &a, const SortEntry &b) const;
+
+  /** Adds a row to the rows being sorted, or to the top rows with a limit. */
+  void AddRow(std::string &&key, Tuple &&tuple, RID rid);
+
+  /** Sorts the rows into the sort array. */
+  void SortRows();
+
+  /** Writes the sorted rows to temporary pages as a new run. */
+  void SpillRun();
+
+  /**
+   * Moves a run to its next tuple, reading its next page if needed.
+   * @return `false` if the run is exhausted
+   */
+  bool AdvanceRun(Run *run);
+
+  /** @return `true` if the run a beats the run b in the loser tree, i.e. its next tuple comes first */
+  bool RunBeats(size_t a, size_t b) const;
+
+  /** Replays the matches of a run in the loser tree, from its leaf up to the root. */
+  void AdjustLoserTree(size_t run);
+
+  /** Deletes the pages of all runs. */
+  void DropRuns();
+
+  /**
+   * Yield the next row of the sort.
+   * @return `false` if there are no more rows
+   */
+  bool NextRow(Tuple *tuple, RID *rid);
+
+  /** The sort plan node to be executed */
+  const SortPlanNode *plan_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The number of rows that are read from the sort */
+  std::optional<size_t> limit_;
+  /** Whether only the first limit_ rows are kept, in a heap */
+  bool top_n_{false};
+  /** The number of rows read from the child */
+  size_t seq_{0};
+
+  /** The rows in memory, the sort array over them and the next entry to output */
+  std::vector<SortRow> rows_;
+  std::vector<SortEntry> entries_;
+  size_t entry_idx_{0};
+  /** The bytes taken by the rows in memory */
+  size_t row_bytes_{0};
+
+  /** The runs on temporary pages */
+  std::vector<Run> runs_;
+  /** The runs that still have tuples, in the loser tree */
+  std::vector<bool> run_valid_;
+  /** The loser tree over the runs: loser_tree_[0] is the winner, the other nodes the losers of their matches */
+  std::vector<size_t> loser_tree_;
+  /** The page a run is being written to */
+  TmpTuplePage *spill_page_{nullptr};
+};
+
+}  // namespace bustub
@@ -72,5 +72,7 @@ class UpdateExecutor : public AbstractExecutor {
   const TableInfo *table_info_;
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The indexes of the table that must be maintained */
+  std::vector<IndexInfo *> indexes_;
 };
 }  // namespace bustub
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -39,6 +40,21 @@ class AbstractExpression {
   /** @return The value obtained by evaluating the tuple with the given schema */
   virtual Value Evaluate(const Tuple *tuple, const Schema *schema) const = 0;
 
+  /**
+   * Evaluates the expression over the selected rows of a batch.
+   * The default implementation evaluates the rows one at a time; expressions override it to work column by column.
+   * @param batch The rows
+   * @param[out] result The value for each selected row, in selection order
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+    result->clear();
+    result->reserve(batch.GetSize());
+    for (auto row : batch.GetSelection()) {
+      Tuple tuple = batch.GetTuple(row);
+      result->emplace_back(Evaluate(&tuple, batch.GetSchema()));
+    }
+  }
+
   /**
    * Returns the value obtained by evaluating a JOIN.
    * @param left_tuple The left tuple
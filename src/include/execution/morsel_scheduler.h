@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_scheduler.h
+//
+// Identification: src/include/execution/morsel_scheduler.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/executor_context.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/** The number of table pages in a morsel */
+static constexpr size_t MORSEL_PAGES = 8;
+
+/** A morsel is a run of consecutive pages of a table, the unit of work of a parallel scan. */
+struct Morsel {
+  /** The position of the morsel in the table */
+  size_t index_;
+  /** The pages of the morsel, in table order */
+  std::vector<page_id_t> pages_;
+};
+
+/**
+ * MorselQueue splits the pages of a table into morsels and hands them out to the workers of a pipeline.
+ *
+ * Every worker starts with a contiguous range of the morsels, which it takes from the front. A worker
+ * that runs out steals from the back of the range of another worker, so workers that got slow morsels
+ * (e.g. pages that were not in the buffer pool) are helped by the others.
+ */
+class MorselQueue {
+ public:
+  /**
+   * Creates the morsels of a table.
+   * @param table the table to split up
+   * @param bpm the buffer pool manager the pages of the table are read through
+   * @param num_workers the number of workers taking morsels
+   * @param morsel_pages the number of pages in a morsel
+   * @throws OUT_OF_MEMORY if the buffer pool has no free frame to read a page of the table
+   */
+  MorselQueue(TableHeap *table, BufferPoolManager *bpm, size_t num_workers, size_t morsel_pages = MORSEL_PAGES);
+
+  DISALLOW_COPY_AND_MOVE(MorselQueue);
+
+  /**
+   * Takes the next morsel for a worker, stealing it from another worker if the worker has none left.
+   * @param worker the worker
+   * @param[out] morsel the morsel
+   * @return `false` if all morsels have been taken
+   */
+  bool Next(size_t worker, Morsel *morsel);
+
+  /** @return The number of morsels of the table */
+  size_t GetNumMorsels() const { return (pages_.size() + morsel_pages_ - 1) / morsel_pages_; }
+
+ private:
+  /** The morsels a worker has not taken yet, latched as other workers may steal them */
+  struct WorkerQueue {
+    std::mutex latch_;
+    std::deque<size_t> morsels_;
+  };
+
+  /** The pages of the table, in table order */
+  std::vector<page_id_t> pages_;
+  /** The number of pages in a morsel */
+  size_t morsel_pages_;
+  /** The morsels of each worker */
+  std::vector<WorkerQueue> queues_;
+};
+
+/** The state of one worker running a pipeline: the scan at the source of the pipeline reads the worker's morsels. */
+struct PipelineWorker {
+  /** The scan at the source of the pipeline */
+  const SeqScanPlanNode *source_;
+  /** The morsels of the table of the scan */
+  MorselQueue *morsels_;
+  /** The worker */
+  size_t worker_;
+  /** The morsel the scan is reading, which the batches coming out of the pipeline belong to */
+  size_t morsel_{0};
+};
+
+/**
+ * MorselScheduler runs pipelines of a plan on the threads of the executor context.
+ *
+ * A pipeline is a fragment of the plan tree that streams the tuples of one table scan without
+ * materializing them, up to the pipeline breaker that consumes it: the root of the query, a hash join
+ * build or an aggregation. Each worker creates its own executors for the fragment, and the scan at its
+ * source reads the morsels of the table that the worker takes, so the workers share nothing but the
+ * morsel queue and the sink.
+ *
+ * Only a sequential scan, with its predicate and its projection, is a pipeline so far: the other
+ * streaming operators keep state across their input (LIMIT, DISTINCT), or would need a build side shared
+ * between the workers (the probe side of a hash join).
+ */
+class MorselScheduler {
+ public:
+  /**
+   * The sink of a pipeline, called on the worker threads.
+   * The arguments are the worker, the morsel the batch comes from and the batch; a batch never spans morsels.
+   * Returning `false` stops the worker.
+   */
+  using Sink = std::function<bool(size_t, size_t, const TupleBatch &)>;
+
+  /** @return `true` if the executor context allows running pipelines on several threads */
+  static bool CanRunParallel(ExecutorContext *exec_ctx);
+
+  /** @return The scan the pipeline rooted at plan reads morsels of, `nullptr` if plan is not a pipeline */
+  static const SeqScanPlanNode *GetPipelineSource(const AbstractPlanNode *plan);
+
+  /**
+   * Runs a task on several threads, the calling thread being one of them.
+   * @param num_workers the number of threads
+   * @param task the task, called with the worker number
+   * @throws the first exception a task threw, once all tasks have finished
+   */
+  static void RunWorkers(size_t num_workers, const std::function<void(size_t)> &task);
+
+  /**
+   * Runs the pipeline rooted at plan on the threads of the executor context.
+   * @param exec_ctx the executor context
+   * @param plan the root of the pipeline, GetPipelineSource(plan) must not be `nullptr`
+   * @param sink the consumer of the batches of the pipeline
+   * @throws the first exception a worker threw, e.g. OUT_OF_MEMORY if the buffer pool has no free frame
+   */
+  static void RunPipeline(ExecutorContext *exec_ctx, const AbstractPlanNode *plan, const Sink &sink);
+};
+
+}  // namespace bustub
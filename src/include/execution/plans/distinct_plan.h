@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <vector>
+
+#include "common/util/hash_util.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
@@ -38,4 +41,46 @@ class DistinctPlanNode : public AbstractPlanNode {
   }
 };
 
+/** DistinctKey represents a row in a DISTINCT operation */
+struct DistinctKey {
+  /** The values of the row */
+  std::vector<Value> values_;
+
+  /**
+   * Compares two rows for equality; unlike in comparisons, null values are equal to each other here.
+   * @param other the other row to be compared with
+   * @return `true` if both rows have equivalent values, `false` otherwise
+   */
+  bool operator==(const DistinctKey &other) const {
+    for (uint32_t i = 0; i < other.values_.size(); i++) {
+      if (values_[i].IsNull() || other.values_[i].IsNull()) {
+        if (values_[i].IsNull() != other.values_[i].IsNull()) {
+          return false;
+        }
+      } else if (values_[i].CompareEquals(other.values_[i]) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
 }  // namespace bustub
+
+namespace std {
+
+/** Implements std::hash on DistinctKey */
+template <>
+struct hash<bustub::DistinctKey> {
+  std::size_t operator()(const bustub::DistinctKey &distinct_key) const {
+    size_t curr_hash = 0;
+    for (const auto &value : distinct_key.values_) {
+      if (!value.IsNull()) {
+        curr_hash = bustub::HashUtil::CombineHashes(curr_hash, bustub::HashUtil::HashValue(&value));
+      }
+    }
+    return curr_hash;
+  }
+};
+
+}  // namespace std
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** The default number of rows in a TupleBatch */
+static constexpr uint32_t TUPLE_BATCH_SIZE = 1024;
+
+/**
+ * TupleBatch holds up to a fixed number of rows of one schema, stored column by
+ * column, for batch-at-a-time execution (see AbstractExecutor::NextBatch()).
+ *
+ * The rows that are part of the batch are given by the selection vector, a list
+ * of row positions in increasing order. Operators that filter rows, such as
+ * DISTINCT or LIMIT, only shrink the selection vector and never move values.
+ */
+class TupleBatch {
+ public:
+  /**
+   * Construct a new, empty TupleBatch.
+   * @param capacity The maximum number of rows in the batch
+   */
+  explicit TupleBatch(uint32_t capacity = TUPLE_BATCH_SIZE) : capacity_{capacity} {}
+
+  /**
+   * Remove all rows and set the schema of the rows to come.
+   * @param schema The schema of the rows, may be nullptr for executors that produce no tuples
+   */
+  void Reset(const Schema *schema);
+
+  /** @return The schema of the rows */
+  const Schema *GetSchema() const { return schema_; }
+
+  /** @return The maximum number of rows in the batch */
+  uint32_t GetCapacity() const { return capacity_; }
+
+  /** @return The number of rows stored in the batch, selected or not */
+  uint32_t GetRowCount() const { return static_cast<uint32_t>(rids_.size()); }
+
+  /** @return `true` if no more rows can be appended */
+  bool IsFull() const { return GetRowCount() >= capacity_; }
+
+  /** @return The number of selected rows */
+  uint32_t GetSize() const { return static_cast<uint32_t>(selection_.size()); }
+
+  /** @return The positions of the selected rows, in increasing order */
+  const std::vector<uint32_t> &GetSelection() const { return selection_; }
+
+  /**
+   * Replace the selection vector.
+   * @param selection The positions of the selected rows, in increasing order
+   */
+  void SetSelection(std::vector<uint32_t> &&selection) { selection_ = std::move(selection); }
+
+  /**
+   * Append a selected row.
+   * @param values The values of the row, one per column; the vector is left empty
+   * @param rid The RID of the row
+   */
+  void AppendRow(std::vector<Value> *values, RID rid);
+
+  /**
+   * Append a selected row.
+   * @param tuple The row, laid out according to the schema of the batch
+   * @param rid The RID of the row
+   */
+  void AppendTuple(const Tuple &tuple, RID rid);
+
+  /** @return The value of a column in the row at the given position */
+  const Value &GetValue(uint32_t row, uint32_t column_idx) const { return columns_[column_idx][row]; }
+
+  /** @return The values of a column, indexed by row position */
+  const std::vector<Value> &GetColumn(uint32_t column_idx) const { return columns_[column_idx]; }
+
+  /** @return The RID of the row at the given position */
+  RID GetRid(uint32_t row) const { return rids_[row]; }
+
+  /** @return The values of the row at the given position, as a tuple; its RID is given by GetRid() */
+  Tuple GetTuple(uint32_t row) const;
+
+ private:
+  /** The schema of the rows */
+  const Schema *schema_{nullptr};
+  /** The maximum number of rows */
+  uint32_t capacity_;
+  /** The values of each column */
+  std::vector<std::vector<Value>> columns_;
+  /** The RID of each row */
+  std::vector<RID> rids_;
+  /** The positions of the selected rows */
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace bustub
@@ -10,10 +10,12 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -28,17 +30,28 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key, an index with duplicate keys uses
+ * RidSuffixedKey to make them unique (key, RID) pairs
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrent operations use latch crabbing. Readers read-latch their way down
+ * to the leaf. Writers first descend optimistically the same way and only
+ * write-latch the leaf; if the leaf would split or underflow they restart and
+ * write-latch the whole path, releasing the ancestors (kept in the
+ * transaction's page set) as soon as a child is safe.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  friend INDEXITERATOR_TYPE;
 
  public:
+  /** The default fill factor of BulkLoad, leaving room in every node for the inserts that follow the load */
+  static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;
+
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
                      int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
 
@@ -51,13 +64,53 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  /**
+   * Builds the tree bottom-up from a batch of key & value pairs, e.g. when creating an index over an existing table.
+   * The pairs are sorted first, then packed into consecutive leaves filled to fill_factor of their capacity, and
+   * every internal level is built on top of the one below without any splits. A tree that is not empty falls back
+   * to inserting the pairs one by one.
+   * @param items the pairs to load, need not be sorted
+   * @param fill_factor fraction of a page to fill, clamped so that every node stays between min and max size
+   * @return false if some of the keys were duplicates and have not been loaded
+   */
+  bool BulkLoad(std::vector<MappingType> items, double fill_factor = BULK_LOAD_FILL_FACTOR,
+                Transaction *transaction = nullptr);
+
+  /**
+   * Adds a batch of key & value pairs for the next FinishBulkLoad(), so that more pairs than fit into memory can be
+   * bulk loaded: every batch but the last is sorted and written out to new pages as a sorted run. Not thread-safe,
+   * meant for building an index.
+   * @param items the pairs to add, need not be sorted
+   */
+  void AddBulkLoadRun(std::vector<MappingType> items);
+
+  /**
+   * Merges the runs added by AddBulkLoadRun() into one sorted stream and loads it like BulkLoad(), then deletes the
+   * pages of the runs. The merge keeps one page of every run pinned.
+   * @param fill_factor fraction of a page to fill, see BulkLoad()
+   * @return false if some of the keys were duplicates and have not been loaded
+   */
+  bool FinishBulkLoad(double fill_factor = BULK_LOAD_FILL_FACTOR, Transaction *transaction = nullptr);
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Looks up a batch of keys. A key that falls within the keys of the leaf of the key before it is looked up in
+   * that leaf without descending from the root again, so keys in ascending order share their leaves.
+   * @param keys the keys, best sorted
+   * @param[out] results results[i] receives the value of keys[i], if it exists
+   * @return the number of descents from the root
+   */
+  size_t GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                   Transaction *transaction = nullptr);
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE End();
+  // iterator at the last key, for scanning backwards with operator--
+  INDEXITERATOR_TYPE RBegin();
 
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
@@ -76,10 +129,65 @@ class BPlusTree {
 
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
-  // expose for test purpose
+  // expose for test purpose, the leaf page is returned pinned and read latched
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  /** The ways FindLeafPage can latch its way down to a leaf. */
+  enum class LatchMode { READ, OPTIMISTIC, INSERT, REMOVE };
+
+  /**
+   * Descends from the root to the leaf containing key.
+   * READ read-latches every page, OPTIMISTIC does the same but write-latches the leaf.
+   * INSERT and REMOVE write-latch the path and keep the unsafe part of it, including
+   * the root latch (recorded as nullptr), in the transaction's page set.
+   * @return the pinned and latched leaf page, nullptr if the tree is empty
+   */
+  Page *FindLeafPage(const KeyType &key, bool left_most, LatchMode mode, Transaction *transaction = nullptr);
+
+  /**
+   * Read-latches its way down to the leaf whose key range holds the keys right before bound, the right-most leaf
+   * if bound is nullptr. The leaf may have no key smaller than bound after deletions: all those keys are then
+   * smaller than the fence, the greatest separator on the path that is smaller than bound.
+   * @param[out] fence set to the fence if there is one, has_fence tells whether there is
+   * @return the pinned and read latched leaf page, nullptr if the tree is empty
+   */
+  Page *FindLeafPageBefore(const KeyType *bound, KeyType *fence, bool *has_fence);
+
+  /** @return true if the operation cannot split or underflow the node */
+  bool IsSafe(BPlusTreePage *node, LatchMode mode);
+
+  /** Releases the latches and pins of the pages in the transaction's page set. */
+  void ReleaseWLatches(Transaction *transaction);
+
+  /** Releases the page set, then deletes the pages in the transaction's deleted page set. */
+  void FinishWrite(Transaction *transaction);
+
+  /**
+   * Splits count entries into nodes of fill entries each, except that a too small last node is merged into
+   * (or evened out with) the one before it.
+   * @return the size of each node, from left to right
+   */
+  static std::vector<int> BulkLoadNodeSizes(int count, int fill, int min_size, int max_size);
+
+  /**
+   * Builds the tree bottom-up from the pairs next() returns in key order, keeping the first of equal keys, or inserts
+   * them one by one if the tree is not empty. Holds at most two leaves of pairs in memory.
+   * @param next sets its argument to the next pair, returns false when there are no more
+   * @return false if some of the keys were duplicates and have not been loaded
+   */
+  bool BulkLoadSorted(const std::function<bool(MappingType *)> &next, double fill_factor, Transaction *transaction);
+
+  /** Sorts pending_run_ and writes it out to new pages as a run of bulk_load_runs_. */
+  void SpillBulkLoadRun();
+
+  /** A sorted run of pairs written out by SpillBulkLoadRun(), RUN_PAGE_SIZE pairs to a page. */
+  struct BulkLoadRun {
+    std::vector<page_id_t> page_ids_;
+    size_t size_;
+  };
+  static constexpr size_t RUN_PAGE_SIZE = PAGE_SIZE / sizeof(MappingType);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
@@ -112,10 +220,15 @@ class BPlusTree {
   // member variable
   std::string index_name_;
   page_id_t root_page_id_;
+  // 保护root_page_id_，根节点变化时需要写锁
+  ReaderWriterLatch root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // AddBulkLoadRun()加入的批次，最后一批留在内存里，只有一批时不用写出去
+  std::vector<BulkLoadRun> bulk_load_runs_;
+  std::vector<MappingType> pending_run_;
 };
 
 }  // namespace bustub
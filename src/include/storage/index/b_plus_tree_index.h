@@ -30,10 +30,25 @@ class BPlusTreeIndex : public Index {
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  /** Adds the batch as a sorted run, see BPlusTree::AddBulkLoadRun(). */
+  void BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
+  /** Bulk loads all the batches as one sorted stream, see BPlusTree::FinishBulkLoad(). */
+  void FinishBulkInsert(Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Looks the keys up leaf by leaf when they are sorted, see BPlusTree::GetValues(). */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  std::unique_ptr<IndexCursor> Scan(Transaction *transaction) override;
+
+  /** Entries can be returned if the keys store the raw entry tuple, i.e. for GenericKeys but not NormalizedKeys. */
+  bool CanReturnEntries() const override;
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
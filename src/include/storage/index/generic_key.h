@@ -13,8 +13,11 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
+#include "common/exception.h"
 #include "storage/table/tuple.h"
+#include "type/type_util.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -35,6 +38,9 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // the raw tuple layout is the same whatever the key schema is
+  inline void SetFromKey(const Tuple &tuple, const Schema & /*key_schema*/) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -72,35 +78,104 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * The key schema is turned into a list of (offset, type) pairs once, when the
+ * comparator is created, so a comparison reads the raw column bytes and
+ * compares them as their C++ type instead of deserializing Values and going
+ * through the virtual Type interface. Unlike Value comparisons, nulls are
+ * ordered (before every other value), so the order is total.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
+    for (const auto &column : columns_) {
+      int cmp = CompareColumn(column, lhs.data_, rhs.data_);
+      if (cmp != 0) {
+        return cmp;
       }
     }
     // equals
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other) = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    for (const auto &col : key_schema->GetColumns()) {
+      columns_.push_back({col.GetOffset(), col.GetType()});
+    }
+  }
 
  private:
+  struct KeyColumn {
+    uint32_t offset_;
+    TypeId type_;
+  };
+
+  template <typename T>
+  static inline int CompareAs(const char *lhs, const char *rhs) {
+    T lhs_value;
+    T rhs_value;
+    memcpy(&lhs_value, lhs, sizeof(T));
+    memcpy(&rhs_value, rhs, sizeof(T));
+    return static_cast<int>(rhs_value < lhs_value) - static_cast<int>(lhs_value < rhs_value);
+  }
+
+  static inline int CompareVarchar(const char *lhs_data, const char *rhs_data, uint32_t offset) {
+    // the column holds the offset of the string, which is stored as its length (counting a trailing '\0') and bytes
+    int32_t lhs_offset;
+    int32_t rhs_offset;
+    memcpy(&lhs_offset, lhs_data + offset, sizeof(int32_t));
+    memcpy(&rhs_offset, rhs_data + offset, sizeof(int32_t));
+    uint32_t lhs_length;
+    uint32_t rhs_length;
+    memcpy(&lhs_length, lhs_data + lhs_offset, sizeof(uint32_t));
+    memcpy(&rhs_length, rhs_data + rhs_offset, sizeof(uint32_t));
+    if (lhs_length == BUSTUB_VALUE_NULL || rhs_length == BUSTUB_VALUE_NULL) {
+      return static_cast<int>(lhs_length != BUSTUB_VALUE_NULL) - static_cast<int>(rhs_length != BUSTUB_VALUE_NULL);
+    }
+    return TypeUtil::CompareStrings(lhs_data + lhs_offset + sizeof(uint32_t), lhs_length - 1,
+                                    rhs_data + rhs_offset + sizeof(uint32_t), rhs_length - 1);
+  }
+
+  static inline int CompareColumn(const KeyColumn &column, const char *lhs_data, const char *rhs_data) {
+    const char *lhs = lhs_data + column.offset_;
+    const char *rhs = rhs_data + column.offset_;
+    // the null values of the numeric types are their smallest values, except for timestamps
+    switch (column.type_) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return CompareAs<int8_t>(lhs, rhs);
+      case TypeId::SMALLINT:
+        return CompareAs<int16_t>(lhs, rhs);
+      case TypeId::INTEGER:
+        return CompareAs<int32_t>(lhs, rhs);
+      case TypeId::BIGINT:
+        return CompareAs<int64_t>(lhs, rhs);
+      case TypeId::DECIMAL:
+        return CompareAs<double>(lhs, rhs);
+      case TypeId::TIMESTAMP: {
+        uint64_t lhs_value;
+        uint64_t rhs_value;
+        memcpy(&lhs_value, lhs, sizeof(uint64_t));
+        memcpy(&rhs_value, rhs, sizeof(uint64_t));
+        // adding one wraps the null timestamp (the largest value) around to the front
+        lhs_value++;
+        rhs_value++;
+        return static_cast<int>(rhs_value < lhs_value) - static_cast<int>(lhs_value < rhs_value);
+      }
+      case TypeId::VARCHAR:
+        return CompareVarchar(lhs_data, rhs_data, column.offset_);
+      default:
+        throw Exception(ExceptionType::MISMATCH_TYPE, "cannot compare a key column of this type");
+    }
+  }
+
   Schema *key_schema_;
+  // (offset, type) of every key column, in key order
+  std::vector<KeyColumn> columns_;
 };
 
 }  // namespace bustub
@@ -43,14 +43,21 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param include_attrs The base table columns stored in the entries next to the key (INCLUDE columns)
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
+                std::vector<uint32_t> key_attrs, const std::vector<uint32_t> &include_attrs = {})
       : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs.begin(), include_attrs.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs_);
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  }
 
   /** @return The name of the index */
   inline const std::string &GetName() const { return name_; }
@@ -72,6 +79,15 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  /**
+   * @return A schema object pointer that represents an index entry: the key columns followed by the INCLUDE columns.
+   * The key columns are laid out as in the key schema, so an entry tuple can be used wherever a key is expected.
+   */
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
+  /** @return The mapping relation between entry columns and base table columns */
+  inline const std::vector<uint32_t> &GetEntryAttrs() const { return entry_attrs_; }
+
   /** @return A string representation for debugging */
   std::string ToString() const {
     std::stringstream os;
@@ -94,6 +110,27 @@ class IndexMetadata {
   const std::vector<uint32_t> key_attrs_;
   /** The schema of the indexed key */
   Schema *key_schema_;
+  /** The key attributes followed by the INCLUDE attributes */
+  std::vector<uint32_t> entry_attrs_;
+  /** The schema of an index entry */
+  Schema *entry_schema_;
+};
+
+/**
+ * IndexCursor walks over the entries of an ordered index in key order.
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /**
+   * Move to the next entry.
+   * @param[out] rid The RID of the entry
+   * @param[out] entry If not null, the entry itself, laid out as IndexMetadata::GetEntrySchema();
+   * only supported if Index::CanReturnEntries()
+   * @return `false` if there are no more entries
+   */
+  virtual bool Next(RID *rid, Tuple *entry) = 0;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +176,12 @@ class Index {
   /** @return The index key attributes */
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  /** @return The schema of the index entries, i.e. the key and the INCLUDE columns */
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
+  /** @return The index entry attributes; InsertEntry() and DeleteEntry() take tuples of these columns */
+  const std::vector<uint32_t> &GetEntryAttrs() const { return metadata_->GetEntryAttrs(); }
+
   /** @return A string representation for debugging */
   std::string ToString() const {
     std::stringstream os;
@@ -153,15 +196,35 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index entry, i.e. the key and the INCLUDE columns
    * @param rid The RID associated with the key (unused)
    * @param transaction The transaction context
    */
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  /**
+   * Insert a batch of entries into the index, e.g. when building an index on an existing table.
+   * Indexes that can load a batch faster than one entry at a time override this. The entries may only be
+   * visible after FinishBulkInsert().
+   * @param entries The index keys and their associated RIDs
+   * @param transaction The transaction context
+   */
+  virtual void BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &[key, rid] : entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
+  /**
+   * Called after the last BulkInsertEntries() of a load. Indexes that hold the batches back, e.g. to load all of
+   * them as one sorted stream, insert them here.
+   * @param transaction The transaction context
+   */
+  virtual void FinishBulkInsert(Transaction *transaction) {}
+
   /**
    * Delete an index entry by key.
-   * @param key The index key
+   * @param key The index entry; the INCLUDE columns are ignored
    * @param rid The RID associated with the key (unused)
    * @param transaction The transaction context
    */
@@ -175,6 +238,35 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for a batch of keys.
+   * Indexes that can share work between the keys override this, ordered indexes doing best on sorted keys.
+   * @param keys The index keys
+   * @param results results[i] is populated with the RIDs of keys[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Ordered Scan
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Scan all entries of the index in key order.
+   * @param transaction The transaction context
+   * @return A cursor positioned before the first entry, or nullptr if the index is not ordered
+   */
+  virtual std::unique_ptr<IndexCursor> Scan(Transaction * /*transaction*/) { return nullptr; }
+
+  /** @return `true` if the cursors of this index can return the stored entries, so a scan need not read the table */
+  virtual bool CanReturnEntries() const { return false; }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -13,31 +13,87 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Range scan iterator over a BPlusTree.
+ *
+ * The iterator copies the rest of a leaf into a local batch under the leaf's
+ * read latch and releases the latch right away, so writers are never blocked
+ * by a scan in progress. While the batch is consumed it keeps a pin on the leaf
+ * the batch came from. When the batch runs out the source leaf is latched
+ * again, so entries that a split, merge or redistribution moved past the end
+ * of the batch are not skipped, and the scan continues with the entries
+ * greater than the last one returned.
+ *
+ * Leaves only link to their right sibling. Moving backwards descends from the
+ * root to the leaf holding the entries smaller than the first one of the
+ * batch.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates an end iterator. */
   IndexIterator();
+  /**
+   * Creates an iterator positioned at the given slot of a leaf page.
+   * The iterator takes over the pin and the read latch that the caller holds on the page.
+   */
+  IndexIterator(Tree *tree, Page *page, int index);
+  /** Creates an iterator positioned at the last entry of the tree, for reverse scans. */
+  explicit IndexIterator(Tree *tree);
   ~IndexIterator();
 
+  // 迭代器持有叶子页的pin，只能移动不能拷贝
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
   bool IsEnd();
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  /** Moves to the previous entry. Moving before the first entry of the tree makes this the end iterator. */
+  IndexIterator &operator--();
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const;
+
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /**
+   * Fills the batch with the entries of page from index on, moving on to the next leaves while there are none.
+   * If bound is not nullptr, only the entries greater than bound are taken from the following leaves.
+   * @param page pinned and read latched, the iterator takes both over
+   */
+  void FillForward(Page *page, int index, const KeyType *bound);
+  /** Fills the batch with the entries smaller than bound, all the entries of the last leaf if bound is nullptr. */
+  void FillBackward(const KeyType *bound);
+  /** Drops the batch and the pins. */
+  void Release();
+
+  Tree *tree_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  // 当前批次的来源叶子，只持有pin
+  Page *page_{nullptr};
+  std::vector<MappingType> batch_;
+  int index_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_normalizer.h
+//
+// Identification: src/include/storage/index/key_normalizer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * KeyNormalizer encodes index keys as byte strings whose memcmp order is the order of the keys.
+ *
+ * Every column is encoded as a null marker byte (nulls sort first) followed by
+ *  - integers and timestamps: big-endian, with the sign bit flipped for signed types;
+ *  - decimals: the IEEE 754 bits, all of them flipped for negative numbers and only the sign bit otherwise;
+ *  - varchars: the characters with 0x00 escaped as 0x00 0xFF, terminated by 0x00 0x00, so that a string sorts
+ *    before every string it is a prefix of and the next column only breaks ties.
+ */
+class KeyNormalizer {
+ public:
+  /**
+   * Appends the normalized encoding of a value to out.
+   * @param value the value to encode
+   * @param out the buffer to append to
+   */
+  static void AppendValue(const Value &value, std::string *out);
+
+  /**
+   * @param key the key tuple, laid out according to key_schema
+   * @param key_schema the schema of the key
+   * @return the normalized encoding of all the columns of the key
+   */
+  static std::string Normalize(const Tuple &key, const Schema &key_schema);
+
+  /**
+   * Appends the encoding of a RID, ordered by page id, then by slot number. Every encoding is 8 bytes long.
+   * @param rid the RID to encode
+   * @param out the buffer to append to
+   */
+  static void AppendRid(const RID &rid, std::string *out);
+};
+
+}  // namespace bustub
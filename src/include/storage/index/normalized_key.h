@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "storage/index/key_normalizer.h"
+
+namespace bustub {
+
+/**
+ * Fixed-size index key holding the normalized encoding of the key tuple (see
+ * KeyNormalizer), so that two keys compare with a single memcmp.
+ *
+ * Keys whose encoding is longer than KeySize are rejected, since a cut-off
+ * encoding would make distinct keys compare equal. The encoding spends one
+ * null marker byte per column, e.g. a BIGINT key needs a NormalizedKey<16>.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    std::string normalized = KeyNormalizer::Normalize(tuple, key_schema);
+    if (normalized.size() > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "the normalized key does not fit into the index key size");
+    }
+    memset(data_, 0, KeySize);
+    memcpy(data_, normalized.data(), normalized.size());
+  }
+
+  // NOTE: for test purpose only
+  // encode key as a single BIGINT column
+  inline void SetFromInteger(int64_t key) {
+    std::string normalized;
+    KeyNormalizer::AppendValue(Value(TypeId::BIGINT, key), &normalized);
+    memset(data_, 0, KeySize);
+    memcpy(data_, normalized.data(), std::min(normalized.size(), KeySize));
+  }
+
+  // NOTE: for test purpose only
+  // decode the BIGINT written by SetFromInteger
+  inline int64_t ToString() const {
+    uint64_t bits = 0;
+    for (size_t i = 1; i <= sizeof(int64_t) && i < KeySize; i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data_[i]);
+    }
+    return static_cast<int64_t>(bits ^ (uint64_t{1} << 63));
+  }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  // actual location of data, extends past the end.
+  char data_[KeySize];
+};
+
+/**
+ * Function object comparing NormalizedKeys byte by byte.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+
+  // the key schema is already folded into the encoding of the keys
+  explicit NormalizedComparator(Schema * /*key_schema*/) {}
+};
+
+}  // namespace bustub
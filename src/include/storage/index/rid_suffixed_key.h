@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rid_suffixed_key.h
+//
+// Identification: src/include/storage/index/rid_suffixed_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <ostream>
+#include <type_traits>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * Index key made of a key and the RID of its entry, so that a BPlusTree, which
+ * only holds unique keys, can hold the same key for many tuples. The entries
+ * of one key are adjacent and ordered by RID: a lookup finds the first of them
+ * and reads the rest in one walk over the leaves.
+ *
+ * A key set from a tuple has the default RID, which sorts before every valid
+ * RID. It is the lower bound of the key's entries.
+ */
+template <typename KeyType>
+class RidSuffixedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    key_.SetFromKey(tuple, key_schema);
+    rid_ = RID();
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) {
+    key_.SetFromInteger(key);
+    rid_ = RID();
+  }
+
+  // NOTE: for test purpose only
+  inline auto ToString() const { return key_.ToString(); }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const RidSuffixedKey &key) {
+    os << key.key_ << "@" << key.rid_;
+    return os;
+  }
+
+  KeyType key_;
+  RID rid_;
+};
+
+/**
+ * Function object ordering RidSuffixedKeys by key, then by RID.
+ */
+template <typename KeyType, typename KeyComparator>
+class RidSuffixedComparator {
+ public:
+  inline int operator()(const RidSuffixedKey<KeyType> &lhs, const RidSuffixedKey<KeyType> &rhs) const {
+    int cmp = CompareKeys(lhs, rhs);
+    if (cmp != 0) {
+      return cmp;
+    }
+    if (lhs.rid_.GetPageId() != rhs.rid_.GetPageId()) {
+      return lhs.rid_.GetPageId() < rhs.rid_.GetPageId() ? -1 : 1;
+    }
+    return (lhs.rid_.GetSlotNum() > rhs.rid_.GetSlotNum()) - (lhs.rid_.GetSlotNum() < rhs.rid_.GetSlotNum());
+  }
+
+  // compares the key parts only
+  inline int CompareKeys(const RidSuffixedKey<KeyType> &lhs, const RidSuffixedKey<KeyType> &rhs) const {
+    return comparator_(lhs.key_, rhs.key_);
+  }
+
+  explicit RidSuffixedComparator(Schema *key_schema) : comparator_(key_schema) {}
+
+ private:
+  KeyComparator comparator_;
+};
+
+template <typename KeyType>
+struct IsRidSuffixedKey : std::false_type {};
+
+template <typename KeyType>
+struct IsRidSuffixedKey<RidSuffixedKey<KeyType>> : std::true_type {};
+
+}  // namespace bustub
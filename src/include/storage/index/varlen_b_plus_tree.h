@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree.h
+//
+// Identification: src/include/storage/index/varlen_b_plus_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/**
+ * B+ tree over variable-length byte string keys, ordered by memcmp, with unique keys.
+ *
+ * Pages are BPlusTreeSlottedPages: each page stores the prefix shared by its keys
+ * once, and the separators pushed up when a leaf splits are cut down to the
+ * shortest string that still separates the two leaves, so long keys with common
+ * prefixes (e.g. normalized composite keys) still get a high fanout.
+ *
+ * Like BPlusTree, readers and writers read-latch their way down and writers only
+ * write-latch the leaf, restarting with write crabbing from the root when the
+ * leaf has to split or may underflow. Since keys vary in length, a page
+ * underflows by bytes rather than by entry count: it is then merged into its
+ * sibling if both fit into one page, and otherwise the entries of the two are
+ * split again evenly, with a new separator in the parent.
+ */
+class VarlenBPlusTree {
+  using LeafPage = BPlusTreeSlottedPage<RID>;
+  using InternalPage = BPlusTreeSlottedPage<page_id_t>;
+
+ public:
+  /**
+   * Range scan iterator. It holds the read latch and the pin of one leaf at a time.
+   */
+  class Iterator {
+   public:
+    /** Creates an end iterator. */
+    Iterator() = default;
+    /** Takes over the pin and read latch the caller holds on page. */
+    Iterator(BufferPoolManager *buffer_pool_manager, Page *page, int index);
+    ~Iterator();
+
+    Iterator(const Iterator &) = delete;
+    Iterator &operator=(const Iterator &) = delete;
+    Iterator(Iterator &&other) noexcept;
+    Iterator &operator=(Iterator &&other) noexcept;
+
+    bool IsEnd() const { return page_ == nullptr; }
+    std::string Key() const { return leaf_->KeyAt(index_); }
+    RID Value() const { return leaf_->ValueAt(index_); }
+
+    Iterator &operator++();
+
+    bool operator==(const Iterator &itr) const { return page_id_ == itr.page_id_ && index_ == itr.index_; }
+    bool operator!=(const Iterator &itr) const { return !(*this == itr); }
+
+   private:
+    void SkipExhaustedLeaves();
+    void Release();
+
+    BufferPoolManager *buffer_pool_manager_{nullptr};
+    Page *page_{nullptr};
+    LeafPage *leaf_{nullptr};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    int index_{0};
+  };
+
+  VarlenBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager);
+
+  // Returns true if no page has been allocated for this tree yet.
+  bool IsEmpty() const;
+
+  /**
+   * Inserts a key-value pair.
+   * @return false if the key already exists
+   * @throws Exception if the key is longer than SLOTTED_PAGE_MAX_KEY_SIZE
+   */
+  bool Insert(std::string_view key, const RID &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this B+ tree.
+  void Remove(std::string_view key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(std::string_view key, std::vector<RID> *result, Transaction *transaction = nullptr);
+
+  // index iterator
+  Iterator Begin();
+  Iterator Begin(std::string_view key);
+  Iterator End();
+
+ private:
+  enum class LatchMode { READ, OPTIMISTIC, INSERT, REMOVE };
+
+  /**
+   * Descends from the root to the leaf that may contain key, latching like BPlusTree::FindLeafPage.
+   * In INSERT mode a node is safe when it has room for key_size (or any separator, for internal nodes),
+   * in REMOVE mode when it cannot underflow by losing one entry.
+   * @return the pinned and latched leaf page, nullptr if the tree is empty
+   */
+  Page *FindLeafPage(std::string_view key, bool left_most, LatchMode mode, Transaction *transaction = nullptr);
+  bool IsSafe(BPlusTreePage *node, std::string_view key, LatchMode mode);
+  bool InsertIntoLeaf(std::string_view key, const RID &value, Transaction *transaction);
+  void InsertIntoParent(BPlusTreePage *old_node, const std::string &key, BPlusTreePage *new_node);
+
+  /** Merges an underfull node with a sibling or rebalances the two, then fixes its parent recursively. */
+  void CoalesceOrRedistribute(BPlusTreePage *node, Transaction *transaction);
+
+  /**
+   * Merges right into left if the entries of both fit into one page, and otherwise splits them again evenly
+   * and replaces their separator in the parent. The separator is kept if the new one does not fit.
+   * @return true if right was merged into left and has to be removed from the parent
+   */
+  template <typename N>
+  bool MergeOrRedistribute(N *left, N *right, InternalPage *parent, int right_index);
+
+  /**
+   * Collapses a root internal page with one child, or empties the tree when the root leaf is empty.
+   * @return true if the old root page has to be deleted
+   */
+  bool AdjustRoot(BPlusTreePage *old_root_node);
+  Page *NewPage(page_id_t *page_id);
+  void Adopt(page_id_t child_page_id, page_id_t parent_page_id);
+  void ReleaseWLatches(Transaction *transaction);
+  /** Releases the page set, then deletes the pages in the transaction's deleted page set. */
+  void FinishWrite(Transaction *transaction);
+  void UpdateRootPageId(int insert_record = 0);
+
+  /** @return the shortest key s with left < s <= right */
+  static std::string Separator(std::string_view left, std::string_view right);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  // protects root_page_id_
+  ReaderWriterLatch root_latch_;
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree_index.h
+//
+// Identification: src/include/storage/index/varlen_b_plus_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/varlen_b_plus_tree.h"
+
+namespace bustub {
+
+/**
+ * B+ tree index over keys of any length, e.g. VARCHAR or composite keys that do not fit
+ * into a GenericKey. Keys are stored in their normalized encoding (see KeyNormalizer), followed by the
+ * encoded RID of the entry, so that many tuples can share a key: the entries of one key are adjacent
+ * and ordered by RID, and an entry is deleted by its key and RID.
+ */
+class VarlenBPlusTreeIndex : public Index {
+ public:
+  VarlenBPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  VarlenBPlusTree::Iterator GetBeginIterator();
+
+  /** @return an iterator at the first entry whose key is not less than key */
+  VarlenBPlusTree::Iterator GetBeginIterator(const Tuple &key);
+
+  VarlenBPlusTree::Iterator GetEndIterator();
+
+ protected:
+  /** @return the key the entry (key, rid) is stored under in the container */
+  std::string EntryKey(const Tuple &key, RID rid) const;
+
+  // container
+  VarlenBPlusTree container_;
+};
+
+}  // namespace bustub
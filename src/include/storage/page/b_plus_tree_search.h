@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_search.h
+//
+// Identification: src/include/storage/page/b_plus_tree_search.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <type_traits>
+
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "storage/index/rid_suffixed_key.h"
+
+namespace bustub {
+
+/**
+ * Whether the pages of a tree using KeyComparator search their nodes with
+ * BranchlessSearch, decided at compile time. It is on for the comparators
+ * that are inlined and cost about the same for every key. Any other
+ * comparator keeps the plain binary search.
+ */
+template <typename KeyComparator>
+struct UseBranchlessSearch : std::false_type {};
+
+template <size_t KeySize>
+struct UseBranchlessSearch<GenericComparator<KeySize>> : std::true_type {};
+
+template <size_t KeySize>
+struct UseBranchlessSearch<NormalizedComparator<KeySize>> : std::true_type {};
+
+template <typename KeyType, typename KeyComparator>
+struct UseBranchlessSearch<RidSuffixedComparator<KeyType, KeyComparator>> : UseBranchlessSearch<KeyComparator> {};
+
+/**
+ * Binary search over the key & value pairs array[begin, end) where each step
+ * only picks the start of the next range from the comparison. That choice
+ * compiles to a conditional move, so there is no branch to mispredict. Both
+ * entries that the step after next may compare against are prefetched.
+ *
+ * The pages keep their array of key & value pairs instead of separate key
+ * arrays compared with SIMD, although the build does target the host CPU
+ * (-march=native), AVX2 included. A separate key array would be a new page
+ * format: the split, merge and redistribute helpers move the pairs as units
+ * and the iterator hands them out by reference. And only a key that is one
+ * plain integer could be compared with vector instructions, while GenericKey
+ * columns compare by type and NormalizedKeys are byte strings.
+ * @return the first index whose key is not less than key, or is greater than key if Upper
+ */
+template <bool Upper, typename Pair, typename KeyType, typename KeyComparator>
+inline int BranchlessSearch(const Pair *array, int begin, int end, const KeyType &key,
+                            const KeyComparator &comparator) {
+  if (begin >= end) {
+    return begin;
+  }
+  const Pair *base = array + begin;
+  int size = end - begin;
+  while (size > 1) {
+    int half = size / 2;
+    __builtin_prefetch(base + half / 2);
+    __builtin_prefetch(base + half + half / 2);
+    int cmp = comparator(base[half].first, key);
+    base = (Upper ? cmp <= 0 : cmp < 0) ? base + half : base;
+    size -= half;
+  }
+  int cmp = comparator(base->first, key);
+  return static_cast<int>(base - array) + static_cast<int>(Upper ? cmp <= 0 : cmp < 0);
+}
+
+}  // namespace bustub
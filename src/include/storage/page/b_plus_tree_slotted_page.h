@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_slotted_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_slotted_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_SLOTTED_PAGE_TYPE BPlusTreeSlottedPage<ValueType>
+#define SLOTTED_PAGE_HEADER_SIZE 32
+// keys up to this size always fit four to a page, so splitting a page always makes room for one more
+#define SLOTTED_PAGE_MAX_KEY_SIZE ((PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE) / 4 - 12)
+// a page whose slots, entries and prefix take fewer bytes than this is merged with or borrows from a sibling
+#define SLOTTED_PAGE_MIN_USED_SIZE ((PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE) / 4)
+
+/**
+ * B+ tree page with variable-length keys, used as leaf page (ValueType = RID)
+ * and as internal page (ValueType = page_id_t).
+ *
+ * Keys are byte strings compared with memcmp. The longest prefix shared by
+ * every key of the page is stored once at the end of the page, and each entry
+ * only keeps the rest of its key. The key of slot 0 of an internal page is
+ * never looked at, so it is stored empty and does not limit the prefix.
+ *
+ * Slots grow from the header towards the end of the page, entries grow from
+ * the prefix towards the header. A slot holds the offset (2) and the suffix
+ * size (2) of its entry, an entry is its value followed by its key suffix:
+ *  ------------------------------------------------------------------------
+ * | HEADER | SLOT(0) | ... | SLOT(n) | FREE | ENTRY(n) | ... | ENTRY(0) | PREFIX |
+ *  ------------------------------------------------------------------------
+ * Removing an entry leaves a hole behind, the page is compacted when an insert
+ * does not fit into the free space. A page underflows when its entries take
+ * fewer than SLOTTED_PAGE_MIN_USED_SIZE bytes, whatever their number.
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrefixSize (2) | DataBegin (2)
+ *  ----------------------------------------------------------------------------
+ * MaxSize is unused: a page is full when the next key does not fit.
+ */
+template <typename ValueType>
+class BPlusTreeSlottedPage : public BPlusTreePage {
+ public:
+  using Entry = std::pair<std::string, ValueType>;
+
+  // After creating a new page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, page_id_t parent_id, IndexPageType page_type);
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+
+  std::string_view GetPrefix() const;
+  std::string KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+  int ValueIndex(const ValueType &value) const;
+
+  // first index whose key is not less than key
+  int KeyIndex(std::string_view key) const;
+  // first index whose key is greater than key
+  int UpperBound(std::string_view key) const;
+
+  /**
+   * Inserts an entry at the given index, shortening the prefix if the key does not start with it.
+   * @return false if the page has no room for the entry, the page is left untouched then
+   */
+  bool Insert(int index, std::string_view key, const ValueType &value);
+  void Remove(int index);
+
+  /** @return true if a key of the given size can be inserted anywhere without splitting the page */
+  bool HasRoomFor(int key_size) const;
+
+  /** @return true if the page holds fewer than SLOTTED_PAGE_MIN_USED_SIZE bytes */
+  bool IsUnderfull() const;
+
+  /** @return true if removing any one entry leaves the page at least SLOTTED_PAGE_MIN_USED_SIZE bytes */
+  bool IsSafeToRemove() const;
+
+  // full keys and values of all the entries, in order
+  std::vector<Entry> GetEntries() const;
+  /**
+   * Replaces the content of the page with entries [begin, end), recomputing the prefix.
+   * @return false if they do not fit, the page is left untouched then
+   */
+  bool Load(const std::vector<Entry> &entries, size_t begin, size_t end);
+  /**
+   * Picks where to split entries into two pages of this type so that both fit and hold about
+   * the same number of bytes. Entries [0, i) go to the left page and [i, size) to the right one.
+   */
+  static size_t SplitPoint(const std::vector<Entry> &entries, bool internal);
+
+  /** @return true if entries [begin, end) fit into one page of this type */
+  static bool Fits(const std::vector<Entry> &entries, size_t begin, size_t end, bool internal);
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t size_;
+  };
+
+  int KeyBase() const { return IsLeafPage() ? 0 : 1; }
+  std::string_view SuffixAt(int index) const;
+  char *EntryAt(int index);
+  const char *EntryAt(int index) const;
+  int Search(std::string_view key, bool upper) const;
+  // bytes used by the slots, entries and prefix, holes excluded
+  int UsedSize() const;
+  // bytes needed to store entries [begin, end) in one page
+  static int SizeOf(const std::vector<Entry> &entries, size_t begin, size_t end, bool internal);
+  static size_t CommonPrefixSize(const std::vector<Entry> &entries, size_t begin, size_t end, bool internal);
+
+  page_id_t next_page_id_;
+  uint16_t prefix_size_;
+  uint16_t data_begin_;
+  Slot slots_[0];
+};
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -33,6 +34,10 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  Every readable slot also has a one-byte fingerprint of its key. Lookups
+ *  compare the fingerprints 16/32 slots at a time (SSE2/AVX2) and only call
+ *  the comparator on slots whose fingerprint matches.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -142,10 +147,35 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /**
+   * @return the one-byte fingerprint of a key
+   */
+  static uint8_t Fingerprint(const KeyType &key);
+
+  /**
+   * Calls func(bucket_idx) for every readable slot whose fingerprint matches, until func returns true.
+   *
+   * @return true if func returned true
+   */
+  template <typename Func>
+  bool ForEachMatch(uint8_t fingerprint, Func &&func);
+
+  /**
+   * @return the index-th 64-bit word of the readable_ bitmap, bits past the end of the bitmap are zero
+   */
+  uint64_t ReadableWord(size_t index) const;
+
+  /**
+   * @return the index of the first slot that is not readable, or BUCKET_ARRAY_SIZE if the bucket is full
+   */
+  uint32_t FirstFreeSlot() const;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // 每个槽位中key的指纹，只对readable的槽位有意义
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   MappingType array_[BUCKET_ARRAY_SIZE];
 };
 
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_header_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_header_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Header Page for extendible hash table.
+ *
+ * The directory of the hash table is spread over directory pages. Directory index i lives in slot
+ * (i % DIRECTORY_ARRAY_SIZE) of directory page (i / DIRECTORY_ARRAY_SIZE), so a directory with global depth
+ * <= DIRECTORY_PAGE_DEPTH fits in a single page. Directory pages are never freed: once allocated, they stay in the
+ * directory and are reused when the directory grows again.
+ *
+ * The header points to up to HEADER_ARRAY_SIZE directory pages. Beyond that the directory pages are reached through
+ * IndexLevels levels of directory index pages (see HashTableDirectoryIndexPage): each time the header is full, its
+ * children move into a new index page, which becomes its first child. A global depth of 32 needs two levels.
+ *
+ * Header format (size in byte):
+ * -------------------------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | NumDirectoryPages(4) | IndexLevels(4) | ChildPageIds(2048) | Free(2028)
+ * -------------------------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryHeaderPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id to which to set the page_id_ field
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number to which to set the lsn field
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the global depth of the hash table directory
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return mask of global_depth 1's and the rest 0's (with 1's from LSB upwards)
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Increment the global depth of the directory
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Decrement the global depth of the directory
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return the number of directory pages covered by the current global depth
+   */
+  uint32_t Size() const;
+
+  /**
+   * @return the number of directory pages allocated so far
+   */
+  uint32_t NumDirectoryPages() const;
+
+  /**
+   * Increment the number of directory pages allocated so far
+   */
+  void IncrNumDirectoryPages();
+
+  /**
+   * @return the number of levels of directory index pages between the header and the directory pages
+   */
+  uint32_t GetIndexLevels() const;
+
+  /**
+   * Increment the number of levels of directory index pages
+   */
+  void IncrIndexLevels();
+
+  /**
+   * Returns the page_id of a child, a directory page without index levels and a directory index page otherwise
+   *
+   * @param child_idx the index of the child
+   * @return the page_id of the child
+   */
+  page_id_t GetChildPageId(uint32_t child_idx) const;
+
+  /**
+   * Sets the page_id of a child
+   *
+   * @param child_idx the index of the child
+   * @param child_page_id the page_id of the child
+   */
+  void SetChildPageId(uint32_t child_idx, page_id_t child_page_id);
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_{0};
+  uint32_t num_directory_pages_{0};
+  uint32_t index_levels_{0};
+  page_id_t child_page_ids_[HEADER_ARRAY_SIZE];
+};
+
+}  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_index_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_index_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/** The bits of a directory page number resolved by one level of index pages, i.e. log2(DIRECTORY_INDEX_ARRAY_SIZE). */
+#define DIRECTORY_INDEX_PAGE_DEPTH 9
+/**
+ *
+ * Directory Index Page for extendible hash table.
+ *
+ * Once the directory needs more than HEADER_ARRAY_SIZE directory pages, the header points to directory index pages
+ * instead, which point to the directory pages or to the index pages of the next level (see
+ * HashTableDirectoryHeaderPage). The child i of an index page covers the i-th DIRECTORY_INDEX_ARRAY_SIZE^(l-1)
+ * directory pages below it, l being the level of the index page, the lowest level being 1.
+ *
+ * Directory index format (size in byte):
+ * ----------------------------------------------------
+ * | LSN (4) | PageId(4) | ChildPageIds(2048) | Free(2040)
+ * ----------------------------------------------------
+ */
+class HashTableDirectoryIndexPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id to which to set the page_id_ field
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number to which to set the lsn field
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @param child_idx the index of the child
+   * @return the page_id of the child
+   */
+  page_id_t GetChildPageId(uint32_t child_idx) const;
+
+  /**
+   * Sets the page_id of a child
+   *
+   * @param child_idx the index of the child
+   * @param child_page_id the page_id of the child
+   */
+  void SetChildPageId(uint32_t child_idx, page_id_t child_page_id);
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  page_id_t child_page_ids_[DIRECTORY_INDEX_ARRAY_SIZE];
+};
+
+}  // namespace bustub
@@ -21,11 +21,18 @@
 #include "storage/page/hash_table_page_defs.h"
 
 namespace bustub {
-#define MAX_BUCKET_DEPTH 9
+/** The global depth a single directory page can index, i.e. log2(DIRECTORY_ARRAY_SIZE). */
+#define DIRECTORY_PAGE_DEPTH 9
+/** The maximum local depth of a bucket, i.e. the width of the hash a directory index is taken from. */
+#define MAX_BUCKET_DEPTH 32
 /**
  *
  * Directory Page for extendible hash table.
  *
+ * A directory page holds the bucket pointers of one DIRECTORY_ARRAY_SIZE-sized slice of the directory (see
+ * HashTableDirectoryHeaderPage). Its global depth is the global depth of the whole directory, while Size() is
+ * the number of slots stored in this page.
+ *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
  * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
@@ -114,7 +121,8 @@ class HashTableDirectoryPage {
   uint32_t GetGlobalDepth();
 
   /**
-   * Increment the global depth of the directory
+   * Increment the global depth of the directory. While the directory fits in this page the slots are
+   * doubled in place, beyond that the caller copies the whole page into a new directory page.
    */
   void IncrGlobalDepth();
 
@@ -124,12 +132,12 @@ class HashTableDirectoryPage {
   void DecrGlobalDepth();
 
   /**
-   * @return true if the directory can be shrunk
+   * @return true if no bucket in this page has local depth equal to the global depth
    */
   bool CanShrink();
 
   /**
-   * @return the current directory size
+   * @return the number of directory slots stored in this page
    */
   uint32_t Size();
 
@@ -26,10 +26,16 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
+ * Header format (size in byte, 56 bytes in total):
  * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
+ * | LSN (4) | Size (8) | PageId(4) | NextBlockIndex(8)
  * -------------------------------------------------------------
+ * | OldSize (8) | OldNumBlocks (8) | NextMigrateIndex (8) | BlockPageIds ...
+ * -------------------------------------------------------------
+ *
+ * While the table is being resized the header keeps the block page ids of both the old and the new table:
+ * the old blocks come first in BlockPageIds, followed by the blocks of the new table. Old blocks below
+ * NextMigrateIndex have already been moved into the new table.
  */
 class HashTableHeaderPage {
  public:
@@ -89,12 +95,64 @@ class HashTableHeaderPage {
    */
   size_t NumBlocks();
 
+  /**
+   * @return the maximum number of block page ids, old and new, the header page can hold
+   */
+  static size_t MaxBlocks();
+
+  /**
+   * Starts a resize: the blocks of the table become the old blocks and the table has no blocks
+   * until new ones are added with AddBlockPageId.
+   */
+  void BeginMigration();
+
+  /**
+   * Finishes a resize, dropping the old blocks from the header page.
+   */
+  void FinishMigration();
+
+  /**
+   * @return true if the table is being resized
+   */
+  bool IsMigrating() const;
+
+  /**
+   * @return the number of buckets in the old table, 0 if the table is not being resized
+   */
+  size_t GetOldSize() const;
+
+  /**
+   * @return the number of blocks of the old table
+   */
+  size_t NumOldBlocks() const;
+
+  /**
+   * Returns the page_id of the index-th block of the old table
+   *
+   * @param index the index of the block
+   * @return the page_id for the block
+   */
+  page_id_t GetOldBlockPageId(size_t index);
+
+  /**
+   * @return the index of the next old block to move into the new table
+   */
+  size_t GetNextMigrateIndex() const;
+
+  /**
+   * Marks the next old block as moved into the new table
+   */
+  void IncrNextMigrateIndex();
+
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  __attribute__((unused)) page_id_t block_page_ids_[0];
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
+  size_t old_size_;
+  size_t old_num_blocks_;
+  size_t next_migrate_ind_;
+  page_id_t block_page_ids_[0];
 };
 
 }  // namespace bustub
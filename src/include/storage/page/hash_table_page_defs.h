@@ -34,11 +34,19 @@
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
 
+/**
+ * HEADER_ARRAY_SIZE is the number of pages an extendible hash table header page can point to, and
+ * DIRECTORY_INDEX_ARRAY_SIZE the number of pages a directory index page can point to. With l levels of index pages
+ * the directory holds up to HEADER_ARRAY_SIZE * DIRECTORY_INDEX_ARRAY_SIZE^l * DIRECTORY_ARRAY_SIZE bucket pointers.
+ */
+#define HEADER_ARRAY_SIZE 512
+#define DIRECTORY_INDEX_ARRAY_SIZE 512
+
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_ and one byte for the key
+ * fingerprint. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 5) = PAGE_SIZE/(sizeof (MappingType) + 1.25) because
+ * 1.25 bytes = 10 bits is the space required to maintain the flags and the fingerprint for a key value pair.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 5))
@@ -137,6 +137,21 @@ class TablePage : public Page {
    */
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
+  /**
+   * @note returned tuple count may be an overestimate because some slots may be empty
+   * @return at least the number of tuples in this page
+   */
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  /**
+   * Reads a tuple in place: the tuple points into the page instead of holding a copy, and no lock is taken on it.
+   * The page must stay latched while the tuple is used.
+   * @param slot_num the slot of the tuple
+   * @param[out] tuple the tuple
+   * @return true if the slot holds a tuple that is not deleted
+   */
+  bool GetTupleView(uint32_t slot_num, Tuple *tuple);
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -157,12 +172,6 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
   }
 
-  /**
-   * @note returned tuple count may be an overestimate because some slots may be empty
-   * @return at least the number of tuples in this page
-   */
-  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
-
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
@@ -17,20 +17,94 @@ namespace bustub {
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ *
+ * A page written with the RIDs of its tuples keeps the RID of each tuple right after its data:
+ * | ... | TupleSize1 | TupleData1 | RID1 (8) |
  */
 class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    lsn_t lsn = INVALID_LSN;
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    SetFreeSpacePointer(page_size);
+  }
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the offset of the most recently inserted tuple, the page size if the page is empty */
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /**
+   * Inserts a tuple at the end of the free space.
+   * @param[out] out where the tuple was stored
+   * @return false if the tuple does not fit
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    uint32_t free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
+
+  /**
+   * Inserts a tuple and its RID at the end of the free space.
+   * @param[out] out where the tuple was stored
+   * @return false if the tuple does not fit
+   */
+  bool Insert(const Tuple &tuple, RID rid, TmpTuple *out) {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength() + sizeof(int64_t);
+    uint32_t free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    int64_t rid_value = rid.Get();
+    memcpy(GetData() + free_space_pointer + size - sizeof(int64_t), &rid_value, sizeof(int64_t));
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
   }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /**
+   * Reads the tuple stored at offset. The tuples of a page are found by starting at GetFreeSpacePointer() and
+   * following the returned offsets up to the page size, which visits them from the last inserted to the first.
+   * @return the offset of the tuple inserted before it
+   */
+  size_t Get(size_t offset, Tuple *tuple) {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /**
+   * Reads the tuple and the RID stored at offset, on a page written with the RIDs of its tuples.
+   * @return the offset of the tuple inserted before it
+   */
+  size_t Get(size_t offset, Tuple *tuple, RID *rid) {
+    offset = Get(offset, tuple);
+    int64_t rid_value;
+    memcpy(&rid_value, GetData() + offset, sizeof(int64_t));
+    *rid = RID(rid_value);
+    return offset + sizeof(int64_t);
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_LSN = sizeof(page_id_t);
+  static constexpr size_t OFFSET_FREE_SPACE = OFFSET_LSN + sizeof(lsn_t);
+  static constexpr size_t SIZE_HEADER = OFFSET_FREE_SPACE + sizeof(uint32_t);
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -99,6 +102,19 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Scan the tuples of a page in place, for a filter that only materializes the tuples it selects.
+   * The tuples are neither copied nor locked, so the caller must not need locks, i.e. logging must be disabled.
+   * @param page_id the page to scan
+   * @param[in,out] slot_num the slot to start at, set to the slot to continue at
+   * @param filter called once while the page is latched, with the tuples from slot_num on in slot order; the
+   * tuples point into the page. It returns how many of them it consumed, fewer than all to stop early.
+   * @return page_id if the filter stopped early, else the id of the next page, with slot_num set to 0
+   * @throws Exception OUT_OF_MEMORY if there is no free frame to read the page into
+   */
+  page_id_t ScanPage(page_id_t page_id, uint32_t *slot_num,
+                     const std::function<uint32_t(const std::vector<Tuple> &)> &filter);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
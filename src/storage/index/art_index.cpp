@@ -0,0 +1,39 @@
+#include "storage/index/art_index.h"
+
+#include <algorithm>
+#include <string>
+
+#include "storage/index/key_normalizer.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+ArtIndex::ArtIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+void ArtIndex::InsertEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Insert(KeyNormalizer::Normalize(key, *GetKeySchema()), rid);
+}
+
+void ArtIndex::BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction * /*transaction*/) {
+  // 先编码再排序，按键序插入时相邻的键走同一条路径，缓存命中更好
+  std::vector<std::pair<std::string, RID>> normalized;
+  normalized.reserve(entries.size());
+  for (const auto &[key, rid] : entries) {
+    normalized.emplace_back(KeyNormalizer::Normalize(key, *GetKeySchema()), rid);
+  }
+  std::sort(normalized.begin(), normalized.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  for (const auto &[key, rid] : normalized) {
+    container_.Insert(key, rid);
+  }
+}
+
+void ArtIndex::DeleteEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Remove(KeyNormalizer::Normalize(key, *GetKeySchema()), rid);
+}
+
+void ArtIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction * /*transaction*/) {
+  container_.GetValue(KeyNormalizer::Normalize(key, *GetKeySchema()), result);
+}
+
+}  // namespace bustub
@@ -9,7 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <functional>
+#include <queue>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -25,13 +30,14 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      // 内部页在分裂前会暂时多存一个指针，要给它留出位置
+      internal_max_size_(std::min(internal_max_size, static_cast<int>(INTERNAL_PAGE_SIZE) - 1)) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +48,53 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  Page *page = FindLeafPage(key, false, LatchMode::READ);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                                 Transaction *transaction) {
+  results->assign(keys.size(), {});
+  size_t descents = 0;
+  Page *page = nullptr;
+  LeafPage *leaf = nullptr;
+  for (size_t i = 0; i < keys.size(); i++) {
+    // 叶子只覆盖它第一个和最后一个key之间的范围，范围外的key要从根重新找
+    if (leaf == nullptr || leaf->GetSize() == 0 || comparator_(keys[i], leaf->KeyAt(0)) < 0 ||
+        comparator_(keys[i], leaf->KeyAt(leaf->GetSize() - 1)) > 0) {
+      if (page != nullptr) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      }
+      page = FindLeafPage(keys[i], false, LatchMode::READ);
+      descents++;
+      if (page == nullptr) {
+        return descents;
+      }
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    }
+    ValueType value;
+    if (leaf->Lookup(keys[i], &value, comparator_)) {
+      (*results)[i].push_back(value);
+    }
+  }
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  return descents;
 }
 
 /*****************************************************************************
@@ -56,7 +108,29 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  // 先乐观地只对叶子加写锁，叶子不会分裂时直接插入
+  Page *page = FindLeafPage(key, false, LatchMode::OPTIMISTIC);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType old_value;
+    bool duplicate = leaf->Lookup(key, &old_value, comparator_);
+    bool safe = IsSafe(leaf, LatchMode::INSERT);
+    if (!duplicate && safe) {
+      leaf->Insert(key, value, comparator_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), !duplicate && safe);
+    if (duplicate) {
+      return false;
+    }
+    if (safe) {
+      return true;
+    }
+  }
+  // 树为空或者叶子需要分裂，从根开始对整条路径加写锁重来
+  return InsertIntoLeaf(key, value, transaction);
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,7 +138,19 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t root_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = root_page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(root_page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -76,7 +162,30 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  Transaction local_transaction(INVALID_TXN_ID);
+  Transaction *txn = transaction != nullptr ? transaction : &local_transaction;
+  Page *page = FindLeafPage(key, false, LatchMode::INSERT, txn);
+  if (page == nullptr) {
+    // 树为空，此时持有root latch的写锁
+    StartNewTree(key, value);
+    FinishWrite(txn);
+    return true;
+  }
+
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType old_value;
+  if (leaf->Lookup(key, &old_value, comparator_)) {
+    FinishWrite(txn);
+    return false;
+  }
+  leaf->Insert(key, value, comparator_);
+  if (leaf->GetSize() >= leaf_max_size_) {
+    LeafPage *new_leaf = Split(leaf);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, txn);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  FinishWrite(txn);
+  return true;
 }
 
 /*
@@ -89,7 +198,21 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new page to split into");
+  }
+  // 新页在父节点指向它之前对其他线程不可见，不需要加锁
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    node->MoveHalfTo(new_node);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    node->MoveHalfTo(new_node, buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -103,7 +226,252 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    // 根节点分裂，树长高一层；根节点不安全，所以仍持有root latch
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  // 父节点不安全，已经在page set中持有写锁
+  page_id_t parent_page_id = old_node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(parent_page_id);
+  if (parent->GetSize() > internal_max_size_) {
+    InternalPage *new_parent = Split(parent);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
+
+/*
+ * Build the tree bottom-up from a batch of key & value pairs
+ * Leaves are allocated one after another, so a scan over the loaded tree reads
+ * consecutive pages; only the page being filled and its left neighbour are
+ * pinned at any time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(std::vector<MappingType> items, double fill_factor, Transaction *transaction) {
+  std::stable_sort(items.begin(), items.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+  size_t offset = 0;
+  return BulkLoadSorted(
+      [&items, &offset](MappingType *item) {
+        if (offset == items.size()) {
+          return false;
+        }
+        *item = items[offset++];
+        return true;
+      },
+      fill_factor, transaction);
+}
+
+/*
+ * Every batch but the last one is sorted and written out as a run; a single
+ * batch never leaves memory.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AddBulkLoadRun(std::vector<MappingType> items) {
+  SpillBulkLoadRun();
+  pending_run_ = std::move(items);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FinishBulkLoad(double fill_factor, Transaction *transaction) {
+  if (bulk_load_runs_.empty()) {
+    std::vector<MappingType> items = std::move(pending_run_);
+    pending_run_.clear();
+    return BulkLoad(std::move(items), fill_factor, transaction);
+  }
+  SpillBulkLoadRun();
+  std::vector<BulkLoadRun> runs = std::move(bulk_load_runs_);
+  bulk_load_runs_.clear();
+
+  // 每个run pin住正在读的页，positions记录读到第几个
+  std::vector<size_t> positions(runs.size(), 0);
+  std::vector<const MappingType *> pages(runs.size(), nullptr);
+  auto fetch = [&](size_t run) {
+    Page *page = buffer_pool_manager_->FetchPage(runs[run].page_ids_[positions[run] / RUN_PAGE_SIZE]);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of a bulk load run");
+    }
+    pages[run] = reinterpret_cast<const MappingType *>(page->GetData());
+  };
+  auto head = [&](size_t run) -> const MappingType & { return pages[run][positions[run] % RUN_PAGE_SIZE]; };
+  // 堆顶是当前key最小的run，key相同时先加入的run在前，这样重复的key保留最先加入的
+  auto later = [&](size_t a, size_t b) {
+    int cmp = comparator_(head(a).first, head(b).first);
+    return cmp > 0 || (cmp == 0 && a > b);
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+  for (size_t run = 0; run < runs.size(); run++) {
+    fetch(run);
+    heap.push(run);
+  }
+
+  bool loaded = BulkLoadSorted(
+      [&](MappingType *item) {
+        if (heap.empty()) {
+          return false;
+        }
+        size_t run = heap.top();
+        heap.pop();
+        *item = head(run);
+        positions[run]++;
+        if (positions[run] % RUN_PAGE_SIZE == 0 || positions[run] == runs[run].size_) {
+          buffer_pool_manager_->UnpinPage(runs[run].page_ids_[(positions[run] - 1) / RUN_PAGE_SIZE], false);
+          if (positions[run] == runs[run].size_) {
+            return true;
+          }
+          fetch(run);
+        }
+        heap.push(run);
+        return true;
+      },
+      fill_factor, transaction);
+
+  for (const auto &run : runs) {
+    for (page_id_t page_id : run.page_ids_) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+  }
+  return loaded;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SpillBulkLoadRun() {
+  if (pending_run_.empty()) {
+    return;
+  }
+  std::stable_sort(pending_run_.begin(), pending_run_.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+  BulkLoadRun run{{}, pending_run_.size()};
+  for (size_t offset = 0; offset < pending_run_.size(); offset += RUN_PAGE_SIZE) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for a bulk load run");
+    }
+    size_t size = std::min(RUN_PAGE_SIZE, pending_run_.size() - offset);
+    std::copy(pending_run_.begin() + offset, pending_run_.begin() + offset + size,
+              reinterpret_cast<MappingType *>(page->GetData()));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    run.page_ids_.push_back(page_id);
+  }
+  bulk_load_runs_.push_back(std::move(run));
+  pending_run_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoadSorted(const std::function<bool(MappingType *)> &next, double fill_factor,
+                                    Transaction *transaction) {
+  bool loaded = true;
+  MappingType item;
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    // 树不为空时只能逐个插入，有序的输入也能让插入集中在最右边的叶子上
+    root_latch_.WUnlock();
+    while (next(&item)) {
+      loaded = Insert(item.first, item.second, transaction) && loaded;
+    }
+    return loaded;
+  }
+
+  // 叶子最多存max_size - 1个，否则下一次插入就会分裂
+  int leaf_capacity = leaf_max_size_ - 1;
+  int leaf_min_size = leaf_max_size_ / 2;
+  int leaf_fill = std::clamp(static_cast<int>(leaf_capacity * fill_factor), std::max(leaf_min_size, 1), leaf_capacity);
+  int internal_min_size = (internal_max_size_ + 1) / 2;
+  int internal_fill = std::clamp(static_cast<int>(internal_max_size_ * fill_factor), std::max(internal_min_size, 2),
+                                 internal_max_size_);
+
+  // 每一层记录每个节点的第一个key和页号，作为上一层的内容
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  LeafPage *prev_leaf = nullptr;
+  auto write_leaf = [&](MappingType *items, int size) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new leaf page");
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    leaf->CopyNFrom(items, size);
+    if (prev_leaf != nullptr) {
+      prev_leaf->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+    }
+    level.emplace_back(items[0].first, page_id);
+    prev_leaf = leaf;
+  };
+
+  // 攒够两个叶子才写出前一个；最后剩下不到两个叶子的pair按BulkLoadNodeSizes分，和预先知道总数时分得一样
+  std::vector<MappingType> buffer;
+  buffer.reserve(2 * leaf_fill);
+  while (next(&item)) {
+    // 只支持唯一key，重复的key保留第一个
+    if (!buffer.empty() && comparator_(buffer.back().first, item.first) == 0) {
+      loaded = false;
+      continue;
+    }
+    buffer.push_back(item);
+    if (buffer.size() == 2 * static_cast<size_t>(leaf_fill)) {
+      write_leaf(buffer.data(), leaf_fill);
+      buffer.erase(buffer.begin(), buffer.begin() + leaf_fill);
+    }
+  }
+  if (buffer.empty()) {
+    root_latch_.WUnlock();
+    return loaded;
+  }
+  size_t offset = 0;
+  for (int size : BulkLoadNodeSizes(buffer.size(), leaf_fill, leaf_min_size, leaf_capacity)) {
+    write_leaf(&buffer[offset], size);
+    offset += size;
+  }
+  buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+
+  while (level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    offset = 0;
+    for (int size : BulkLoadNodeSizes(level.size(), internal_fill, internal_min_size, internal_max_size_)) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new internal page");
+      }
+      auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+      node->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+      // CopyNFrom同时设置孩子的parent page id
+      node->CopyNFrom(&level[offset], size, buffer_pool_manager_);
+      parents.emplace_back(level[offset].first, page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      offset += size;
+    }
+    level = std::move(parents);
+  }
+
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  root_latch_.WUnlock();
+  return loaded;
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,7 +484,38 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  // 先乐观地只对叶子加写锁，叶子不会下溢时直接删除
+  Page *page = FindLeafPage(key, false, LatchMode::OPTIMISTIC);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType old_value;
+  bool found = leaf->Lookup(key, &old_value, comparator_);
+  bool safe = IsSafe(leaf, LatchMode::REMOVE);
+  if (found && safe) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), found && safe);
+  if (!found || safe) {
+    return;
+  }
+
+  // 叶子需要合并或者借节点，从根开始对整条路径加写锁重来
+  Transaction local_transaction(INVALID_TXN_ID);
+  Transaction *txn = transaction != nullptr ? transaction : &local_transaction;
+  page = FindLeafPage(key, false, LatchMode::REMOVE, txn);
+  if (page != nullptr) {
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    if (leaf->GetSize() < leaf->GetMinSize()) {
+      CoalesceOrRedistribute(leaf, txn);
+    }
+  }
+  FinishWrite(txn);
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -128,7 +527,35 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+  if (node->IsRootPage()) {
+    bool delete_root = AdjustRoot(node);
+    if (delete_root) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+    }
+    return delete_root;
+  }
+
+  // node不安全，所以父节点已经在page set中持有写锁
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  // 优先找左兄弟，最左边的节点找右兄弟；兄弟节点加入page set，最后和路径上的页一起释放
+  Page *sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  sibling_page->WLatch();
+  transaction->AddIntoPageSet(sibling_page);
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // 合并后的叶子不能达到分裂的大小
+  int max_size = node->IsLeafPage() ? leaf_max_size_ - 1 : internal_max_size_;
+  bool node_deleted = false;
+  if (sibling->GetSize() + node->GetSize() <= max_size) {
+    node_deleted = index != 0;
+    Coalesce(&sibling, &node, &parent, index, transaction);
+  } else {
+    Redistribute(sibling, node, index);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+  return node_deleted;
 }
 
 /*
@@ -148,6 +575,25 @@ template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) {
+  // 总是把右边的节点合并到左边，删除右边的节点
+  N *left = *neighbor_node;
+  N *right = *node;
+  int right_index = index;
+  if (index == 0) {
+    std::swap(left, right);
+    right_index = 1;
+  }
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    right->MoveAllTo(left);
+  } else {
+    right->MoveAllTo(left, (*parent)->KeyAt(right_index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(right_index);
+  transaction->AddIntoDeletedPageSet(right->GetPageId());
+
+  if ((*parent)->GetSize() < (*parent)->GetMinSize()) {
+    return CoalesceOrRedistribute(*parent, transaction);
+  }
   return false;
 }
 
@@ -162,7 +608,28 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    if (index == 0) {
+      neighbor_node->MoveFirstToEndOf(node);
+      parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    } else {
+      neighbor_node->MoveLastToFrontOf(node);
+      parent->SetKeyAt(index, node->KeyAt(0));
+    }
+  } else {
+    if (index == 0) {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+      parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+      parent->SetKeyAt(index, node->KeyAt(0));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +641,23 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  // 根节点不安全时才会走到这里，此时持有root latch的写锁
+  if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    UpdateRootPageId(0);
+    auto *new_root = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
+    new_root->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    return true;
+  }
+  if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return true;
+  }
+  return false;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +668,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  Page *page = FindLeafPage(KeyType{}, true, LatchMode::READ);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(this, page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +682,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  Page *page = FindLeafPage(key, false, LatchMode::READ);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  return INDEXITERATOR_TYPE(this, page, leaf->KeyIndex(key, comparator_));
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,6 +699,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Input parameter is void, construct an index iterator at the last key of the
+ * right most leaf page, to be moved backwards
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() { return INDEXITERATOR_TYPE(this); }
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -212,7 +716,183 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  return FindLeafPage(key, leftMost, LatchMode::READ);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool left_most, LatchMode mode, Transaction *transaction) {
+  bool pessimistic = mode == LatchMode::INSERT || mode == LatchMode::REMOVE;
+  if (pessimistic) {
+    // nullptr代表root latch，和路径上的页一起释放
+    root_latch_.WLock();
+    transaction->AddIntoPageSet(nullptr);
+  } else {
+    root_latch_.RLock();
+  }
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    if (!pessimistic) {
+      root_latch_.RUnlock();
+    }
+    return nullptr;
+  }
+
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root page");
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  // 持有root latch时根节点不会变化，可以先读页类型再决定加什么锁
+  if (pessimistic) {
+    page->WLatch();
+    if (IsSafe(node, mode)) {
+      ReleaseWLatches(transaction);
+    }
+    transaction->AddIntoPageSet(page);
+  } else {
+    if (mode == LatchMode::OPTIMISTIC && node->IsLeafPage()) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    root_latch_.RUnlock();
+  }
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page");
+    }
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (pessimistic) {
+      // 子节点安全时它的祖先都不会再被修改，提前释放
+      child_page->WLatch();
+      if (IsSafe(child, mode)) {
+        ReleaseWLatches(transaction);
+      }
+      transaction->AddIntoPageSet(child_page);
+    } else {
+      // 持有父节点的锁时子节点不会被分裂或删除，页类型不会变化
+      if (mode == LatchMode::OPTIMISTIC && child->IsLeafPage()) {
+        child_page->WLatch();
+      } else {
+        child_page->RLatch();
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    page = child_page;
+    node = child;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBefore(const KeyType *bound, KeyType *fence, bool *has_fence) {
+  *has_fence = false;
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root page");
+  }
+  page->RLatch();
+  root_latch_.RUnlock();
+
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    // 二分查找最后一个小于bound的key，子树里才可能有比bound小的key
+    int left = 1;
+    int right = internal->GetSize();
+    while (bound != nullptr && left < right) {
+      int mid = left + (right - left) / 2;
+      if (comparator_(internal->KeyAt(mid), *bound) < 0) {
+        left = mid + 1;
+      } else {
+        right = mid;
+      }
+    }
+    int index = bound == nullptr ? internal->GetSize() - 1 : left - 1;
+    if (index > 0) {
+      *fence = internal->KeyAt(index);
+      *has_fence = true;
+    }
+
+    Page *child_page = buffer_pool_manager_->FetchPage(internal->ValueAt(index));
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page");
+    }
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, LatchMode mode) {
+  if (mode == LatchMode::INSERT) {
+    // 叶子在达到max size时分裂，内部页在超过max size时分裂
+    return node->IsLeafPage() ? node->GetSize() < node->GetMaxSize() - 1 : node->GetSize() < node->GetMaxSize();
+  }
+  if (node->IsRootPage()) {
+    // 根节点删空（叶子）或者只剩一个孩子（内部页）时需要调整根节点
+    return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+  }
+  return node->GetSize() > node->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseWLatches(Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  while (!page_set->empty()) {
+    Page *page = page_set->front();
+    page_set->pop_front();
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+    } else {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FinishWrite(Transaction *transaction) {
+  ReleaseWLatches(transaction);
+  // 被删除的页已经不在树中；仍被迭代器pin住的页删除失败，只是不再被引用
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<int> BPLUSTREE_TYPE::BulkLoadNodeSizes(int count, int fill, int min_size, int max_size) {
+  std::vector<int> sizes(count / fill, fill);
+  if (count % fill != 0) {
+    sizes.push_back(count % fill);
+  }
+  // 最后一个节点太小时并入前一个节点，放不下就两个节点平分
+  if (sizes.size() > 1 && sizes.back() < min_size) {
+    int total = sizes[sizes.size() - 2] + sizes.back();
+    sizes.pop_back();
+    if (total <= max_size) {
+      sizes.back() = total;
+    } else {
+      sizes.back() = total / 2;
+      sizes.push_back(total - total / 2);
+    }
+  }
+  return sizes;
 }
 
 /*
@@ -226,13 +906,14 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  // header page is shared by every index
+  header_page->WLatch();
+  // the record already exists if the tree became empty before, update it then
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -400,5 +1081,18 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTree<RidSuffixedKey<GenericKey<4>>, RID,
+                         RidSuffixedComparator<GenericKey<4>, GenericComparator<4>>>;
+template class BPlusTree<RidSuffixedKey<GenericKey<8>>, RID,
+                         RidSuffixedComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTree<RidSuffixedKey<GenericKey<16>>, RID,
+                         RidSuffixedComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTree<RidSuffixedKey<GenericKey<32>>, RID,
+                         RidSuffixedComparator<GenericKey<32>, GenericComparator<32>>>;
+template class BPlusTree<RidSuffixedKey<GenericKey<64>>, RID,
+                         RidSuffixedComparator<GenericKey<64>, GenericComparator<64>>>;
 
 }  // namespace bustub
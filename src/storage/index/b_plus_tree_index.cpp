@@ -11,7 +11,59 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <type_traits>
+
 namespace bustub {
+
+namespace {
+// key里存着entry原样字节的key类型，可以用ToValue解出entry；NormalizedKey只存了编码，解不出来
+template <typename KeyType>
+struct EntryKey : std::false_type {};
+
+template <size_t KeySize>
+struct EntryKey<GenericKey<KeySize>> : std::true_type {
+  static const GenericKey<KeySize> &Get(const GenericKey<KeySize> &key) { return key; }
+};
+
+template <size_t KeySize>
+struct EntryKey<RidSuffixedKey<GenericKey<KeySize>>> : std::true_type {
+  static const GenericKey<KeySize> &Get(const RidSuffixedKey<GenericKey<KeySize>> &key) { return key.key_; }
+};
+
+/** Cursor over a BPlusTreeIndex, backed by an IndexIterator. */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeIndexCursor : public IndexCursor {
+ public:
+  BPlusTreeIndexCursor(INDEXITERATOR_TYPE &&iterator, Schema *entry_schema)
+      : iterator_(std::move(iterator)), entry_schema_(entry_schema) {}
+
+  bool Next(RID *rid, Tuple *entry) override {
+    if (iterator_.IsEnd()) {
+      return false;
+    }
+    const auto &[key, value] = *iterator_;
+    *rid = value;
+    if constexpr (EntryKey<KeyType>::value) {
+      if (entry != nullptr) {
+        std::vector<Value> values;
+        values.reserve(entry_schema_->GetColumnCount());
+        for (uint32_t i = 0; i < entry_schema_->GetColumnCount(); i++) {
+          values.emplace_back(EntryKey<KeyType>::Get(key).ToValue(entry_schema_, i));
+        }
+        *entry = Tuple(values, entry_schema_);
+      }
+    } else {
+      BUSTUB_ASSERT(entry == nullptr, "the keys of this index do not store the entries");
+    }
+    ++iterator_;
+    return true;
+  }
+
+ private:
+  INDEXITERATOR_TYPE iterator_;
+  Schema *entry_schema_;
+};
+}  // namespace
 /*
  * Constructor
  */
@@ -25,16 +77,43 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
+  if constexpr (IsRidSuffixedKey<KeyType>::value) {
+    index_key.rid_ = rid;
+  }
 
   container_.Insert(index_key, rid, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries,
+                                             Transaction *transaction) {
+  // construct insert index keys
+  std::vector<std::pair<KeyType, ValueType>> index_entries(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    index_entries[i].first.SetFromKey(entries[i].first, *GetKeySchema());
+    if constexpr (IsRidSuffixedKey<KeyType>::value) {
+      index_entries[i].first.rid_ = entries[i].second;
+    }
+    index_entries[i].second = entries[i].second;
+  }
+
+  container_.AddBulkLoadRun(std::move(index_entries));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::FinishBulkInsert(Transaction *transaction) {
+  container_.FinishBulkLoad(BPLUSTREE_TYPE::BULK_LOAD_FILL_FACTOR, transaction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
+  if constexpr (IsRidSuffixedKey<KeyType>::value) {
+    index_key.rid_ = rid;
+  }
 
   container_.Remove(index_key, transaction);
 }
@@ -43,11 +122,45 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  container_.GetValue(index_key, result, transaction);
+  if constexpr (IsRidSuffixedKey<KeyType>::value) {
+    // 同一个key的entry相邻，从最小的RID开始顺着叶子读到key变化为止
+    for (auto iterator = container_.Begin(index_key); !iterator.IsEnd(); ++iterator) {
+      if (comparator_.CompareKeys((*iterator).first, index_key) != 0) {
+        break;
+      }
+      result->push_back((*iterator).second);
+    }
+  } else {
+    container_.GetValue(index_key, result, transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  if constexpr (IsRidSuffixedKey<KeyType>::value) {
+    // 一个key可能对应多个entry，仍然逐个扫描
+    Index::ScanKeys(keys, results, transaction);
+  } else {
+    std::vector<KeyType> index_keys(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      index_keys[i].SetFromKey(keys[i], *GetKeySchema());
+    }
+    container_.GetValues(index_keys, results, transaction);
+  }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+std::unique_ptr<IndexCursor> BPLUSTREE_INDEX_TYPE::Scan(Transaction * /*transaction*/) {
+  return std::make_unique<BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>>(container_.Begin(),
+                                                                                    GetEntrySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::CanReturnEntries() const { return EntryKey<KeyType>::value; }
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.Begin(); }
 
@@ -62,5 +175,18 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTreeIndex<RidSuffixedKey<GenericKey<4>>, RID,
+                              RidSuffixedComparator<GenericKey<4>, GenericComparator<4>>>;
+template class BPlusTreeIndex<RidSuffixedKey<GenericKey<8>>, RID,
+                              RidSuffixedComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTreeIndex<RidSuffixedKey<GenericKey<16>>, RID,
+                              RidSuffixedComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTreeIndex<RidSuffixedKey<GenericKey<32>>, RID,
+                              RidSuffixedComparator<GenericKey<32>, GenericComparator<32>>>;
+template class BPlusTreeIndex<RidSuffixedKey<GenericKey<64>>, RID,
+                              RidSuffixedComparator<GenericKey<64>, GenericComparator<64>>>;
 
 }  // namespace bustub
@@ -1,5 +1,7 @@
+#include <utility>
 #include <vector>
 
+#include "common/exception.h"
 #include "storage/index/extendible_hash_table_index.h"
 
 namespace bustub {
@@ -20,7 +22,24 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Insert(transaction, index_key, rid);
+  if (!container_.Insert(transaction, index_key, rid)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the hash index cannot hold more entries with this key hash");
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries,
+                                              Transaction *transaction) {
+  // construct insert index keys
+  std::vector<std::pair<KeyType, ValueType>> index_entries(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    index_entries[i].first.SetFromKey(entries[i].first);
+    index_entries[i].second = entries[i].second;
+  }
+
+  if (!container_.BulkInsert(transaction, index_entries)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the hash index cannot hold more entries with this key hash");
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
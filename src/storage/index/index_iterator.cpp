@@ -2,7 +2,10 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -15,16 +18,174 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree, Page *page, int index)
+    : tree_(tree), buffer_pool_manager_(tree->buffer_pool_manager_) {
+  FillForward(page, index, nullptr);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::IsEnd() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree) : tree_(tree), buffer_pool_manager_(tree->buffer_pool_manager_) {
+  FillBackward(nullptr);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : tree_(other.tree_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      batch_(std::move(other.batch_)),
+      index_(other.index_) {
+  other.page_ = nullptr;
+  other.batch_.clear();
+  other.index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    tree_ = other.tree_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    batch_ = std::move(other.batch_);
+    index_ = other.index_;
+    other.page_ = nullptr;
+    other.batch_.clear();
+    other.index_ = 0;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::IsEnd() { return batch_.empty(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() { return batch_[index_]; }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  if (++index_ < static_cast<int>(batch_.size())) {
+    return *this;
+  }
+  // 批次用完后重新锁住来源叶子，从上一个返回的key之后继续
+  KeyType bound = batch_.back().first;
+  Page *page = page_;
+  page_ = nullptr;
+  page->RLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(bound, tree_->comparator_);
+  if (index < leaf->GetSize() && tree_->comparator_(leaf->KeyAt(index), bound) == 0) {
+    index++;
+  }
+  FillForward(page, index, &bound);
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator--() {
+  if (--index_ >= 0) {
+    return *this;
+  }
+  KeyType bound = batch_.front().first;
+  FillBackward(&bound);
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
+  if (batch_.empty() || itr.batch_.empty()) {
+    return batch_.empty() && itr.batch_.empty();
+  }
+  return tree_ == itr.tree_ && tree_->comparator_(batch_[index_].first, itr.batch_[itr.index_].first) == 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::FillForward(Page *page, int index, const KeyType *bound) {
+  batch_.clear();
+  index_ = 0;
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (index < leaf->GetSize()) {
+      for (int i = index; i < leaf->GetSize(); i++) {
+        batch_.push_back(leaf->GetItem(i));
+      }
+      page->RUnlatch();
+      page_ = page;
+      return;
+    }
+    // 同一时间只持有一把读锁，避免和从右往左加锁的写线程死锁；放锁前pin住下一个叶子，它不会被删除
+    page_id_t next_page_id = leaf->GetNextPageId();
+    Page *next_page = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page_id != INVALID_PAGE_ID && next_page == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+    if (page != nullptr) {
+      page->RLatch();
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      // 分裂可能把已经返回过的entry移到了右边的叶子
+      index = 0;
+      while (bound != nullptr && index < leaf->GetSize() && tree_->comparator_(leaf->KeyAt(index), *bound) <= 0) {
+        index++;
+      }
+    }
+  }
+  Release();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::FillBackward(const KeyType *bound) {
+  Release();
+  KeyType upper;
+  if (bound != nullptr) {
+    upper = *bound;
+  }
+  bool has_upper = bound != nullptr;
+  while (true) {
+    KeyType fence;
+    bool has_fence = false;
+    Page *page = tree_->FindLeafPageBefore(has_upper ? &upper : nullptr, &fence, &has_fence);
+    if (page == nullptr) {
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int end = has_upper ? leaf->KeyIndex(upper, tree_->comparator_) : leaf->GetSize();
+    if (end > 0) {
+      for (int i = 0; i < end; i++) {
+        batch_.push_back(leaf->GetItem(i));
+      }
+      index_ = end - 1;
+      page->RUnlatch();
+      page_ = page;
+      return;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    // 叶子里没有更小的key时，它们都在下界分隔key左边的子树里
+    if (!has_fence) {
+      return;
+    }
+    upper = fence;
+    has_upper = true;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  }
+  page_ = nullptr;
+  batch_.clear();
+  index_ = 0;
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +197,25 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class IndexIterator<RidSuffixedKey<GenericKey<4>>, RID,
+                             RidSuffixedComparator<GenericKey<4>, GenericComparator<4>>>;
+
+template class IndexIterator<RidSuffixedKey<GenericKey<8>>, RID,
+                             RidSuffixedComparator<GenericKey<8>, GenericComparator<8>>>;
+
+template class IndexIterator<RidSuffixedKey<GenericKey<16>>, RID,
+                             RidSuffixedComparator<GenericKey<16>, GenericComparator<16>>>;
+
+template class IndexIterator<RidSuffixedKey<GenericKey<32>>, RID,
+                             RidSuffixedComparator<GenericKey<32>, GenericComparator<32>>>;
+
+template class IndexIterator<RidSuffixedKey<GenericKey<64>>, RID,
+                             RidSuffixedComparator<GenericKey<64>, GenericComparator<64>>>;
+
 }  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_normalizer.cpp
+//
+// Identification: src/storage/index/key_normalizer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_normalizer.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+void AppendBigEndian(uint64_t bits, size_t size, std::string *out) {
+  for (size_t i = size; i > 0; i--) {
+    out->push_back(static_cast<char>((bits >> ((i - 1) * 8)) & 0xFF));
+  }
+}
+
+template <typename T>
+void AppendSigned(T value, std::string *out) {
+  // flipping the sign bit makes two's complement integers sort as unsigned ones
+  auto bits = static_cast<uint64_t>(static_cast<std::make_unsigned_t<T>>(value));
+  bits ^= uint64_t{1} << (sizeof(T) * 8 - 1);
+  AppendBigEndian(bits, sizeof(T), out);
+}
+
+}  // namespace
+
+void KeyNormalizer::AppendValue(const Value &value, std::string *out) {
+  if (value.IsNull()) {
+    out->push_back('\0');
+    return;
+  }
+  out->push_back('\1');
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      AppendSigned(value.GetAs<int8_t>(), out);
+      break;
+    case TypeId::SMALLINT:
+      AppendSigned(value.GetAs<int16_t>(), out);
+      break;
+    case TypeId::INTEGER:
+      AppendSigned(value.GetAs<int32_t>(), out);
+      break;
+    case TypeId::BIGINT:
+      AppendSigned(value.GetAs<int64_t>(), out);
+      break;
+    case TypeId::TIMESTAMP:
+      AppendBigEndian(value.GetAs<uint64_t>(), sizeof(uint64_t), out);
+      break;
+    case TypeId::DECIMAL: {
+      double decimal = value.GetAs<double>();
+      uint64_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      bits = (bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63);
+      AppendBigEndian(bits, sizeof(bits), out);
+      break;
+    }
+    case TypeId::VARCHAR: {
+      // the stored length counts the trailing '\0'
+      const char *data = value.GetData();
+      uint32_t length = value.GetLength() == 0 ? 0 : value.GetLength() - 1;
+      for (uint32_t i = 0; i < length; i++) {
+        out->push_back(data[i]);
+        if (data[i] == '\0') {
+          out->push_back('\xFF');
+        }
+      }
+      out->push_back('\0');
+      out->push_back('\0');
+      break;
+    }
+    default:
+      throw Exception(ExceptionType::MISMATCH_TYPE, "cannot normalize a key column of this type");
+  }
+}
+
+std::string KeyNormalizer::Normalize(const Tuple &key, const Schema &key_schema) {
+  std::string normalized;
+  for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+    AppendValue(key.GetValue(&key_schema, i), &normalized);
+  }
+  return normalized;
+}
+
+void KeyNormalizer::AppendRid(const RID &rid, std::string *out) {
+  AppendSigned(rid.GetPageId(), out);
+  AppendBigEndian(rid.GetSlotNum(), sizeof(uint32_t), out);
+}
+
+}  // namespace bustub
@@ -0,0 +1,545 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree.cpp
+//
+// Identification: src/storage/index/varlen_b_plus_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/varlen_b_plus_tree.h"
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+VarlenBPlusTree::VarlenBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager)
+    : index_name_(std::move(name)), root_page_id_(INVALID_PAGE_ID), buffer_pool_manager_(buffer_pool_manager) {}
+
+bool VarlenBPlusTree::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool VarlenBPlusTree::GetValue(std::string_view key, std::vector<RID> *result, Transaction *transaction) {
+  Page *page = FindLeafPage(key, false, LatchMode::READ);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool found = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+  if (found) {
+    result->push_back(leaf->ValueAt(index));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+bool VarlenBPlusTree::Insert(std::string_view key, const RID &value, Transaction *transaction) {
+  if (key.size() > SLOTTED_PAGE_MAX_KEY_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long");
+  }
+  // 先乐观地只对叶子加写锁，叶子放得下时直接插入
+  Page *page = FindLeafPage(key, false, LatchMode::OPTIMISTIC);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(key);
+    bool duplicate = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+    bool inserted = !duplicate && leaf->Insert(index, key, value);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+    if (duplicate) {
+      return false;
+    }
+    if (inserted) {
+      return true;
+    }
+  }
+  // 树为空或者叶子需要分裂，从根开始对整条路径加写锁重来
+  return InsertIntoLeaf(key, value, transaction);
+}
+
+bool VarlenBPlusTree::InsertIntoLeaf(std::string_view key, const RID &value, Transaction *transaction) {
+  Transaction local_transaction(INVALID_TXN_ID);
+  Transaction *txn = transaction != nullptr ? transaction : &local_transaction;
+  Page *page = FindLeafPage(key, false, LatchMode::INSERT, txn);
+  if (page == nullptr) {
+    // 树为空，此时持有root latch的写锁
+    page_id_t root_page_id;
+    auto *root = reinterpret_cast<LeafPage *>(NewPage(&root_page_id)->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, IndexPageType::LEAF_PAGE);
+    root->Insert(0, key, value);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(1);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    ReleaseWLatches(txn);
+    return true;
+  }
+
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  if (index < leaf->GetSize() && leaf->KeyAt(index) == key) {
+    ReleaseWLatches(txn);
+    return false;
+  }
+  if (!leaf->Insert(index, key, value)) {
+    // 两边各自重新计算prefix，分裂点按字节数选
+    std::vector<LeafPage::Entry> entries = leaf->GetEntries();
+    entries.emplace(entries.begin() + index, std::string(key), value);
+    size_t split = LeafPage::SplitPoint(entries, false);
+
+    page_id_t new_page_id;
+    auto *new_leaf = reinterpret_cast<LeafPage *>(NewPage(&new_page_id)->GetData());
+    new_leaf->Init(new_page_id, leaf->GetParentPageId(), IndexPageType::LEAF_PAGE);
+    if (!leaf->Load(entries, 0, split) || !new_leaf->Load(entries, split, entries.size())) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "split leaf does not fit into a page");
+    }
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    leaf->SetNextPageId(new_page_id);
+    // 父节点里只需要一个能分开两个叶子的最短key
+    InsertIntoParent(leaf, Separator(entries[split - 1].first, entries[split].first), new_leaf);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+  }
+  ReleaseWLatches(txn);
+  return true;
+}
+
+void VarlenBPlusTree::InsertIntoParent(BPlusTreePage *old_node, const std::string &key, BPlusTreePage *new_node) {
+  if (old_node->IsRootPage()) {
+    // 根节点分裂，树长高一层；根节点不安全，所以仍持有root latch
+    page_id_t root_page_id;
+    auto *root = reinterpret_cast<InternalPage *>(NewPage(&root_page_id)->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, IndexPageType::INTERNAL_PAGE);
+    std::vector<InternalPage::Entry> entries = {{std::string(), old_node->GetPageId()},
+                                                {key, new_node->GetPageId()}};
+    root->Load(entries, 0, entries.size());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  // 父节点不安全，已经在page set中持有写锁
+  page_id_t parent_page_id = old_node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  int index = parent->ValueIndex(old_node->GetPageId()) + 1;
+  new_node->SetParentPageId(parent_page_id);
+  if (!parent->Insert(index, key, new_node->GetPageId())) {
+    std::vector<InternalPage::Entry> entries = parent->GetEntries();
+    entries.emplace(entries.begin() + index, key, new_node->GetPageId());
+    size_t split = InternalPage::SplitPoint(entries, true);
+
+    page_id_t sibling_page_id;
+    auto *sibling = reinterpret_cast<InternalPage *>(NewPage(&sibling_page_id)->GetData());
+    sibling->Init(sibling_page_id, parent->GetParentPageId(), IndexPageType::INTERNAL_PAGE);
+    if (!parent->Load(entries, 0, split) || !sibling->Load(entries, split, entries.size())) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "split internal page does not fit into a page");
+    }
+    for (size_t i = split; i < entries.size(); i++) {
+      Adopt(entries[i].second, sibling_page_id);
+    }
+    // sibling的第一个key被推到上一层
+    InsertIntoParent(parent, entries[split].first, sibling);
+    buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
+
+std::string VarlenBPlusTree::Separator(std::string_view left, std::string_view right) {
+  // right比left大，取right到第一个不同字节为止的前缀
+  size_t common = std::mismatch(left.begin(), left.begin() + std::min(left.size(), right.size()), right.begin()).first -
+                  left.begin();
+  return std::string(right.substr(0, common + 1));
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+void VarlenBPlusTree::Remove(std::string_view key, Transaction *transaction) {
+  // 先乐观地只对叶子加写锁，叶子不会下溢时直接删除
+  Page *page = FindLeafPage(key, false, LatchMode::OPTIMISTIC);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool found = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+  bool safe = IsSafe(leaf, key, LatchMode::REMOVE);
+  if (found && safe) {
+    leaf->Remove(index);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), found && safe);
+  if (!found || safe) {
+    return;
+  }
+
+  // 叶子需要合并或者和兄弟重新分配，从根开始对整条路径加写锁重来
+  Transaction local_transaction(INVALID_TXN_ID);
+  Transaction *txn = transaction != nullptr ? transaction : &local_transaction;
+  page = FindLeafPage(key, false, LatchMode::REMOVE, txn);
+  if (page != nullptr) {
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    index = leaf->KeyIndex(key);
+    if (index < leaf->GetSize() && leaf->KeyAt(index) == key) {
+      leaf->Remove(index);
+      CoalesceOrRedistribute(leaf, txn);
+    }
+  }
+  FinishWrite(txn);
+}
+
+void VarlenBPlusTree::CoalesceOrRedistribute(BPlusTreePage *node, Transaction *transaction) {
+  if (node->IsRootPage()) {
+    if (AdjustRoot(node)) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+    }
+    return;
+  }
+  bool underfull = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsUnderfull()
+                                      : reinterpret_cast<InternalPage *>(node)->IsUnderfull();
+  if (!underfull) {
+    return;
+  }
+
+  // node不安全，所以父节点已经在page set中持有写锁
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  if (parent->GetSize() < 2) {
+    // 父节点之前没能合并，只剩这一个孩子
+    buffer_pool_manager_->UnpinPage(parent_page_id, false);
+    return;
+  }
+  // 优先找左兄弟，最左边的节点找右兄弟；兄弟节点加入page set，最后和路径上的页一起释放
+  Page *sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  if (sibling_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a sibling page");
+  }
+  sibling_page->WLatch();
+  transaction->AddIntoPageSet(sibling_page);
+  auto *sibling = reinterpret_cast<BPlusTreePage *>(sibling_page->GetData());
+
+  // 总是把右边的节点合并到左边
+  BPlusTreePage *left = index == 0 ? node : sibling;
+  BPlusTreePage *right = index == 0 ? sibling : node;
+  int right_index = index == 0 ? 1 : index;
+  bool merged = node->IsLeafPage() ? MergeOrRedistribute(reinterpret_cast<LeafPage *>(left),
+                                                         reinterpret_cast<LeafPage *>(right), parent, right_index)
+                                   : MergeOrRedistribute(reinterpret_cast<InternalPage *>(left),
+                                                         reinterpret_cast<InternalPage *>(right), parent, right_index);
+  if (merged) {
+    parent->Remove(right_index);
+    transaction->AddIntoDeletedPageSet(right->GetPageId());
+    CoalesceOrRedistribute(parent, transaction);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
+
+template <typename N>
+bool VarlenBPlusTree::MergeOrRedistribute(N *left, N *right, InternalPage *parent, int right_index) {
+  constexpr bool internal = std::is_same_v<N, InternalPage>;
+  std::vector<typename N::Entry> entries = left->GetEntries();
+  size_t left_size = entries.size();
+  for (auto &entry : right->GetEntries()) {
+    entries.push_back(std::move(entry));
+  }
+  if constexpr (internal) {
+    // right的第一个key没有存储，父节点中的分隔key被拉下来补上
+    entries[left_size].first = parent->KeyAt(right_index);
+  }
+
+  if (left->Load(entries, 0, entries.size())) {
+    if constexpr (internal) {
+      for (size_t i = left_size; i < entries.size(); i++) {
+        Adopt(static_cast<page_id_t>(entries[i].second), left->GetPageId());
+      }
+    } else {
+      left->SetNextPageId(right->GetNextPageId());
+    }
+    return true;
+  }
+
+  // 两页放不下，按字节数重新平分；新的分隔key可能更长，父节点放不下时保持原样，right只是暂时偏空
+  size_t split = N::SplitPoint(entries, internal);
+  std::string separator = internal ? entries[split].first : Separator(entries[split - 1].first, entries[split].first);
+  if (!N::Fits(entries, 0, split, internal) || !N::Fits(entries, split, entries.size(), internal) ||
+      !parent->HasRoomFor(separator.size())) {
+    return false;
+  }
+  page_id_t right_page_id = right->GetPageId();
+  parent->Remove(right_index);
+  parent->Insert(right_index, separator, right_page_id);
+  left->Load(entries, 0, split);
+  right->Load(entries, split, entries.size());
+  if constexpr (internal) {
+    // 只有换了父节点的孩子需要更新parent id
+    for (size_t i = std::min(split, left_size); i < std::max(split, left_size); i++) {
+      Adopt(static_cast<page_id_t>(entries[i].second), i < split ? left->GetPageId() : right_page_id);
+    }
+  }
+  return false;
+}
+
+bool VarlenBPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
+  // 根节点不安全时才会走到这里，此时持有root latch的写锁
+  if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->ValueAt(0);
+    UpdateRootPageId();
+    Adopt(root_page_id_, INVALID_PAGE_ID);
+    return true;
+  }
+  if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId();
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+VarlenBPlusTree::Iterator VarlenBPlusTree::Begin() {
+  Page *page = FindLeafPage({}, true, LatchMode::READ);
+  if (page == nullptr) {
+    return Iterator();
+  }
+  return Iterator(buffer_pool_manager_, page, 0);
+}
+
+VarlenBPlusTree::Iterator VarlenBPlusTree::Begin(std::string_view key) {
+  Page *page = FindLeafPage(key, false, LatchMode::READ);
+  if (page == nullptr) {
+    return Iterator();
+  }
+  return Iterator(buffer_pool_manager_, page, reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key));
+}
+
+VarlenBPlusTree::Iterator VarlenBPlusTree::End() { return Iterator(); }
+
+VarlenBPlusTree::Iterator::Iterator(BufferPoolManager *buffer_pool_manager, Page *page, int index)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      page_id_(page->GetPageId()),
+      index_(index) {
+  SkipExhaustedLeaves();
+}
+
+VarlenBPlusTree::Iterator::~Iterator() { Release(); }
+
+VarlenBPlusTree::Iterator::Iterator(Iterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      page_id_(other.page_id_),
+      index_(other.index_) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+  other.page_id_ = INVALID_PAGE_ID;
+  other.index_ = 0;
+}
+
+VarlenBPlusTree::Iterator &VarlenBPlusTree::Iterator::operator=(Iterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    page_id_ = other.page_id_;
+    index_ = other.index_;
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+    other.index_ = 0;
+  }
+  return *this;
+}
+
+VarlenBPlusTree::Iterator &VarlenBPlusTree::Iterator::operator++() {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+void VarlenBPlusTree::Iterator::SkipExhaustedLeaves() {
+  // 没能合并掉的空叶子同样直接跳过
+  while (page_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    Page *next_page = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    Release();
+    if (next_page == nullptr) {
+      return;
+    }
+    next_page->RLatch();
+    page_ = next_page;
+    leaf_ = reinterpret_cast<LeafPage *>(next_page->GetData());
+    page_id_ = next_page_id;
+    index_ = 0;
+  }
+}
+
+void VarlenBPlusTree::Iterator::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+  }
+  page_ = nullptr;
+  leaf_ = nullptr;
+  page_id_ = INVALID_PAGE_ID;
+  index_ = 0;
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+Page *VarlenBPlusTree::FindLeafPage(std::string_view key, bool left_most, LatchMode mode, Transaction *transaction) {
+  bool pessimistic = mode == LatchMode::INSERT || mode == LatchMode::REMOVE;
+  if (pessimistic) {
+    // nullptr代表root latch，和路径上的页一起释放
+    root_latch_.WLock();
+    transaction->AddIntoPageSet(nullptr);
+  } else {
+    root_latch_.RLock();
+  }
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    if (!pessimistic) {
+      root_latch_.RUnlock();
+    }
+    return nullptr;
+  }
+
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root page");
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (pessimistic) {
+    page->WLatch();
+    if (IsSafe(node, key, mode)) {
+      ReleaseWLatches(transaction);
+    }
+    transaction->AddIntoPageSet(page);
+  } else {
+    if (mode == LatchMode::OPTIMISTIC && node->IsLeafPage()) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    root_latch_.RUnlock();
+  }
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = internal->ValueAt(left_most ? 0 : internal->UpperBound(key) - 1);
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page");
+    }
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (pessimistic) {
+      child_page->WLatch();
+      if (IsSafe(child, key, mode)) {
+        ReleaseWLatches(transaction);
+      }
+      transaction->AddIntoPageSet(child_page);
+    } else {
+      if (mode == LatchMode::OPTIMISTIC && child->IsLeafPage()) {
+        child_page->WLatch();
+      } else {
+        child_page->RLatch();
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    page = child_page;
+    node = child;
+  }
+  return page;
+}
+
+bool VarlenBPlusTree::IsSafe(BPlusTreePage *node, std::string_view key, LatchMode mode) {
+  if (mode == LatchMode::REMOVE) {
+    // 根节点没有下限，只要删除后不需要调整根
+    if (node->IsRootPage()) {
+      return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+    }
+    return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsSafeToRemove()
+                              : reinterpret_cast<InternalPage *>(node)->IsSafeToRemove();
+  }
+  // 叶子只会插入key本身，内部页插入的分隔key可能来自任何一个叶子
+  if (node->IsLeafPage()) {
+    return reinterpret_cast<LeafPage *>(node)->HasRoomFor(key.size());
+  }
+  return reinterpret_cast<InternalPage *>(node)->HasRoomFor(SLOTTED_PAGE_MAX_KEY_SIZE);
+}
+
+Page *VarlenBPlusTree::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new page");
+  }
+  return page;
+}
+
+void VarlenBPlusTree::Adopt(page_id_t child_page_id, page_id_t parent_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(child_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_page_id);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+}
+
+void VarlenBPlusTree::ReleaseWLatches(Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  while (!page_set->empty()) {
+    Page *page = page_set->front();
+    page_set->pop_front();
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+    } else {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    }
+  }
+}
+
+void VarlenBPlusTree::FinishWrite(Transaction *transaction) {
+  ReleaseWLatches(transaction);
+  // 被删除的页已经不在树中；仍被迭代器pin住的页删除失败，只是不再被引用
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+void VarlenBPlusTree::UpdateRootPageId(int insert_record) {
+  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+}  // namespace bustub
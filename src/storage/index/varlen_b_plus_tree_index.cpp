@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree_index.cpp
+//
+// Identification: src/storage/index/varlen_b_plus_tree_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/varlen_b_plus_tree_index.h"
+
+#include <string>
+#include <utility>
+
+#include "storage/index/key_normalizer.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+VarlenBPlusTreeIndex::VarlenBPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata,
+                                           BufferPoolManager *buffer_pool_manager)
+    : Index(std::move(metadata)), container_(GetMetadata()->GetName(), buffer_pool_manager) {}
+
+void VarlenBPlusTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(EntryKey(key, rid), rid, transaction);
+}
+
+void VarlenBPlusTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(EntryKey(key, rid), transaction);
+}
+
+void VarlenBPlusTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // 一个key的编码不会是另一个key编码的前缀，以它开头的条目就是这个key的全部条目
+  std::string prefix = KeyNormalizer::Normalize(key, *GetKeySchema());
+  for (auto iterator = container_.Begin(prefix); !iterator.IsEnd(); ++iterator) {
+    if (iterator.Key().compare(0, prefix.size(), prefix) != 0) {
+      break;
+    }
+    result->push_back(iterator.Value());
+  }
+}
+
+VarlenBPlusTree::Iterator VarlenBPlusTreeIndex::GetBeginIterator() { return container_.Begin(); }
+
+VarlenBPlusTree::Iterator VarlenBPlusTreeIndex::GetBeginIterator(const Tuple &key) {
+  return container_.Begin(KeyNormalizer::Normalize(key, *GetKeySchema()));
+}
+
+VarlenBPlusTree::Iterator VarlenBPlusTreeIndex::GetEndIterator() { return container_.End(); }
+
+std::string VarlenBPlusTreeIndex::EntryKey(const Tuple &key, RID rid) const {
+  std::string entry_key = KeyNormalizer::Normalize(key, *GetKeySchema());
+  KeyNormalizer::AppendRid(rid, &entry_key);
+  return entry_key;
+}
+
+}  // namespace bustub
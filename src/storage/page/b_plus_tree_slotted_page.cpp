@@ -0,0 +1,301 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_slotted_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_slotted_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, IndexPageType page_type) {
+  SetPageType(page_type);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetMaxSize(0);
+  next_page_id_ = INVALID_PAGE_ID;
+  prefix_size_ = 0;
+  data_begin_ = PAGE_SIZE;
+}
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_SLOTTED_PAGE_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename ValueType>
+std::string_view B_PLUS_TREE_SLOTTED_PAGE_TYPE::GetPrefix() const {
+  return {reinterpret_cast<const char *>(this) + PAGE_SIZE - prefix_size_, prefix_size_};
+}
+
+template <typename ValueType>
+char *B_PLUS_TREE_SLOTTED_PAGE_TYPE::EntryAt(int index) {
+  return reinterpret_cast<char *>(this) + slots_[index].offset_;
+}
+
+template <typename ValueType>
+const char *B_PLUS_TREE_SLOTTED_PAGE_TYPE::EntryAt(int index) const {
+  return reinterpret_cast<const char *>(this) + slots_[index].offset_;
+}
+
+template <typename ValueType>
+std::string_view B_PLUS_TREE_SLOTTED_PAGE_TYPE::SuffixAt(int index) const {
+  return {EntryAt(index) + sizeof(ValueType), slots_[index].size_};
+}
+
+template <typename ValueType>
+std::string B_PLUS_TREE_SLOTTED_PAGE_TYPE::KeyAt(int index) const {
+  if (index < KeyBase()) {
+    return {};
+  }
+  std::string key(GetPrefix());
+  key.append(SuffixAt(index));
+  return key;
+}
+
+template <typename ValueType>
+ValueType B_PLUS_TREE_SLOTTED_PAGE_TYPE::ValueAt(int index) const {
+  // 页内偏移不一定对齐，用memcpy读写value
+  ValueType value;
+  memcpy(&value, EntryAt(index), sizeof(ValueType));
+  return value;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  memcpy(EntryAt(index), &value, sizeof(ValueType));
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::KeyIndex(std::string_view key) const {
+  return Search(key, false);
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::UpperBound(std::string_view key) const {
+  return Search(key, true);
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::Search(std::string_view key, bool upper) const {
+  // 页内所有key都以prefix开头，先和prefix比较一次，再只比较后缀
+  std::string_view prefix = GetPrefix();
+  int cmp = key.substr(0, prefix.size()).compare(prefix);
+  if (cmp < 0) {
+    return KeyBase();
+  }
+  if (cmp > 0) {
+    return GetSize();
+  }
+  std::string_view suffix = key.substr(prefix.size());
+  int left = KeyBase();
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    int order = SuffixAt(mid).compare(suffix);
+    if (order < 0 || (upper && order == 0)) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/*****************************************************************************
+ * INSERTION AND DELETION
+ *****************************************************************************/
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::Insert(int index, std::string_view key, const ValueType &value) {
+  bool keyed = index >= KeyBase();
+  std::string_view prefix = GetPrefix();
+  // 页里的第一个key整个作为prefix；key不以prefix开头时prefix要变短，这两种情况都整页重建
+  bool rebuild = keyed && (GetSize() == KeyBase() || key.substr(0, prefix.size()) != prefix);
+  int free_size = static_cast<int>(data_begin_) - SLOTTED_PAGE_HEADER_SIZE - GetSize() * static_cast<int>(sizeof(Slot));
+  int entry_size = static_cast<int>(sizeof(ValueType) + (keyed && !rebuild ? key.size() - prefix.size() : 0));
+  if (rebuild || entry_size + static_cast<int>(sizeof(Slot)) > free_size) {
+    // 空闲空间不连续时重建也会整理掉删除留下的空洞
+    std::vector<Entry> entries = GetEntries();
+    entries.emplace(entries.begin() + index, keyed ? std::string(key) : std::string(), value);
+    return Load(entries, 0, entries.size());
+  }
+
+  data_begin_ -= entry_size;
+  char *entry = reinterpret_cast<char *>(this) + data_begin_;
+  memcpy(entry, &value, sizeof(ValueType));
+  if (keyed) {
+    memcpy(entry + sizeof(ValueType), key.data() + prefix.size(), key.size() - prefix.size());
+  }
+  std::copy_backward(slots_ + index, slots_ + GetSize(), slots_ + GetSize() + 1);
+  slots_[index] = {data_begin_, static_cast<uint16_t>(entry_size - sizeof(ValueType))};
+  IncreaseSize(1);
+  return true;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::Remove(int index) {
+  // 只删除slot，entry占的空间在下次重建时回收
+  std::copy(slots_ + index + 1, slots_ + GetSize(), slots_ + index);
+  IncreaseSize(-1);
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::HasRoomFor(int key_size) const {
+  // 最坏情况下新key和prefix没有公共部分，每个key都要存回完整的prefix
+  int keyed = GetSize() - KeyBase();
+  int worst_size = UsedSize() + std::max(keyed - 1, 0) * prefix_size_ + static_cast<int>(sizeof(Slot)) +
+                   static_cast<int>(sizeof(ValueType)) + key_size;
+  return worst_size <= PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE;
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::IsUnderfull() const {
+  return UsedSize() < SLOTTED_PAGE_MIN_USED_SIZE;
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::IsSafeToRemove() const {
+  // 删除只去掉slot和entry，prefix不变，按最大的entry估算
+  int max_entry_size = 0;
+  for (int i = 0; i < GetSize(); i++) {
+    max_entry_size = std::max(max_entry_size, static_cast<int>(sizeof(Slot) + sizeof(ValueType)) + slots_[i].size_);
+  }
+  return UsedSize() - max_entry_size >= SLOTTED_PAGE_MIN_USED_SIZE;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::UsedSize() const {
+  int size = prefix_size_;
+  for (int i = 0; i < GetSize(); i++) {
+    size += static_cast<int>(sizeof(Slot) + sizeof(ValueType)) + slots_[i].size_;
+  }
+  return size;
+}
+
+/*****************************************************************************
+ * SPLIT AND REBUILD
+ *****************************************************************************/
+template <typename ValueType>
+std::vector<typename B_PLUS_TREE_SLOTTED_PAGE_TYPE::Entry> B_PLUS_TREE_SLOTTED_PAGE_TYPE::GetEntries() const {
+  std::vector<Entry> entries;
+  entries.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    entries.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return entries;
+}
+
+template <typename ValueType>
+size_t B_PLUS_TREE_SLOTTED_PAGE_TYPE::CommonPrefixSize(const std::vector<Entry> &entries, size_t begin, size_t end,
+                                                       bool internal) {
+  // key有序时，第一个和最后一个key的公共前缀就是所有key的公共前缀
+  size_t first = internal ? begin + 1 : begin;
+  if (first >= end) {
+    return 0;
+  }
+  const std::string &low = entries[first].first;
+  const std::string &high = entries[end - 1].first;
+  auto mismatch = std::mismatch(low.begin(), low.begin() + std::min(low.size(), high.size()), high.begin());
+  return std::min(static_cast<size_t>(mismatch.first - low.begin()), static_cast<size_t>(UINT16_MAX));
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::SizeOf(const std::vector<Entry> &entries, size_t begin, size_t end,
+                                          bool internal) {
+  size_t prefix_size = CommonPrefixSize(entries, begin, end, internal);
+  size_t size = prefix_size;
+  for (size_t i = begin; i < end; i++) {
+    size += sizeof(Slot) + sizeof(ValueType);
+    if (!internal || i > begin) {
+      size += entries[i].first.size() - prefix_size;
+    }
+  }
+  return static_cast<int>(std::min(size, static_cast<size_t>(std::numeric_limits<int>::max())));
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::Fits(const std::vector<Entry> &entries, size_t begin, size_t end, bool internal) {
+  return SizeOf(entries, begin, end, internal) <= PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE;
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::Load(const std::vector<Entry> &entries, size_t begin, size_t end) {
+  bool internal = !IsLeafPage();
+  if (!Fits(entries, begin, end, internal)) {
+    return false;
+  }
+  size_t prefix_size = CommonPrefixSize(entries, begin, end, internal);
+  char *page = reinterpret_cast<char *>(this);
+  prefix_size_ = prefix_size;
+  data_begin_ = PAGE_SIZE - prefix_size;
+  if (prefix_size > 0) {
+    memcpy(page + data_begin_, entries[internal ? begin + 1 : begin].first.data(), prefix_size);
+  }
+  SetSize(0);
+  for (size_t i = begin; i < end; i++) {
+    std::string_view suffix;
+    if (!internal || i > begin) {
+      suffix = std::string_view(entries[i].first).substr(prefix_size);
+    }
+    data_begin_ -= sizeof(ValueType) + suffix.size();
+    memcpy(page + data_begin_, &entries[i].second, sizeof(ValueType));
+    memcpy(page + data_begin_ + sizeof(ValueType), suffix.data(), suffix.size());
+    slots_[GetSize()] = {data_begin_, static_cast<uint16_t>(suffix.size())};
+    IncreaseSize(1);
+  }
+  return true;
+}
+
+template <typename ValueType>
+size_t B_PLUS_TREE_SLOTTED_PAGE_TYPE::SplitPoint(const std::vector<Entry> &entries, bool internal) {
+  // 两边各自的prefix不同，逐个位置计算两边的大小，选能放下且最均衡的位置
+  size_t best = entries.size() / 2;
+  int best_diff = std::numeric_limits<int>::max();
+  const int capacity = PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE;
+  for (size_t i = 1; i < entries.size(); i++) {
+    int left = SizeOf(entries, 0, i, internal);
+    int right = SizeOf(entries, i, entries.size(), internal);
+    if (left <= capacity && right <= capacity && std::abs(left - right) < best_diff) {
+      best = i;
+      best_diff = std::abs(left - right);
+    }
+  }
+  return best;
+}
+
+template class BPlusTreeSlottedPage<RID>;
+template class BPlusTreeSlottedPage<page_id_t>;
+}  // namespace bustub
@@ -11,6 +11,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,52 +27,119 @@
 
 namespace bustub {
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint8_t HASH_TABLE_BUCKET_TYPE::Fingerprint(const KeyType &key) {
+  // 与HashFunction一样按key的字节计算，再用乘法把高位混合进最高的一个字节
+  hash_t hash = HashUtil::HashBytes(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  return static_cast<uint8_t>((hash * 0x9E3779B97F4A7C15ULL) >> 56);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Func>
+bool HASH_TABLE_BUCKET_TYPE::ForEachMatch(uint8_t fingerprint, Func &&func) {
+  size_t i = 0;
+#ifdef __AVX2__
+  // 一次比较32个指纹，得到的掩码与readable位图按位与，只剩下需要比较完整key的槽位
+  const __m256i needle32 = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  for (; i + 32 <= BUCKET_ARRAY_SIZE; i += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints_ + i));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle32)));
+    uint32_t readable;
+    memcpy(&readable, readable_ + i / 8, sizeof(readable));
+    for (mask &= readable; mask != 0; mask &= mask - 1) {
+      if (func(i + __builtin_ctz(mask))) {
+        return true;
+      }
+    }
+  }
+#endif
+#ifdef __SSE2__
+  const __m128i needle16 = _mm_set1_epi8(static_cast<char>(fingerprint));
+  for (; i + 16 <= BUCKET_ARRAY_SIZE; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + i));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle16)));
+    uint16_t readable;
+    memcpy(&readable, readable_ + i / 8, sizeof(readable));
+    for (mask &= readable; mask != 0; mask &= mask - 1) {
+      if (func(i + __builtin_ctz(mask))) {
+        return true;
+      }
+    }
+  }
+#endif
+  // 剩下不足16个的槽位逐个比较
+  for (; i < BUCKET_ARRAY_SIZE; i++) {
+    if (IsReadable(i) && fingerprints_[i] == fingerprint && func(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint64_t HASH_TABLE_BUCKET_TYPE::ReadableWord(size_t index) const {
+  uint64_t word = 0;
+  size_t offset = index * sizeof(word);
+  memcpy(&word, readable_ + offset, std::min(sizeof(word), sizeof(readable_) - offset));
+  return word;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::FirstFreeSlot() const {
+  constexpr size_t num_words = (sizeof(readable_) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  for (size_t i = 0; i < num_words; i++) {
+    uint64_t free = ~ReadableWord(i);
+    if (free != 0) {
+      // 位图末尾之后的位总是0，找到的空位可能越界，此时说明bucket已满
+      auto slot = static_cast<uint32_t>(i * 64 + __builtin_ctzll(free));
+      return std::min(slot, static_cast<uint32_t>(BUCKET_ARRAY_SIZE));
+    }
+  }
+  return BUCKET_ARRAY_SIZE;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
   bool ret = false;
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (IsReadable(i) && cmp(key, array_[i].first) == 0) {
+  ForEachMatch(Fingerprint(key), [&](uint32_t i) {
+    if (cmp(key, array_[i].first) == 0) {
       result->emplace_back(array_[i].second);
       ret = true;
     }
-  }
-  
+    return false;
+  });
   return ret;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) {
-  int64_t is_exist = -1;
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (IsReadable(i)) {
-      if(cmp(key, array_[i].first) == 0 && value == array_[i].second) {
-        return false;
-      }
-    } else if (is_exist == -1) {
-      is_exist = i;
-    }
+  uint8_t fingerprint = Fingerprint(key);
+  bool is_exist = ForEachMatch(
+      fingerprint, [&](uint32_t i) { return cmp(key, array_[i].first) == 0 && value == array_[i].second; });
+  if(is_exist) {
+    return false;
   }
 
-  if(is_exist == -1) {
+  uint32_t free_slot = FirstFreeSlot();
+  if(free_slot == BUCKET_ARRAY_SIZE) {
     return false;
   }
-  array_[is_exist] = MappingType(key, value);
-  SetOccupied(is_exist);
-  SetReadable(is_exist);
+  array_[free_slot] = MappingType(key, value);
+  fingerprints_[free_slot] = fingerprint;
+  SetOccupied(free_slot);
+  SetReadable(free_slot);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) {
-  for(size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if(IsReadable(i)) {
-      if(cmp(key, array_[i].first) == 0 && value == array_[i].second) {
-        RemoveAt(i);
-        return true;
-      }
+  return ForEachMatch(Fingerprint(key), [&](uint32_t i) {
+    if(cmp(key, array_[i].first) == 0 && value == array_[i].second) {
+      RemoveAt(i);
+      return true;
     }
-  }
-  return false;
+    return false;
+  });
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -112,63 +187,22 @@ void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsFull() {
-  uint8_t mask = 255;
-  size_t i_num = BUCKET_ARRAY_SIZE / 8;
-  for (size_t i = 0; i < i_num; i++) {
-    uint8_t c = static_cast<uint8_t>(readable_[i]);
-    if ((c & mask) != mask) {
-      return false;
-    }
-  }
-
-  size_t i_remain = BUCKET_ARRAY_SIZE % 8;
-  if (i_remain > 0) {
-    uint8_t c = static_cast<uint8_t>(readable_[i_num]);
-    for (size_t i = 0; i < i_remain; i++) {
-      if((c & 1) != 1) {
-        return false;
-      }
-      c >>= 1;
-    }
-  }
-
-  return true;
+  return FirstFreeSlot() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() {
   uint32_t cnt = 0;
-  
-  size_t i_num = BUCKET_ARRAY_SIZE / 8;
-  for (size_t i = 0; i < i_num; i++) {
-    uint8_t c = static_cast<uint8_t>(readable_[i]);
-    for (uint8_t j = 0; j < 8; j++) {
-      if((c & 1) == 1) {
-        cnt++;
-      }
-      c >>= 1;
-    }
+  for (size_t i = 0; i * sizeof(uint64_t) < sizeof(readable_); i++) {
+    cnt += __builtin_popcountll(ReadableWord(i));
   }
-
-  size_t i_remain = BUCKET_ARRAY_SIZE % 8;
-  if (i_remain > 0) {
-    uint8_t c = static_cast<uint8_t>(readable_[i_num]);
-    for (size_t i = 0; i < i_remain; i++) {
-      if((c & 1) == 1) {
-        cnt++;
-      }
-      c >>= 1;
-    }
-  }
-
   return cnt;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsEmpty() {
-  uint8_t mask = 255;
-  for(size_t i = 0; i < sizeof(readable_) / sizeof(readable_[0]); i++) {
-    if((readable_[i] & mask) > 0) {
+  for (size_t i = 0; i * sizeof(uint64_t) < sizeof(readable_); i++) {
+    if (ReadableWord(i) != 0) {
       return false;
     }
   }
@@ -189,9 +223,9 @@ MappingType *HASH_TABLE_BUCKET_TYPE::GetArrayCopy() {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_BUCKET_TYPE::Reset() {
+  // 只需清空位图，array_和指纹在重新插入时覆盖
   memset(occupied_, 0, sizeof(occupied_));
   memset(readable_, 0, sizeof(readable_));
-  memset(array_, 0, sizeof(array_));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -227,4 +261,11 @@ template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
+static_assert(sizeof(HashTableBucketPage<int, int, IntComparator>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>) <= PAGE_SIZE);
+
 }  // namespace bustub
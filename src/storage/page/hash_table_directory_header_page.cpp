@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_header_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_header_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_header_page.h"
+
+#include "storage/page/hash_table_directory_page.h"
+
+namespace bustub {
+page_id_t HashTableDirectoryHeaderPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryHeaderPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryHeaderPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryHeaderPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableDirectoryHeaderPage::GetGlobalDepthMask() const {
+  return static_cast<uint32_t>((uint64_t{1} << global_depth_) - 1);
+}
+
+void HashTableDirectoryHeaderPage::IncrGlobalDepth() {
+  assert(global_depth_ < MAX_BUCKET_DEPTH);
+  global_depth_++;
+}
+
+void HashTableDirectoryHeaderPage::DecrGlobalDepth() {
+  assert(global_depth_ > 0);
+  global_depth_--;
+}
+
+uint32_t HashTableDirectoryHeaderPage::Size() const {
+  return global_depth_ <= DIRECTORY_PAGE_DEPTH ? 1 : 1U << (global_depth_ - DIRECTORY_PAGE_DEPTH);
+}
+
+uint32_t HashTableDirectoryHeaderPage::NumDirectoryPages() const { return num_directory_pages_; }
+
+void HashTableDirectoryHeaderPage::IncrNumDirectoryPages() { num_directory_pages_++; }
+
+uint32_t HashTableDirectoryHeaderPage::GetIndexLevels() const { return index_levels_; }
+
+void HashTableDirectoryHeaderPage::IncrIndexLevels() { index_levels_++; }
+
+page_id_t HashTableDirectoryHeaderPage::GetChildPageId(uint32_t child_idx) const {
+  assert(child_idx < HEADER_ARRAY_SIZE);
+  return child_page_ids_[child_idx];
+}
+
+void HashTableDirectoryHeaderPage::SetChildPageId(uint32_t child_idx, page_id_t child_page_id) {
+  assert(child_idx < HEADER_ARRAY_SIZE);
+  child_page_ids_[child_idx] = child_page_id;
+}
+
+}  // namespace bustub
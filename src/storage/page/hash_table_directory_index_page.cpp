@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_index_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_index_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_index_page.h"
+
+namespace bustub {
+page_id_t HashTableDirectoryIndexPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryIndexPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryIndexPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryIndexPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+page_id_t HashTableDirectoryIndexPage::GetChildPageId(uint32_t child_idx) const {
+  assert(child_idx < DIRECTORY_INDEX_ARRAY_SIZE);
+  return child_page_ids_[child_idx];
+}
+
+void HashTableDirectoryIndexPage::SetChildPageId(uint32_t child_idx, page_id_t child_page_id) {
+  assert(child_idx < DIRECTORY_INDEX_ARRAY_SIZE);
+  child_page_ids_[child_idx] = child_page_id;
+}
+
+}  // namespace bustub
@@ -33,19 +33,24 @@ uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) {
   return bucket_idx ^ (1 << (local_depths_[bucket_idx] - 1));
 }
 
-uint32_t HashTableDirectoryPage::GetGlobalDepthMask() { return ((1 << global_depth_) - 1); }
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() {
+  return static_cast<uint32_t>((uint64_t{1} << global_depth_) - 1);
+}
 
 uint32_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) { 
   uint8_t depth = local_depths_[bucket_idx];
-  return (1 << depth) - 1;
+  return static_cast<uint32_t>((uint64_t{1} << depth) - 1);
 }
 
 void HashTableDirectoryPage::IncrGlobalDepth() {
   assert(global_depth_ < MAX_BUCKET_DEPTH);
-  int org_num = Size();
-  for(int org_index = 0, new_index = org_num; org_index < org_num; org_index++, new_index++) {
-    bucket_page_ids_[new_index] = bucket_page_ids_[org_index];
-    local_depths_[new_index] = local_depths_[org_index];
+  // 超过一个目录页之后由哈希表负责复制整个目录页
+  if(global_depth_ < DIRECTORY_PAGE_DEPTH) {
+    int org_num = Size();
+    for(int org_index = 0, new_index = org_num; org_index < org_num; org_index++, new_index++) {
+      bucket_page_ids_[new_index] = bucket_page_ids_[org_index];
+      local_depths_[new_index] = local_depths_[org_index];
+    }
   }
   global_depth_++;
 }
@@ -56,7 +61,9 @@ page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) { return
 
 void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) { bucket_page_ids_[bucket_idx] = bucket_page_id; }
 
-uint32_t HashTableDirectoryPage::Size() { return (1 << global_depth_);}
+uint32_t HashTableDirectoryPage::Size() {
+  return global_depth_ < DIRECTORY_PAGE_DEPTH ? (1 << global_depth_) : DIRECTORY_ARRAY_SIZE;
+}
 
 bool HashTableDirectoryPage::CanShrink() { 
   // 整个Directory能不能收缩取决于每个localdepth是否都比globaldepth小
@@ -149,7 +156,7 @@ void HashTableDirectoryPage::VerifyIntegrity() {
 void HashTableDirectoryPage::PrintDirectory() {
   LOG_DEBUG("======== DIRECTORY (global_depth_: %u) ========", global_depth_);
   LOG_DEBUG("| bucket_idx | page_id | local_depth |");
-  for (uint32_t idx = 0; idx < static_cast<uint32_t>(0x1 << global_depth_); idx++) {
+  for (uint32_t idx = 0; idx < Size(); idx++) {
     LOG_DEBUG("|      %u     |     %u     |     %u     |", idx, bucket_page_ids_[idx], local_depths_[idx]);
   }
   LOG_DEBUG("================ END DIRECTORY ================");
@@ -10,25 +10,69 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
+
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
-page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) { return 0; }
+page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) {
+  assert(index < next_ind_);
+  return block_page_ids_[old_num_blocks_ + index];
+}
+
+page_id_t HashTableHeaderPage::GetPageId() const { return page_id_; }
+
+void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableHeaderPage::GetLSN() const { return lsn_; }
+
+void HashTableHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+  assert(old_num_blocks_ + next_ind_ < MaxBlocks());
+  block_page_ids_[old_num_blocks_ + next_ind_] = page_id;
+  next_ind_++;
+}
+
+size_t HashTableHeaderPage::NumBlocks() { return next_ind_; }
+
+void HashTableHeaderPage::SetSize(size_t size) { size_ = size; }
+
+size_t HashTableHeaderPage::GetSize() const { return size_; }
+
+size_t HashTableHeaderPage::MaxBlocks() { return (PAGE_SIZE - sizeof(HashTableHeaderPage)) / sizeof(page_id_t); }
 
-page_id_t HashTableHeaderPage::GetPageId() const { return 0; }
+void HashTableHeaderPage::BeginMigration() {
+  assert(!IsMigrating());
+  // The old blocks already sit at the front of the array, new blocks are appended behind them
+  old_size_ = size_;
+  old_num_blocks_ = next_ind_;
+  next_migrate_ind_ = 0;
+  size_ = 0;
+  next_ind_ = 0;
+}
 
-void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) {}
+void HashTableHeaderPage::FinishMigration() {
+  assert(IsMigrating());
+  memmove(block_page_ids_, block_page_ids_ + old_num_blocks_, next_ind_ * sizeof(page_id_t));
+  old_size_ = 0;
+  old_num_blocks_ = 0;
+  next_migrate_ind_ = 0;
+}
 
-lsn_t HashTableHeaderPage::GetLSN() const { return 0; }
+bool HashTableHeaderPage::IsMigrating() const { return old_num_blocks_ != 0; }
 
-void HashTableHeaderPage::SetLSN(lsn_t lsn) {}
+size_t HashTableHeaderPage::GetOldSize() const { return old_size_; }
 
-void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {}
+size_t HashTableHeaderPage::NumOldBlocks() const { return old_num_blocks_; }
 
-size_t HashTableHeaderPage::NumBlocks() { return 0; }
+page_id_t HashTableHeaderPage::GetOldBlockPageId(size_t index) {
+  assert(index < old_num_blocks_);
+  return block_page_ids_[index];
+}
 
-void HashTableHeaderPage::SetSize(size_t size) {}
+size_t HashTableHeaderPage::GetNextMigrateIndex() const { return next_migrate_ind_; }
 
-size_t HashTableHeaderPage::GetSize() const { return 0; }
+void HashTableHeaderPage::IncrNextMigrateIndex() { next_migrate_ind_++; }
 
 }  // namespace bustub
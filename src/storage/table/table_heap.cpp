@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
 
@@ -169,6 +171,34 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
+page_id_t TableHeap::ScanPage(page_id_t page_id, uint32_t *slot_num,
+                              const std::function<uint32_t(const std::vector<Tuple> &)> &filter) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to scan a table page");
+  }
+  page->RLatch();
+  const uint32_t tuple_count = page->GetTupleCount();
+  std::vector<Tuple> tuples;
+  tuples.reserve(tuple_count - std::min(*slot_num, tuple_count));
+  for (uint32_t slot = *slot_num; slot < tuple_count; slot++) {
+    if (!page->GetTupleView(slot, &tuples.emplace_back())) {
+      tuples.pop_back();
+    }
+  }
+  const uint32_t consumed = filter(tuples);
+  const page_id_t next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+
+  if (consumed < tuples.size()) {
+    *slot_num = tuples[consumed].GetRid().GetSlotNum();
+    return page_id;
+  }
+  *slot_num = 0;
+  return next_page_id;
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
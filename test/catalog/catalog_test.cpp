@@ -176,6 +176,89 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
 }
 
 // Vanilla index creation for valid table
+// Building an index on a table larger than one build batch sizes the hash directory for every batch
+TEST(CatalogTest, HashIndexBackfillTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(256, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+  // Small batches stand in for INDEX_BUILD_BATCH_SIZE, the table holds several of them
+  catalog->SetIndexBuildBatchSize(4096);
+
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::BIGINT);
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), "foobar", schema);
+  const int64_t num_rows = 5 * 4096 + 1000;
+  for (int64_t i = 0; i < num_rows; i++) {
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple({ValueFactory::GetBigIntValue(i)}, &schema), &rid, txn.get()));
+  }
+
+  Schema key_schema{columns};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), "index1", "foobar", schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  // Every batch found room in its buckets instead of falling back to one insert per entry
+  auto *index = dynamic_cast<ExtendibleHashTableIndex<BigintKeyType, BigintValueType, BigintComparatorType> *>(
+      index_info->index_.get());
+  ASSERT_NE(index, nullptr);
+  EXPECT_LT(index->GetNumOverflowEntries(), num_rows / 100);
+
+  for (int64_t i = 0; i < num_rows; i += 97) {
+    std::vector<RID> rids;
+    index->ScanKey(Tuple({ValueFactory::GetBigIntValue(i)}, &key_schema), &rids, txn.get());
+    EXPECT_EQ(rids.size(), 1) << i;
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// Building a B+ tree index on a table larger than one build batch loads all the batches as one sorted stream
+TEST(CatalogTest, BPlusTreeIndexBackfillTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+  catalog->SetIndexBuildBatchSize(1000);
+
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::BIGINT);
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), "foobar", schema);
+  // Every batch holds keys from all over the key range
+  const int64_t num_rows = 3 * 1000 + 500;
+  for (int64_t i = 0; i < num_rows; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetBigIntValue(i * 7919 % num_rows)}, &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  Schema key_schema{columns};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), "index1", "foobar", schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{},
+      IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  auto *index = dynamic_cast<BPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType> *>(
+      index_info->index_.get());
+  ASSERT_NE(index, nullptr);
+  int64_t current_key = 0;
+  for (auto iterator = index->GetBeginIterator(); iterator != index->GetEndIterator(); ++iterator) {
+    std::vector<RID> rids;
+    index->ScanKey(Tuple({ValueFactory::GetBigIntValue(current_key)}, &key_schema), &rids, txn.get());
+    ASSERT_EQ(rids.size(), 1) << current_key;
+    EXPECT_EQ(rids[0], (*iterator).second);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, num_rows);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 TEST(CatalogTest, DISABLED_CreateIndex1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
   auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
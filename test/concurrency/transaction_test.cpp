@@ -32,6 +32,7 @@
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/update_plan.h"
 #include "gtest/gtest.h"
 #include "test_util.h"  // NOLINT
 #include "type/value_factory.h"
@@ -162,7 +163,7 @@ void CheckTxnLockSize(Transaction *txn, size_t shared_size, size_t exclusive_siz
 }
 
 // NOLINTNEXTLINE
-TEST_F(TransactionTest, DISABLED_SimpleInsertRollbackTest) {
+TEST_F(TransactionTest, SimpleInsertRollbackTest) {
   // txn1: INSERT INTO empty_table2 VALUES (200, 20), (201, 21), (202, 22)
   // txn1: abort
   // txn2: SELECT * FROM empty_table2;
@@ -202,7 +203,7 @@ TEST_F(TransactionTest, DISABLED_SimpleInsertRollbackTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(TransactionTest, DISABLED_DirtyReadsTest) {
+TEST_F(TransactionTest, DirtyReadsTest) {
   // txn1: INSERT INTO empty_table2 VALUES (200, 20), (201, 21), (202, 22)
   // txn2: SELECT * FROM empty_table2;
   // txn1: abort
@@ -253,4 +254,76 @@ TEST_F(TransactionTest, DISABLED_DirtyReadsTest) {
   delete txn2;
 }
 
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, OptimisticValidationTest) {
+  // txn0: INSERT INTO empty_table2 VALUES (200, 20), (201, 21), (202, 22)
+  // txn1 (optimistic): SELECT * FROM empty_table2; INSERT INTO empty_table2 VALUES (300, 30)
+  // txn2 (optimistic): UPDATE empty_table2 SET colB = colB + 1
+  // txn2: commit (succeeds)
+  // txn1: commit (fails validation, its insert is never installed)
+  auto table_info = GetCatalog()->GetTable("empty_table2");
+  auto &schema = table_info->schema_;
+  auto col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+
+  auto txn0 = GetTxnManager()->Begin();
+  auto exec_ctx0 = std::make_unique<ExecutorContext>(txn0, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  std::vector<std::vector<Value>> raw_vals0{
+      {ValueFactory::GetIntegerValue(200), ValueFactory::GetIntegerValue(20)},
+      {ValueFactory::GetIntegerValue(201), ValueFactory::GetIntegerValue(21)},
+      {ValueFactory::GetIntegerValue(202), ValueFactory::GetIntegerValue(22)}};
+  InsertPlanNode insert_plan0{std::move(raw_vals0), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan0, nullptr, txn0, exec_ctx0.get());
+  ASSERT_TRUE(GetTxnManager()->Commit(txn0));
+  delete txn0;
+
+  auto txn1 = GetTxnManager()->Begin(nullptr, IsolationLevel::OPTIMISTIC);
+  auto exec_ctx1 = std::make_unique<ExecutorContext>(txn1, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, txn1, exec_ctx1.get());
+  ASSERT_EQ(result_set.size(), 3);
+  ASSERT_EQ(txn1->GetReadSet()->size(), 3);
+  std::vector<std::vector<Value>> raw_vals1{{ValueFactory::GetIntegerValue(300), ValueFactory::GetIntegerValue(30)}};
+  InsertPlanNode insert_plan1{std::move(raw_vals1), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan1, nullptr, txn1, exec_ctx1.get());
+  ASSERT_EQ(txn1->GetOptimisticWriteSet()->size(), 1);
+
+  auto txn2 = GetTxnManager()->Begin(nullptr, IsolationLevel::OPTIMISTIC);
+  auto exec_ctx2 = std::make_unique<ExecutorContext>(txn2, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+  update_attrs.emplace(static_cast<uint32_t>(1), UpdateInfo{UpdateType::Add, 1});
+  UpdatePlanNode update_plan{&scan_plan, table_info->oid_, update_attrs};
+  GetExecutionEngine()->Execute(&update_plan, nullptr, txn2, exec_ctx2.get());
+
+  // The update is buffered, so nothing is visible before txn2 commits.
+  result_set.clear();
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(), 20);
+
+  ASSERT_TRUE(GetTxnManager()->Commit(txn2));
+  CheckCommitted(txn2);
+  delete txn2;
+
+  ASSERT_FALSE(GetTxnManager()->Commit(txn1));
+  CheckAborted(txn1);
+  delete txn1;
+
+  auto txn3 = GetTxnManager()->Begin();
+  auto exec_ctx3 = std::make_unique<ExecutorContext>(txn3, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  result_set.clear();
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, txn3, exec_ctx3.get());
+  ASSERT_EQ(result_set.size(), 3);
+  for (auto i = 0UL; i < result_set.size(); ++i) {
+    auto &tuple = result_set[i];
+    auto col_a_val = tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+    auto col_b_val = tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+    ASSERT_EQ(col_a_val, static_cast<int32_t>(200 + i));
+    ASSERT_EQ(col_b_val, static_cast<int32_t>(21 + i));
+  }
+  GetTxnManager()->Commit(txn3);
+  delete txn3;
+}
+
 }  // namespace bustub
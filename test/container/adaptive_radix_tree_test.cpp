@@ -0,0 +1,230 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_test.cpp
+//
+// Identification: test/container/adaptive_radix_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "common/exception.h"
+#include "container/art/adaptive_radix_tree.h"
+#include "gtest/gtest.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+std::string MakeKey(int i) {
+  // a long shared prefix, longer than one node can store, then the digits and a terminator so no key is a prefix
+  return "customer/region-europe/account-" + std::to_string(i) + '\0';
+}
+}  // namespace
+
+TEST(AdaptiveRadixTreeTest, InsertRemoveTest) {
+  AdaptiveRadixTree tree;
+  std::vector<int> ids(20000);
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+
+  for (int id : ids) {
+    EXPECT_TRUE(tree.Insert(MakeKey(id), RID(0, id)));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(ids[0]), RID(0, ids[0])));
+
+  std::vector<RID> rids;
+  for (int id : ids) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeKey(id), &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), id);
+  }
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(MakeKey(20000), &rids));
+  EXPECT_FALSE(tree.GetValue("customer/region-asia", &rids));
+  EXPECT_TRUE(rids.empty());
+
+  // keys branching on every possible first byte grow the nodes up to a Node256
+  for (int byte = 1; byte < 256; byte++) {
+    std::string key = "customer/" + std::string(1, static_cast<char>(byte)) + '\0';
+    EXPECT_TRUE(tree.Insert(key, RID(1, byte)));
+  }
+  for (int byte = 1; byte < 256; byte++) {
+    rids.clear();
+    std::string key = "customer/" + std::string(1, static_cast<char>(byte)) + '\0';
+    ASSERT_TRUE(tree.GetValue(key, &rids));
+    EXPECT_EQ(rids[0], RID(1, byte));
+  }
+
+  // removing most keys shrinks the nodes again
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    if (i % 10 != 0) {
+      EXPECT_TRUE(tree.Remove(MakeKey(ids[i]), RID(0, ids[i])));
+    }
+  }
+  EXPECT_FALSE(tree.Remove(MakeKey(ids[1]), RID(0, ids[1])));
+  EXPECT_FALSE(tree.Remove(MakeKey(ids[0]), RID(0, -1)));
+  for (int byte = 1; byte < 256; byte++) {
+    std::string key = "customer/" + std::string(1, static_cast<char>(byte)) + '\0';
+    EXPECT_TRUE(tree.Remove(key, RID(1, byte)));
+  }
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(MakeKey(ids[i]), &rids), i % 10 == 0);
+  }
+
+  // the emptied paths are usable again
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    if (i % 10 != 0) {
+      EXPECT_TRUE(tree.Insert(MakeKey(ids[i]), RID(0, ids[i])));
+    }
+  }
+  for (int id : ids) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeKey(id), &rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), id);
+  }
+
+  // removing every key unlinks the emptied chains of nodes up to the root
+  for (int id : ids) {
+    EXPECT_TRUE(tree.Remove(MakeKey(id), RID(0, id)));
+  }
+  EXPECT_EQ(tree.GetInnerNodeCount(), 1);
+}
+
+TEST(AdaptiveRadixTreeTest, CollapseTest) {
+  AdaptiveRadixTree tree;
+  EXPECT_TRUE(tree.Insert(MakeKey(1), RID(0, 1)));
+  EXPECT_TRUE(tree.Insert(MakeKey(2), RID(0, 2)));
+  size_t node_count = tree.GetInnerNodeCount();
+
+  // a key branching off inside a prefix splits the node, removing it folds the node back into its child
+  std::string key = "customer/region-asia" + std::string(1, '\0');
+  EXPECT_TRUE(tree.Insert(key, RID(0, 3)));
+  EXPECT_EQ(tree.GetInnerNodeCount(), node_count + 1);
+  EXPECT_TRUE(tree.Remove(key, RID(0, 3)));
+  EXPECT_EQ(tree.GetInnerNodeCount(), node_count);
+
+  // the last key left moves up to the root, and then the tree is empty
+  EXPECT_TRUE(tree.Remove(MakeKey(1), RID(0, 1)));
+  EXPECT_EQ(tree.GetInnerNodeCount(), 1);
+  std::vector<RID> rids;
+  EXPECT_TRUE(tree.GetValue(MakeKey(2), &rids));
+  EXPECT_TRUE(tree.Remove(MakeKey(2), RID(0, 2)));
+  EXPECT_EQ(tree.GetInnerNodeCount(), 1);
+  EXPECT_FALSE(tree.GetValue(MakeKey(2), &rids));
+}
+
+TEST(AdaptiveRadixTreeTest, DuplicateKeyTest) {
+  AdaptiveRadixTree tree;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(tree.Insert(MakeKey(i % 10), RID(0, i)));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(3), RID(0, 13)));
+
+  std::vector<RID> rids;
+  EXPECT_TRUE(tree.GetValue(MakeKey(3), &rids));
+  EXPECT_EQ(rids.size(), 10);
+  for (const auto &rid : rids) {
+    EXPECT_EQ(rid.GetSlotNum() % 10, 3);
+  }
+
+  for (int i = 3; i < 100; i += 10) {
+    EXPECT_TRUE(tree.Remove(MakeKey(3), RID(0, i)));
+  }
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(MakeKey(3), &rids));
+  EXPECT_TRUE(tree.GetValue(MakeKey(4), &rids));
+
+  // keys must be prefix-free
+  EXPECT_THROW(tree.Insert("customer/region-europe/account-", RID(0, 0)), Exception);
+  EXPECT_THROW(tree.Insert(MakeKey(4) + "x", RID(0, 0)), Exception);
+}
+
+TEST(AdaptiveRadixTreeTest, ConcurrentTest) {
+  AdaptiveRadixTree tree;
+  const int num_threads = 4;
+  const int num_keys = 20000;
+  // keys below num_keys / 2 stay in the tree, the others are inserted and removed again while readers look them up
+  for (int i = 0; i < num_keys / 2; i++) {
+    tree.Insert(MakeKey(i), RID(0, i));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<RID> rids;
+      for (int i = num_keys / 2 + t; i < num_keys; i += num_threads) {
+        EXPECT_TRUE(tree.Insert(MakeKey(i), RID(0, i)));
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(MakeKey(i - num_keys / 2), &rids));
+      }
+      for (int i = num_keys / 2 + t; i < num_keys; i += num_threads * 2) {
+        EXPECT_TRUE(tree.Remove(MakeKey(i), RID(0, i)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> rids;
+  for (int i = 0; i < num_keys; i++) {
+    rids.clear();
+    bool removed = i >= num_keys / 2 && (i - num_keys / 2) % (num_threads * 2) < num_threads;
+    ASSERT_EQ(tree.GetValue(MakeKey(i), &rids), !removed) << i;
+  }
+}
+
+TEST(AdaptiveRadixTreeTest, CatalogIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  auto schema = ParseCreateStatement("name varchar(64),id int");
+  auto *table_info = catalog->CreateTable(&txn, "customers", *schema);
+  for (int i = 0; i < 500; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::VARCHAR, "name-" + std::to_string(i % 50)), Value(TypeId::INTEGER, i)}, schema.get());
+    table_info->table_->InsertTuple(tuple, &rid, &txn);
+  }
+
+  // the index is built from the rows already in the table
+  auto key_schema = ParseCreateStatement("name varchar(64)");
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "name_idx", "customers", *schema, *key_schema, {0}, 8, HashFunction<GenericKey<8>>(), IndexType::ART);
+  ASSERT_NE(index_info, Catalog::NULL_INDEX_INFO);
+  auto make_key = [&](int i) { return Tuple({Value(TypeId::VARCHAR, "name-" + std::to_string(i))}, key_schema.get()); };
+
+  std::vector<RID> rids;
+  index_info->index_->ScanKey(make_key(7), &rids, &txn);
+  EXPECT_EQ(rids.size(), 10);
+  index_info->index_->DeleteEntry(make_key(7), rids[0], &txn);
+  index_info->index_->InsertEntry(make_key(50), rids[0], &txn);
+  rids.clear();
+  index_info->index_->ScanKey(make_key(7), &rids, &txn);
+  EXPECT_EQ(rids.size(), 9);
+  rids.clear();
+  index_info->index_->ScanKey(make_key(50), &rids, &txn);
+  EXPECT_EQ(rids.size(), 1);
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
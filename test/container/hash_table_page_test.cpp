@@ -114,4 +114,71 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFingerprintTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  bucket_page->Reset();
+
+  // fill the bucket, it holds more keys than there are one-byte fingerprints so many of them collide
+  uint32_t capacity = 0;
+  while (bucket_page->Insert(capacity, capacity, IntComparator())) {
+    capacity++;
+  }
+  EXPECT_GT(capacity, 256);
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(capacity, bucket_page->NumReadable());
+  EXPECT_FALSE(bucket_page->Insert(capacity, capacity, IntComparator()));
+
+  // a colliding fingerprint never returns the value of another key
+  for (uint32_t i = 0; i < capacity; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(bucket_page->GetValue(capacity, IntComparator(), &res));
+  // duplicated pairs are matched on the full key and value
+  EXPECT_FALSE(bucket_page->Insert(7, 7, IntComparator()));
+
+  // tombstones in the first vector chunk, in the middle and in the last slot
+  std::vector<uint32_t> removed = {0, capacity / 2, capacity - 1};
+  for (uint32_t slot : removed) {
+    EXPECT_TRUE(bucket_page->Remove(slot, slot, IntComparator()));
+    EXPECT_TRUE(bucket_page->IsOccupied(slot));
+    EXPECT_FALSE(bucket_page->IsReadable(slot));
+  }
+  EXPECT_FALSE(bucket_page->IsFull());
+  EXPECT_EQ(capacity - removed.size(), bucket_page->NumReadable());
+  for (uint32_t slot : removed) {
+    // the fingerprint of a tombstone is still in the page but must not match
+    res.clear();
+    EXPECT_FALSE(bucket_page->GetValue(slot, IntComparator(), &res));
+    EXPECT_FALSE(bucket_page->Remove(slot, slot, IntComparator()));
+  }
+
+  // the tombstones are reused from the first one on
+  for (uint32_t slot : removed) {
+    int key = static_cast<int>(capacity + slot);
+    EXPECT_TRUE(bucket_page->Insert(key, key, IntComparator()));
+    EXPECT_EQ(key, bucket_page->KeyAt(slot));
+    EXPECT_TRUE(bucket_page->IsReadable(slot));
+    res.clear();
+    EXPECT_TRUE(bucket_page->GetValue(key, IntComparator(), &res));
+    EXPECT_EQ(1, res.size());
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "test_util.h"  // NOLINT
 
 namespace bustub {
 
@@ -117,4 +118,198 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertLookupTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // enough keys to force several splits while other threads are reading
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&ht, tid, keys_per_thread]() {
+      for (int i = tid * keys_per_thread; i < (tid + 1) * keys_per_thread; i++) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, i, &res);
+        EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  // remove half of the keys concurrently, which merges buckets again
+  threads.clear();
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&ht, tid, keys_per_thread]() {
+      for (int i = tid * keys_per_thread; i < (tid + 1) * keys_per_thread; i++) {
+        std::vector<int> res;
+        if (i % 2 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        } else {
+          ht.GetValue(nullptr, i, &res);
+          EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i % 2 == 0 ? 0 : 1, res.size());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowBeyondOneDirectoryPageTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(1500, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // more keys than 512 buckets can hold, so the directory spans several directory pages
+  const int num_keys = 250000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 9);
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  // removing everything shrinks the directory back into the first directory page
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  EXPECT_LE(ht.GetGlobalDepth(), 9);
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DirectoryIndexLevelTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+  HashFunction<GenericKey<64>> hash_fn;
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator, hash_fn);
+
+  // keys whose hashes share the low 18 bits only come apart below depth 18, so the directory needs more than the
+  // 512 directory pages the header points to and grows a level of directory index pages
+  const int num_keys = 64;
+  std::vector<GenericKey<64>> keys;
+  GenericKey<64> key;
+  for (int64_t i = 0; keys.size() < num_keys; i++) {
+    key.SetFromInteger(i);
+    if ((static_cast<uint32_t>(hash_fn.GetHash(key)) & ((1U << 18) - 1)) == 0) {
+      keys.push_back(key);
+    }
+  }
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, keys[i], RID(i, i)));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 18);
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    ht.GetValue(nullptr, keys[i], &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(RID(i, i), res[0]);
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, keys[i], RID(i, i)));
+  }
+  ht.VerifyIntegrity();
+
+  // a bucket full of one key cannot be split, the insert fails without growing the directory
+  const uint32_t global_depth = ht.GetGlobalDepth();
+  key.SetFromInteger(0);
+  int inserted = 0;
+  while (ht.Insert(nullptr, key, RID(inserted, 0))) {
+    inserted++;
+  }
+  EXPECT_GT(inserted, 0);
+  EXPECT_EQ(ht.GetGlobalDepth(), global_depth);
+  std::vector<RID> res;
+  ht.GetValue(nullptr, key, &res);
+  EXPECT_EQ(inserted, res.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, BulkInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // the batch is loaded on top of a table that already split a few times
+  const int num_existing = 2000;
+  for (int i = 0; i < num_existing; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+
+  const int num_keys = 100000;
+  std::vector<std::pair<int, int>> entries;
+  for (int i = num_existing; i < num_keys; i++) {
+    entries.emplace_back(i, i);
+  }
+  EXPECT_TRUE(ht.BulkInsert(nullptr, entries));
+  EXPECT_GE(ht.GetGlobalDepth(), 9);
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  // duplicated pairs are rejected like in Insert, the rest of the batch is still loaded
+  entries = {{5, 5}, {5, 6}, {num_keys, num_keys}};
+  EXPECT_FALSE(ht.BulkInsert(nullptr, entries));
+  std::vector<int> res;
+  ht.GetValue(nullptr, 5, &res);
+  EXPECT_EQ(2, res.size());
+  res.clear();
+  ht.GetValue(nullptr, num_keys, &res);
+  EXPECT_EQ(1, res.size());
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
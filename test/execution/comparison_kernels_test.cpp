@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// comparison_kernels_test.cpp
+//
+// Identification: test/execution/comparison_kernels_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "execution/comparison_kernels.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+bool Compare(ComparisonType comp_type, int64_t lhs, int64_t rhs) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return lhs == rhs;
+    case ComparisonType::NotEqual:
+      return lhs != rhs;
+    case ComparisonType::LessThan:
+      return lhs < rhs;
+    case ComparisonType::LessThanOrEqual:
+      return lhs <= rhs;
+    case ComparisonType::GreaterThan:
+      return lhs > rhs;
+    case ComparisonType::GreaterThanOrEqual:
+      return lhs >= rhs;
+  }
+  return false;
+}
+
+template <typename T>
+void CheckKernels() {
+  const std::vector<ComparisonType> comp_types{ComparisonType::Equal,           ComparisonType::NotEqual,
+                                               ComparisonType::LessThan,        ComparisonType::LessThanOrEqual,
+                                               ComparisonType::GreaterThan,     ComparisonType::GreaterThanOrEqual};
+  std::mt19937 gen(15445);
+  // Few distinct values so that equal values are common, and the extremes of T
+  std::uniform_int_distribution<int> dist(-4, 4);
+  auto random_value = [&]() -> T {
+    int value = dist(gen);
+    if (value == -4) {
+      return std::numeric_limits<T>::min();
+    }
+    if (value == 4) {
+      return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(value);
+  };
+
+  // Lengths around the vector width and the bitmap word
+  for (uint32_t count : {0, 1, 7, 8, 9, 63, 64, 65, 130, 1000}) {
+    std::vector<T> lhs(count);
+    // A constant right side is rhs[0], which exists even without values
+    std::vector<T> rhs(count + 1);
+    for (uint32_t i = 0; i < count; i++) {
+      lhs[i] = random_value();
+      rhs[i] = random_value();
+    }
+    std::vector<uint64_t> bitmap(ComparisonKernels::BitmapWords(count));
+    std::vector<uint32_t> selection(count);
+    for (auto comp_type : comp_types) {
+      for (bool constant_rhs : {false, true}) {
+        ComparisonKernels::GetKernel<T>(comp_type, constant_rhs)(lhs.data(), rhs.data(), count, bitmap.data());
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < count; i++) {
+          if (Compare(comp_type, lhs[i], constant_rhs ? rhs[0] : rhs[i])) {
+            expected.push_back(i);
+          }
+        }
+        uint32_t selected = ComparisonKernels::ToSelection(bitmap.data(), count, selection.data());
+        ASSERT_EQ(std::vector<uint32_t>(selection.begin(), selection.begin() + selected), expected)
+            << count << " values, comparison " << static_cast<int>(comp_type) << ", constant " << constant_rhs;
+      }
+
+      // Swapping the sides of a comparison and flipping it gives the same result
+      ComparisonKernels::GetKernel<T>(ComparisonKernels::Flip(comp_type), false)(rhs.data(), lhs.data(), count,
+                                                                                 bitmap.data());
+      for (uint32_t i = 0; i < count; i++) {
+        EXPECT_EQ((bitmap[i / 64] >> (i % 64)) & 1, Compare(comp_type, lhs[i], rhs[i]));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ComparisonKernelsTest, Int32Test) { CheckKernels<int32_t>(); }
+
+TEST(ComparisonKernelsTest, Int64Test) { CheckKernels<int64_t>(); }
+
+}  // namespace bustub
@@ -10,29 +10,44 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "concurrency/transaction_manager.h"
+#include "execution/compiled_scan.h"
 #include "execution/execution_engine.h"
+#include "execution/executor_factory.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/merge_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/sort_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/morsel_scheduler.h"
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
 #include "execution/plans/update_plan.h"
 #include "executor_test_util.h"  // NOLINT
 #include "gtest/gtest.h"
@@ -87,7 +102,7 @@ using ComparatorType = GenericComparator<8>;
 using HashFunctionType = HashFunction<KeyType>;
 
 // SELECT col_a, col_b FROM test_1 WHERE col_a < 500
-TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
+TEST_F(ExecutorTest, SimpleSeqScanTest) {
   // Construct query plan
   TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
   const Schema &schema = table_info->schema_;
@@ -111,7 +126,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
 }
 
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
+TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
   std::vector<Value> val2{ValueFactory::GetIntegerValue(101), ValueFactory::GetIntegerValue(11)};
@@ -153,7 +168,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
 }
 
 // INSERT INTO empty_table2 SELECT col_a, col_b FROM test_1 WHERE col_a < 500
-TEST_F(ExecutorTest, DISABLED_SimpleSelectInsertTest) {
+TEST_F(ExecutorTest, SimpleSelectInsertTest) {
   const Schema *out_schema1;
   std::unique_ptr<AbstractPlanNode> scan_plan1;
   {
@@ -205,7 +220,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleSelectInsertTest) {
 }
 
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
+TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
   std::vector<Value> val2{ValueFactory::GetIntegerValue(101), ValueFactory::GetIntegerValue(11)};
@@ -270,7 +285,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
 }
 
 // UPDATE test_3 SET colB = colB + 1;
-TEST_F(ExecutorTest, DISABLED_SimpleUpdateTest) {
+TEST_F(ExecutorTest, SimpleUpdateTest) {
   // Construct a sequential scan of the table
   const Schema *out_schema{};
   std::unique_ptr<AbstractPlanNode> scan_plan{};
@@ -329,7 +344,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleUpdateTest) {
 }
 
 // DELETE FROM test_1 WHERE col_a == 50;
-TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
+TEST_F(ExecutorTest, SimpleDeleteTest) {
   // Construct query plan
   auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
   auto &schema = table_info->schema_;
@@ -373,6 +388,175 @@ TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
   ASSERT_TRUE(rids.empty());
 }
 
+// SELECT col_a, col_b FROM test_1 WHERE col_b < 5, through an index on col_a that includes col_b
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE, {1});
+  ASSERT_NE(index_info, Catalog::NULL_INDEX_INFO);
+
+  auto col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto predicate = MakeComparisonExpression(col_b, const5, ComparisonType::LessThan);
+  // Every column the first scan reads is stored in the index, the second one reads col_c from the table
+  auto covered_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  IndexScanPlanNode covered_plan{covered_schema, predicate, index_info->index_oid_};
+  auto heap_schema = MakeOutputSchema({{"colA", col_a}, {"colC", col_c}});
+  IndexScanPlanNode heap_plan{heap_schema, predicate, index_info->index_oid_};
+  auto scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"colC", col_c}});
+  SeqScanPlanNode scan_plan{scan_schema, predicate, table_info->oid_};
+
+  // Both return the rows of the sequential scan, which are in col_a order too
+  auto check = [&]() {
+    std::vector<Tuple> expected{};
+    GetExecutionEngine()->Execute(&scan_plan, &expected, GetTxn(), GetExecutorContext());
+    ASSERT_FALSE(expected.empty());
+
+    IndexScanExecutor covered_executor{GetExecutorContext(), &covered_plan};
+    covered_executor.Init();
+    EXPECT_TRUE(covered_executor.IsIndexOnly());
+    IndexScanExecutor heap_executor{GetExecutorContext(), &heap_plan};
+    heap_executor.Init();
+    EXPECT_FALSE(heap_executor.IsIndexOnly());
+
+    Tuple tuple;
+    RID rid;
+    for (const auto &row : expected) {
+      ASSERT_TRUE(covered_executor.Next(&tuple, &rid));
+      EXPECT_EQ(tuple.GetValue(covered_schema, 0).GetAs<int32_t>(), row.GetValue(scan_schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(tuple.GetValue(covered_schema, 1).GetAs<int32_t>(), row.GetValue(scan_schema, 1).GetAs<int32_t>());
+      ASSERT_TRUE(heap_executor.Next(&tuple, &rid));
+      EXPECT_EQ(tuple.GetValue(heap_schema, 0).GetAs<int32_t>(), row.GetValue(scan_schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(tuple.GetValue(heap_schema, 1).GetAs<int32_t>(), row.GetValue(scan_schema, 2).GetAs<int32_t>());
+    }
+    EXPECT_FALSE(covered_executor.Next(&tuple, &rid));
+    EXPECT_FALSE(heap_executor.Next(&tuple, &rid));
+  };
+  check();
+
+  // The included column is maintained by inserts and updates
+  std::vector<std::vector<Value>> raw_vals{{ValueFactory::GetIntegerValue(TEST1_SIZE), ValueFactory::GetIntegerValue(1),
+                                            ValueFactory::GetIntegerValue(2), ValueFactory::GetIntegerValue(3)}};
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs{{1, UpdateInfo{UpdateType::Set, 0}}};
+  SeqScanPlanNode all_plan{scan_schema, nullptr, table_info->oid_};
+  UpdatePlanNode update_plan{&all_plan, table_info->oid_, update_attrs};
+  GetExecutionEngine()->Execute(&update_plan, nullptr, GetTxn(), GetExecutorContext());
+  check();
+
+  // The key and the included columns are stored as a raw tuple in the key, so they must fit and be inlined
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  EXPECT_THROW((catalog->CreateIndex<KeyType, ValueType, ComparatorType>(
+                   GetTxn(), "index2", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{},
+                   IndexType::B_PLUS_TREE, {1, 2})),
+               Exception);
+  auto varchar_schema = ParseCreateStatement("a int,b varchar(4)");
+  catalog->CreateTable(GetTxn(), "test_varchar", *varchar_schema);
+  EXPECT_THROW((catalog->CreateIndex<KeyType, ValueType, ComparatorType>(
+                   GetTxn(), "index3", "test_varchar", *varchar_schema, *key_schema, {0}, 8, HashFunctionType{},
+                   IndexType::B_PLUS_TREE, {1})),
+               Exception);
+}
+
+// Batch-at-a-time execution produces the same tuples as tuple-at-a-time execution
+TEST_F(ExecutorTest, BatchExecutionTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode scan_plan2{scan_schema, nullptr, table_info->oid_};
+
+  // Batches smaller than the input
+  TupleBatch batch{64};
+  auto count_batches = [&](const AbstractPlanNode *plan, std::vector<uint32_t> *sizes) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    size_t count = 0;
+    while (executor->NextBatch(&batch)) {
+      EXPECT_LE(batch.GetSize(), batch.GetCapacity());
+      if (sizes != nullptr) {
+        sizes->push_back(batch.GetSize());
+      }
+      count += batch.GetSize();
+    }
+    return count;
+  };
+  auto count_tuples = [&](const AbstractPlanNode *plan) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    size_t count = 0;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      count++;
+    }
+    return count;
+  };
+
+  // The scan fills whole batches, in table order
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    executor->Init();
+    int32_t next = 0;
+    while (executor->NextBatch(&batch)) {
+      for (auto row : batch.GetSelection()) {
+        ASSERT_EQ(batch.GetValue(row, 0).GetAs<int32_t>(), next++);
+      }
+    }
+    EXPECT_EQ(next, TEST1_SIZE);
+  }
+
+  // The limit cuts the selection of the last batch short
+  LimitPlanNode limit_plan{scan_schema, &scan_plan, 100};
+  std::vector<uint32_t> sizes;
+  EXPECT_EQ(count_batches(&limit_plan, &sizes), 100);
+  EXPECT_EQ(sizes, (std::vector<uint32_t>{64, 36}));
+
+  // The distinct drops the duplicates from the selection
+  auto *distinct_schema = MakeOutputSchema({{"colB", col_b}});
+  SeqScanPlanNode distinct_scan_plan{distinct_schema, nullptr, table_info->oid_};
+  DistinctPlanNode distinct_plan{distinct_schema, &distinct_scan_plan};
+  EXPECT_EQ(count_batches(&distinct_plan, nullptr), 10);
+  EXPECT_EQ(count_tuples(&distinct_plan), 10);
+
+  // A join on col_b has far more matches than fit into a batch
+  auto *left_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *right_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *right_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *join_schema = MakeOutputSchema({{"left_colB", left_b}, {"right_colA", right_a}});
+  HashJoinPlanNode join_plan{join_schema, {&scan_plan, &scan_plan2}, left_b, right_b};
+  size_t join_count = count_tuples(&join_plan);
+  EXPECT_GT(join_count, TEST1_SIZE * 50);
+  EXPECT_EQ(count_batches(&join_plan, nullptr), join_count);
+
+  // Aggregations read their input a batch at a time, COUNT(col_a) GROUP BY col_b adds up to the table size
+  const AbstractExpression *group_by_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  const AbstractExpression *aggregate_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *count_a = MakeAggregateValueExpression(false, 0);
+  auto *agg_schema = MakeOutputSchema({{"countA", count_a}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &scan_plan,
+                               nullptr,
+                               {group_by_b},
+                               {aggregate_a},
+                               std::vector<AggregationType>{AggregationType::CountAggregate}};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(result_set.size(), 10);
+  int32_t total = 0;
+  for (const auto &tuple : result_set) {
+    total += tuple.GetValue(agg_schema, 0).GetAs<int32_t>();
+  }
+  EXPECT_EQ(total, TEST1_SIZE);
+}
+
 // SELECT test_1.col_a, test_1.col_b, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.col_a = test_2.col1;
 TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
   const Schema *out_schema1;
@@ -418,7 +602,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
 }
 
 // SELECT test_4.colA, test_4.colB, test_6.colA, test_6.colB FROM test_4 JOIN test_6 ON test_4.colA = test_6.colA;
-TEST_F(ExecutorTest, DISABLED_SimpleHashJoinTest) {
+TEST_F(ExecutorTest, SimpleHashJoinTest) {
   // Construct sequential scan of table test_4
   const Schema *out_schema1{};
   std::unique_ptr<AbstractPlanNode> scan_plan1{};
@@ -486,8 +670,234 @@ TEST_F(ExecutorTest, DISABLED_SimpleHashJoinTest) {
   }
 }
 
+TEST_F(ExecutorTest, SpillingHashJoinTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan1{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode scan_plan2{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode scan_plan3{scan_schema, nullptr, table_info->oid_};
+
+  // test_1 JOIN test_1 ON colB, about TEST1_SIZE * TEST1_SIZE / 10 rows
+  auto *left_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *left_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *right_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *right_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *pairs_schema = MakeOutputSchema({{"left_colA", left_a}, {"right_colA", right_a}});
+  HashJoinPlanNode pairs_plan{pairs_schema, {&scan_plan1, &scan_plan2}, left_b, right_b};
+
+  // ... JOIN test_1 ON right_colA = colA, whose build side needs many partitions
+  auto *pair_left = MakeColumnValueExpression(*pairs_schema, 0, "left_colA");
+  auto *pair_right = MakeColumnValueExpression(*pairs_schema, 0, "right_colA");
+  auto *out_schema = MakeOutputSchema({{"left_colA", pair_left}, {"right_colA", right_a}});
+  HashJoinPlanNode join_plan{out_schema, {&pairs_plan, &scan_plan3}, pair_right, right_a};
+
+  std::vector<size_t> counts(10, 0);
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan1);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      counts[tuple.GetValue(scan_schema, 1).GetAs<int32_t>()]++;
+    }
+  }
+  const size_t expected = std::inner_product(counts.begin(), counts.end(), counts.begin(), size_t{0});
+
+  auto check_join = [&](bool spilled) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+    executor->Init();
+    EXPECT_EQ(dynamic_cast<HashJoinExecutor *>(executor.get())->IsSpilled(), spilled);
+    TupleBatch batch;
+    size_t count = 0;
+    int64_t checksum = 0;
+    while (executor->NextBatch(&batch)) {
+      for (auto row : batch.GetSelection()) {
+        int32_t left = batch.GetValue(row, 0).GetAs<int32_t>();
+        int32_t right = batch.GetValue(row, 1).GetAs<int32_t>();
+        checksum += static_cast<int64_t>(left) * TEST1_SIZE + right;
+        count++;
+      }
+    }
+    EXPECT_EQ(count, expected);
+    return checksum;
+  };
+
+  int64_t checksum = check_join(false);
+  // Within a few hundred KB the second join partitions both of its inputs to temporary pages
+  GetExecutorContext()->SetMemoryBudget(256 * 1024);
+  EXPECT_EQ(check_join(true), checksum);
+  // With less, the partitions that still do not fit are partitioned again
+  GetExecutorContext()->SetMemoryBudget(16 * 1024);
+  EXPECT_EQ(check_join(true), checksum);
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+    executor->Init();
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+    }
+    const size_t fanout = 8;
+    EXPECT_GT(dynamic_cast<HashJoinExecutor *>(executor.get())->GetNumSpillPartitions(), fanout);
+  }
+
+  // The temporary pages are all deleted, so all frames are free again
+  std::vector<page_id_t> page_ids(GetBPM()->GetPoolSize());
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(GetBPM()->NewPage(&page_id), nullptr);
+  }
+  for (auto page_id : page_ids) {
+    GetBPM()->UnpinPage(page_id, false);
+    GetBPM()->DeletePage(page_id);
+  }
+}
+
+// test_1 JOIN test_1 ON colB, both sides sorted on colB, and ON colA, both sides scanned from an index on colA
+TEST_F(ExecutorTest, MergeJoinTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE);
+  ASSERT_NE(index_info, Catalog::NULL_INDEX_INFO);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan1{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode scan_plan2{scan_schema, nullptr, table_info->oid_};
+  auto *sort_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  SortPlanNode sort_plan1{scan_schema, &scan_plan1, {{OrderByType::Ascending, sort_b}}};
+  SortPlanNode sort_plan2{scan_schema, &scan_plan2, {{OrderByType::Ascending, sort_b}}};
+
+  auto *left_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *left_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *right_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *right_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *out_schema = MakeOutputSchema({{"left_colA", left_a}, {"right_colA", right_a}, {"colB", left_b}});
+  MergeJoinPlanNode merge_plan{out_schema, {&sort_plan1, &sort_plan2}, left_b, right_b};
+  HashJoinPlanNode hash_plan{out_schema, {&scan_plan1, &scan_plan2}, left_b, right_b};
+
+  using Row = std::vector<int32_t>;
+  auto run_join = [&](const AbstractPlanNode *plan, size_t *group_pages) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    std::vector<Row> result;
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      for (auto row : batch.GetSelection()) {
+        result.push_back({batch.GetValue(row, 0).GetAs<int32_t>(), batch.GetValue(row, 1).GetAs<int32_t>(),
+                          batch.GetValue(row, 2).GetAs<int32_t>()});
+        // Only the last group can still have pages
+        if (auto *merge_join = dynamic_cast<MergeJoinExecutor *>(executor.get()); merge_join != nullptr) {
+          *group_pages = std::max(*group_pages, merge_join->GetNumGroupPages());
+        }
+      }
+    }
+    return result;
+  };
+
+  // Every left row of a colB value joins every right row of it, about 100 of them
+  size_t group_pages = 0;
+  std::vector<Row> expected = run_join(&hash_plan, &group_pages);
+  std::sort(expected.begin(), expected.end());
+  ASSERT_GT(expected.size(), TEST1_SIZE);
+  std::vector<Row> result = run_join(&merge_plan, &group_pages);
+  // The output is in colB order
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end(), [](const Row &a, const Row &b) { return a[2] < b[2]; }));
+  std::sort(result.begin(), result.end());
+  EXPECT_EQ(result, expected);
+  EXPECT_EQ(group_pages, 0);
+
+  // A group that does not fit in a few hundred bytes is read from temporary pages for every left row
+  GetExecutorContext()->SetMemoryBudget(256);
+  result = run_join(&merge_plan, &group_pages);
+  std::sort(result.begin(), result.end());
+  EXPECT_EQ(result, expected);
+  EXPECT_GT(group_pages, 0);
+
+  // Index scans on colA join on unique keys, one row each
+  IndexScanPlanNode index_plan1{scan_schema, nullptr, index_info->index_oid_};
+  IndexScanPlanNode index_plan2{scan_schema, nullptr, index_info->index_oid_};
+  auto *out_a_schema = MakeOutputSchema({{"left_colA", left_a}, {"right_colA", right_a}, {"colB", right_b}});
+  MergeJoinPlanNode index_merge_plan{out_a_schema, {&index_plan1, &index_plan2}, left_a, right_a};
+  group_pages = 0;
+  result = run_join(&index_merge_plan, &group_pages);
+  ASSERT_EQ(result.size(), TEST1_SIZE);
+  for (size_t i = 0; i < result.size(); i++) {
+    EXPECT_EQ(result[i][0], static_cast<int32_t>(i));
+    EXPECT_EQ(result[i][1], static_cast<int32_t>(i));
+  }
+  EXPECT_EQ(group_pages, 0);
+
+  // The temporary pages are all deleted, so all frames are free again
+  std::vector<page_id_t> page_ids(GetBPM()->GetPoolSize());
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(GetBPM()->NewPage(&page_id), nullptr);
+  }
+  for (auto page_id : page_ids) {
+    GetBPM()->UnpinPage(page_id, false);
+    GetBPM()->DeletePage(page_id);
+  }
+}
+
+// SELECT outer.colA, inner.colA, inner.colB FROM test_1 outer JOIN test_1 inner ON outer.colC = inner.colA
+TEST_F(ExecutorTest, NestedIndexJoinTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a int");
+  auto *tree_index = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE);
+  ASSERT_NE(tree_index, Catalog::NULL_INDEX_INFO);
+  auto *hash_index = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index2", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::HASH_TABLE);
+  ASSERT_NE(hash_index, Catalog::NULL_INDEX_INFO);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"colC", col_c}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+
+  // colC is in [0, 10000), so about one outer row in ten finds the inner row whose colA equals it
+  auto *outer_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *outer_c = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  auto *inner_a = MakeColumnValueExpression(schema, 1, "colA");
+  auto *inner_b = MakeColumnValueExpression(schema, 1, "colB");
+  auto *predicate = MakeComparisonExpression(outer_c, inner_a, ComparisonType::Equal);
+  auto *out_schema = MakeOutputSchema({{"outer_colA", outer_a}, {"inner_colA", inner_a}, {"inner_colB", inner_b}});
+
+  std::vector<Tuple> rows;
+  GetExecutionEngine()->Execute(&scan_plan, &rows, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(rows.size(), TEST1_SIZE);
+  std::vector<std::vector<int32_t>> expected;
+  for (const auto &row : rows) {
+    int32_t key = row.GetValue(scan_schema, 2).GetAs<int32_t>();
+    if (key < static_cast<int32_t>(TEST1_SIZE)) {
+      expected.push_back({row.GetValue(scan_schema, 0).GetAs<int32_t>(), key,
+                          rows[key].GetValue(scan_schema, 1).GetAs<int32_t>()});
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+
+  // The output keeps the order of the outer rows, whichever index is probed
+  for (const auto *index_name : {"index1", "index2"}) {
+    NestedIndexJoinPlanNode join_plan{out_schema, {&scan_plan}, predicate, table_info->oid_, index_name,
+                                      scan_schema,  &schema};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::vector<int32_t>> result;
+    for (const auto &tuple : result_set) {
+      result.push_back({tuple.GetValue(out_schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 1).GetAs<int32_t>(),
+                        tuple.GetValue(out_schema, 2).GetAs<int32_t>()});
+    }
+    EXPECT_EQ(result, expected) << index_name;
+  }
+}
+
 // SELECT COUNT(col_a), SUM(col_a), min(col_a), max(col_a) from test_1;
-TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
+TEST_F(ExecutorTest, SimpleAggregationTest) {
   const Schema *scan_schema;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   {
@@ -536,8 +946,51 @@ TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
   ASSERT_EQ(result_set.size(), 1);
 }
 
+// SELECT min(col3), max(col3) FROM test_2 WHERE col3 > 1024 (or col3 < 0), after inserting BIGINT values beyond
+// the INTEGER range
+TEST_F(ExecutorTest, BigintMinMaxAggregationTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto &schema = table_info->schema_;
+  const int64_t small = static_cast<int64_t>(BUSTUB_INT32_MIN) * 4;
+  const int64_t large = static_cast<int64_t>(BUSTUB_INT32_MAX) * 4;
+  std::vector<std::vector<Value>> raw_vals;
+  for (int64_t value : {small, 2 * small, large, 2 * large}) {
+    raw_vals.push_back({ValueFactory::GetSmallIntValue(0), ValueFactory::GetIntegerValue(0),
+                        ValueFactory::GetBigIntValue(value), ValueFactory::GetIntegerValue(0)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // All the inputs are beyond the INTEGER bound the aggregate could have started at
+  auto check = [&](ComparisonType comparison, int64_t bound, int64_t expected_min, int64_t expected_max) {
+    auto col3 = MakeColumnValueExpression(schema, 0, "col3");
+    auto predicate = MakeComparisonExpression(col3, MakeConstantValueExpression(ValueFactory::GetBigIntValue(bound)),
+                                              comparison);
+    auto scan_schema = MakeOutputSchema({{"col3", col3}});
+    SeqScanPlanNode scan_plan{scan_schema, predicate, table_info->oid_};
+    auto scan_col3 = MakeColumnValueExpression(*scan_schema, 0, "col3");
+    AggregateValueExpression min_col3{false, 0, TypeId::BIGINT};
+    AggregateValueExpression max_col3{false, 1, TypeId::BIGINT};
+    auto agg_schema = MakeOutputSchema({{"min_col3", &min_col3}, {"max_col3", &max_col3}});
+    AggregationPlanNode agg_plan{agg_schema,
+                                 &scan_plan,
+                                 nullptr,
+                                 {},
+                                 {scan_col3, scan_col3},
+                                 {AggregationType::MinAggregate, AggregationType::MaxAggregate}};
+
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), 1);
+    EXPECT_EQ(result_set[0].GetValue(agg_schema, 0).GetAs<int64_t>(), expected_min);
+    EXPECT_EQ(result_set[0].GetValue(agg_schema, 1).GetAs<int64_t>(), expected_max);
+  };
+  check(ComparisonType::GreaterThan, 1024, large, 2 * large);
+  check(ComparisonType::LessThan, 0, 2 * small, small);
+}
+
 // SELECT count(col_a), col_b, sum(col_c) FROM test_1 Group By col_b HAVING count(col_a) > 100
-TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
+TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   const Schema *scan_schema;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   {
@@ -589,8 +1042,274 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
   }
 }
 
+// SELECT colX, COUNT(colY), SUM(colY), MIN(colY), MAX(colY) FROM test_1 GROUP BY colX, on one and on several threads
+TEST_F(ExecutorTest, ParallelAggregationTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+
+  std::vector<std::pair<int32_t, int32_t>> rows;
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      rows.emplace_back(tuple.GetValue(scan_schema, 0).GetAs<int32_t>(),
+                        tuple.GetValue(scan_schema, 1).GetAs<int32_t>());
+    }
+  }
+
+  auto *group_by = MakeAggregateValueExpression(true, 0);
+  auto *count = MakeAggregateValueExpression(false, 0);
+  auto *sum = MakeAggregateValueExpression(false, 1);
+  auto *min = MakeAggregateValueExpression(false, 2);
+  auto *max = MakeAggregateValueExpression(false, 3);
+  auto *agg_schema =
+      MakeOutputSchema({{"group", group_by}, {"count", count}, {"sum", sum}, {"min", min}, {"max", max}});
+  const std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                               AggregationType::MinAggregate, AggregationType::MaxAggregate};
+
+  // 10 groups of 100 rows, then 1000 groups of one row
+  for (uint32_t group_col : {1, 0}) {
+    const uint32_t agg_col = 1 - group_col;
+    std::map<int32_t, std::vector<int32_t>> expected;
+    for (const auto &row : rows) {
+      int32_t key = group_col == 0 ? row.first : row.second;
+      int32_t value = agg_col == 0 ? row.first : row.second;
+      auto &aggregates = expected[key];
+      if (aggregates.empty()) {
+        aggregates = {0, 0, BUSTUB_INT32_MAX, BUSTUB_INT32_MIN};
+      }
+      aggregates[0]++;
+      aggregates[1] += value;
+      aggregates[2] = std::min(aggregates[2], value);
+      aggregates[3] = std::max(aggregates[3], value);
+    }
+
+    const char *group_name = group_col == 0 ? "colA" : "colB";
+    const char *agg_name = agg_col == 0 ? "colA" : "colB";
+    const AbstractExpression *group_expr = MakeColumnValueExpression(*scan_schema, 0, group_name);
+    const AbstractExpression *agg_expr = MakeColumnValueExpression(*scan_schema, 0, agg_name);
+    AggregationPlanNode agg_plan{agg_schema,
+                                 &scan_plan,
+                                 nullptr,
+                                 {group_expr},
+                                 {agg_expr, agg_expr, agg_expr, agg_expr},
+                                 std::vector<AggregationType>(agg_types)};
+    for (size_t num_threads : {1, 4}) {
+      GetExecutorContext()->SetNumThreads(num_threads);
+      std::vector<Tuple> result_set{};
+      GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+      std::map<int32_t, std::vector<int32_t>> actual;
+      for (const auto &tuple : result_set) {
+        auto &aggregates = actual[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()];
+        EXPECT_TRUE(aggregates.empty());
+        for (uint32_t i = 1; i < 5; i++) {
+          aggregates.push_back(tuple.GetValue(agg_schema, i).GetAs<int32_t>());
+        }
+      }
+      EXPECT_EQ(actual, expected) << num_threads << " threads";
+    }
+  }
+}
+
+// SELECT colA, colB, colC FROM compiled WHERE ..., for predicates that run on kernels and one that is interpreted
+TEST_F(ExecutorTest, CompiledScanTest) {
+  Schema table_schema({Column("colA", TypeId::TINYINT), Column("colB", TypeId::SMALLINT),
+                       Column("colC", TypeId::BIGINT), Column("colD", TypeId::VARCHAR, 16)});
+  auto *table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "compiled", table_schema);
+  const int32_t num_rows = 3000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    RID rid;
+    Value col_b = i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::SMALLINT)
+                             : ValueFactory::GetSmallIntValue(static_cast<int16_t>(i % 1000));
+    Tuple tuple({ValueFactory::GetTinyIntValue(static_cast<int8_t>(i % 100)), col_b,
+                 ValueFactory::GetBigIntValue(i * 1000000000LL),
+                 ValueFactory::GetVarcharValue("row-" + std::to_string(i))},
+                &table_schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+    // Deleted tuples are skipped
+    if (i % 5 == 0) {
+      ASSERT_TRUE(table_info->table_->MarkDelete(rid, GetTxn()));
+    }
+  }
+
+  auto *col_a = MakeColumnValueExpression(table_schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(table_schema, 0, "colB");
+  auto *col_c = MakeColumnValueExpression(table_schema, 0, "colC");
+  auto *col_d = MakeColumnValueExpression(table_schema, 0, "colD");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"colC", col_c}});
+  auto constant = [&](int64_t value) { return MakeConstantValueExpression(ValueFactory::GetBigIntValue(value)); };
+
+  struct Case {
+    const AbstractExpression *predicate_;
+    bool kernel_;
+    std::function<bool(int32_t)> expected_;
+  };
+  std::vector<Case> cases{
+      {nullptr, false, [](int32_t i) { return true; }},
+      {MakeComparisonExpression(col_b, constant(500), ComparisonType::LessThan), true,
+       [](int32_t i) { return i % 7 != 0 && i % 1000 < 500; }},
+      // Both columns have to be non-null
+      {MakeComparisonExpression(col_a, col_b, ComparisonType::Equal), true,
+       [](int32_t i) { return i % 7 != 0 && i % 100 == i % 1000; }},
+      {MakeComparisonExpression(constant(2000000000000LL), col_c, ComparisonType::LessThanOrEqual), true,
+       [](int32_t i) { return i >= 2000; }},
+      {MakeComparisonExpression(col_a, constant(3), ComparisonType::NotEqual), true,
+       [](int32_t i) { return i % 100 != 3; }},
+      {MakeComparisonExpression(col_d, MakeConstantValueExpression(ValueFactory::GetVarcharValue("row-42")),
+                                ComparisonType::Equal),
+       false, [](int32_t i) { return i == 42; }},
+  };
+
+  for (const auto &test_case : cases) {
+    SeqScanPlanNode scan_plan{out_schema, test_case.predicate_, table_info->oid_};
+    EXPECT_EQ(CompiledScan(&scan_plan, &table_schema).HasKernelFilter(), test_case.kernel_);
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+
+    std::vector<int32_t> expected;
+    for (int32_t i = 0; i < num_rows; i++) {
+      if (i % 5 != 0 && test_case.expected_(i)) {
+        expected.push_back(i);
+      }
+    }
+    std::vector<int32_t> actual;
+    for (const auto &tuple : result_set) {
+      auto i = static_cast<int32_t>(tuple.GetValue(out_schema, 2).GetAs<int64_t>() / 1000000000LL);
+      EXPECT_EQ(tuple.GetValue(out_schema, 0).GetAs<int8_t>(), i % 100);
+      EXPECT_EQ(tuple.GetValue(out_schema, 1).IsNull(), i % 7 == 0);
+      actual.push_back(i);
+    }
+    EXPECT_EQ(actual, expected);
+  }
+
+  // A compiled scan without a free frame fails instead of crashing
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (GetBPM()->NewPage(&page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  EXPECT_THROW(executor->Next(&tuple, &rid), Exception);
+  for (auto pinned_id : pinned) {
+    GetBPM()->UnpinPage(pinned_id, false);
+    GetBPM()->DeletePage(pinned_id);
+  }
+}
+
+// Morsels of a table scanned by several workers: SELECT colA FROM morsels WHERE colA < 15000, and
+// morsels JOIN test_1 ON morsels.colB = test_1.colA
+TEST_F(ExecutorTest, MorselExecutionTest) {
+  Schema table_schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER)});
+  auto *table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "morsels", table_schema);
+  const int32_t num_rows = 20000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % TEST1_SIZE)}, &table_schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+
+  // Every morsel is taken exactly once, a worker that runs out stealing those of the others
+  {
+    MorselQueue morsels(table_info->table_.get(), GetBPM(), 3, 2);
+    ASSERT_GT(morsels.GetNumMorsels(), 3);
+    std::vector<size_t> taken;
+    Morsel morsel;
+    ASSERT_TRUE(morsels.Next(1, &morsel));
+    EXPECT_EQ(morsel.index_, morsels.GetNumMorsels() / 3);
+    EXPECT_EQ(morsel.pages_.size(), 2);
+    taken.push_back(morsel.index_);
+    while (morsels.Next(0, &morsel)) {
+      EXPECT_FALSE(morsel.pages_.empty());
+      taken.push_back(morsel.index_);
+    }
+    EXPECT_FALSE(morsels.Next(2, &morsel));
+    std::sort(taken.begin(), taken.end());
+    std::vector<size_t> all(morsels.GetNumMorsels());
+    std::iota(all.begin(), all.end(), 0);
+    EXPECT_EQ(taken, all);
+  }
+
+  auto *col_a = MakeColumnValueExpression(table_schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(table_schema, 0, "colB");
+  auto *predicate = MakeComparisonExpression(col_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(15000)),
+                                             ComparisonType::LessThan);
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, predicate, table_info->oid_};
+
+  // The rows come out in table order whatever the number of workers
+  for (size_t num_threads : {1, 4}) {
+    GetExecutorContext()->SetNumThreads(num_threads);
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), 15000);
+    for (int32_t i = 0; i < 15000; i++) {
+      ASSERT_EQ(result_set[i].GetValue(scan_schema, 0).GetAs<int32_t>(), i) << num_threads << " threads";
+    }
+  }
+
+  auto *test_1 = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *right_a = MakeColumnValueExpression(test_1->schema_, 0, "colA");
+  auto *right_schema = MakeOutputSchema({{"colA", right_a}});
+  SeqScanPlanNode right_plan{right_schema, nullptr, test_1->oid_};
+  auto *left_key = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *right_key = MakeColumnValueExpression(*right_schema, 1, "colA");
+  auto *out_schema = MakeOutputSchema({{"left_colA", MakeColumnValueExpression(*scan_schema, 0, "colA")},
+                                       {"right_colA", right_key}});
+  HashJoinPlanNode join_plan{out_schema, {&scan_plan, &right_plan}, left_key, right_key};
+
+  // Each of the 15000 build rows matches one row of test_1; the parallel build falls back to spilling past the budget
+  auto check_join = [&](size_t num_threads, bool spilled) {
+    GetExecutorContext()->SetNumThreads(num_threads);
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+    executor->Init();
+    EXPECT_EQ(dynamic_cast<HashJoinExecutor *>(executor.get())->IsSpilled(), spilled);
+    Tuple tuple;
+    RID rid;
+    std::vector<int32_t> left_rows;
+    while (executor->Next(&tuple, &rid)) {
+      int32_t left = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+      EXPECT_EQ(tuple.GetValue(out_schema, 1).GetAs<int32_t>(), left % TEST1_SIZE);
+      left_rows.push_back(left);
+    }
+    std::sort(left_rows.begin(), left_rows.end());
+    ASSERT_EQ(left_rows.size(), 15000) << num_threads << " threads";
+    EXPECT_EQ(left_rows.back(), 14999);
+  };
+  check_join(1, false);
+  check_join(4, false);
+  GetExecutorContext()->SetMemoryBudget(256 * 1024);
+  check_join(4, true);
+
+  // A scan without a free frame fails instead of returning part of the table, on one thread or several
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (GetBPM()->NewPage(&page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  for (size_t num_threads : {4, 1}) {
+    GetExecutorContext()->SetNumThreads(num_threads);
+    std::vector<Tuple> result_set{};
+    EXPECT_THROW(GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext()), Exception);
+    EXPECT_TRUE(result_set.empty());
+  }
+  for (auto pinned_id : pinned) {
+    GetBPM()->UnpinPage(pinned_id, false);
+    GetBPM()->DeletePage(pinned_id);
+  }
+}
+
 // SELECT colA, colB FROM test_3 LIMIT 10
-TEST_F(ExecutorTest, DISABLED_SimpleLimitTest) {
+TEST_F(ExecutorTest, SimpleLimitTest) {
   auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
   auto &schema = table_info->schema_;
 
@@ -617,8 +1336,127 @@ TEST_F(ExecutorTest, DISABLED_SimpleLimitTest) {
   }
 }
 
+// SELECT colA, colB, colC FROM test_1 ORDER BY colC ASC, colB DESC
+TEST_F(ExecutorTest, SortTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"colC", col_c}});
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+
+  auto *sort_b = MakeColumnValueExpression(*out_schema, 0, "colB");
+  auto *sort_c = MakeColumnValueExpression(*out_schema, 0, "colC");
+  SortPlanNode sort_plan{out_schema, &scan_plan, {{OrderByType::Ascending, sort_c}, {OrderByType::Descending, sort_b}}};
+  // Equal colB values keep the order of the scan, i.e. of colA
+  SortPlanNode stable_plan{out_schema, &scan_plan, {{OrderByType::Descending, sort_b}}};
+
+  using Row = std::vector<int32_t>;
+  std::vector<Row> rows;
+  std::unordered_map<int32_t, RID> rids;
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      rids[tuple.GetValue(out_schema, 0).GetAs<int32_t>()] = rid;
+      rows.push_back({tuple.GetValue(out_schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 1).GetAs<int32_t>(),
+                      tuple.GetValue(out_schema, 2).GetAs<int32_t>()});
+    }
+  }
+  ASSERT_EQ(rows.size(), TEST1_SIZE);
+  std::vector<Row> expected = rows;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const Row &a, const Row &b) { return a[2] < b[2] || (a[2] == b[2] && a[1] > b[1]); });
+  std::vector<Row> expected_stable = rows;
+  std::stable_sort(expected_stable.begin(), expected_stable.end(),
+                   [](const Row &a, const Row &b) { return a[1] > b[1]; });
+
+  auto run_sort = [&](const SortPlanNode *plan, std::optional<size_t> limit, size_t *num_runs) {
+    auto child = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    SortExecutor executor{GetExecutorContext(), plan, std::move(child), limit};
+    executor.Init();
+    *num_runs = executor.GetNumRuns();
+    std::vector<Row> result;
+    TupleBatch batch;
+    while (executor.NextBatch(&batch)) {
+      for (auto row : batch.GetSelection()) {
+        result.push_back({batch.GetValue(row, 0).GetAs<int32_t>(), batch.GetValue(row, 1).GetAs<int32_t>(),
+                          batch.GetValue(row, 2).GetAs<int32_t>()});
+      }
+    }
+    return result;
+  };
+  auto first = [](const std::vector<Row> &all, size_t count) {
+    return std::vector<Row>(all.begin(), all.begin() + count);
+  };
+
+  size_t num_runs;
+  EXPECT_EQ(run_sort(&sort_plan, std::nullopt, &num_runs), expected);
+  EXPECT_EQ(num_runs, 0);
+  EXPECT_EQ(run_sort(&stable_plan, std::nullopt, &num_runs), expected_stable);
+  // A limit keeps the first rows
+  EXPECT_EQ(first(run_sort(&sort_plan, 10, &num_runs), 10), first(expected, 10));
+  EXPECT_EQ(first(run_sort(&stable_plan, 0, &num_runs), 0), first(expected_stable, 0));
+
+  // A few KB only hold a few dozen rows, the others are merged from runs on temporary pages
+  GetExecutorContext()->SetMemoryBudget(4 * 1024);
+  EXPECT_EQ(run_sort(&sort_plan, std::nullopt, &num_runs), expected);
+  EXPECT_GT(num_runs, 10);
+  EXPECT_EQ(run_sort(&stable_plan, std::nullopt, &num_runs), expected_stable);
+  // The first 10 rows fit in memory, the first 500 do not
+  EXPECT_EQ(first(run_sort(&sort_plan, 10, &num_runs), 10), first(expected, 10));
+  EXPECT_EQ(num_runs, 0);
+  EXPECT_EQ(first(run_sort(&stable_plan, 500, &num_runs), 500), first(expected_stable, 500));
+  EXPECT_GT(num_runs, 0);
+  // The rows merged from runs keep their RIDs
+  {
+    auto child = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    SortExecutor executor{GetExecutorContext(), &sort_plan, std::move(child)};
+    executor.Init();
+    ASSERT_GT(executor.GetNumRuns(), 0);
+    Tuple tuple;
+    RID rid;
+    size_t count = 0;
+    while (executor.Next(&tuple, &rid)) {
+      ASSERT_EQ(rid, rids[tuple.GetValue(out_schema, 0).GetAs<int32_t>()]);
+      count++;
+    }
+    EXPECT_EQ(count, TEST1_SIZE);
+  }
+
+  // The factory sorts below a limit with the limit
+  LimitPlanNode limit_plan{out_schema, &sort_plan, 10};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 10);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), expected[i][0]);
+  }
+
+  // A sort that is not read to the end deletes its runs, so all frames are free again
+  {
+    auto child = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    SortExecutor executor{GetExecutorContext(), &sort_plan, std::move(child)};
+    executor.Init();
+    Tuple tuple;
+    RID rid;
+    ASSERT_TRUE(executor.Next(&tuple, &rid));
+  }
+  std::vector<page_id_t> page_ids(GetBPM()->GetPoolSize());
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(GetBPM()->NewPage(&page_id), nullptr);
+  }
+  for (auto page_id : page_ids) {
+    GetBPM()->UnpinPage(page_id, false);
+    GetBPM()->DeletePage(page_id);
+  }
+}
+
 // SELECT DISTINCT colC FROM test_7
-TEST_F(ExecutorTest, DISABLED_SimpleDistinctTest) {
+TEST_F(ExecutorTest, SimpleDistinctTest) {
   auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_7");
   auto &schema = table_info->schema_;
 
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+int Sign(int x) { return (x > 0) - (x < 0); }
+
+// column by column comparison through Value, the reference order of the typed comparators
+int CompareValues(const Tuple &lhs, const Tuple &rhs, const Schema &schema) {
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    Value l = lhs.GetValue(&schema, i);
+    Value r = rhs.GetValue(&schema, i);
+    if (l.CompareLessThan(r) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (l.CompareGreaterThan(r) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+}  // namespace
+
+TEST(GenericKeyTest, ComparatorTest) {
+  auto schema = ParseCreateStatement("a int,b double,c varchar(8),d smallint");
+  GenericComparator<64> generic_comparator(schema.get());
+  NormalizedComparator<64> normalized_comparator(schema.get());
+
+  std::mt19937 gen(15445);
+  std::vector<std::string> strings = {"", "a", "ab", "abc", "b", "ba"};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    // small domains so that most keys tie on their leading columns
+    tuples.emplace_back(std::vector<Value>{Value(TypeId::INTEGER, static_cast<int32_t>(gen() % 5) - 2),
+                                           Value(TypeId::DECIMAL, static_cast<double>(gen() % 5) * 0.5 - 1),
+                                           Value(TypeId::VARCHAR, strings[gen() % strings.size()]),
+                                           Value(TypeId::SMALLINT, static_cast<int16_t>(gen() % 5) - 2)},
+                        schema.get());
+  }
+
+  for (const auto &lhs : tuples) {
+    GenericKey<64> generic_lhs;
+    NormalizedKey<64> normalized_lhs;
+    generic_lhs.SetFromKey(lhs, *schema);
+    normalized_lhs.SetFromKey(lhs, *schema);
+    for (const auto &rhs : tuples) {
+      GenericKey<64> generic_rhs;
+      NormalizedKey<64> normalized_rhs;
+      generic_rhs.SetFromKey(rhs, *schema);
+      normalized_rhs.SetFromKey(rhs, *schema);
+      int expected = CompareValues(lhs, rhs, *schema);
+      EXPECT_EQ(Sign(generic_comparator(generic_lhs, generic_rhs)), expected);
+      EXPECT_EQ(Sign(normalized_comparator(normalized_lhs, normalized_rhs)), expected);
+    }
+  }
+}
+
+TEST(GenericKeyTest, NormalizedKeyTreeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  NormalizedComparator<16> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>> tree("foo_pk", bpm, comparator);
+  std::vector<int64_t> keys;
+  for (int64_t key = -500; key < 500; key++) {
+    keys.push_back(key * 1000003);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  NormalizedKey<16> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key & 0xFFFF))));
+  }
+
+  // memcmp order of the normalized keys is the signed order of the integers
+  std::sort(keys.begin(), keys.end());
+  size_t i = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator, ++i) {
+    ASSERT_LT(i, keys.size());
+    EXPECT_EQ((*iterator).first.ToString(), keys[i]);
+  }
+  EXPECT_EQ(i, keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(GenericKeyTest, NormalizedKeyTooLongTest) {
+  auto key_schema = ParseCreateStatement("a varchar(64)");
+  NormalizedKey<16> index_key;
+  index_key.SetFromKey(Tuple({Value(TypeId::VARCHAR, "short")}, key_schema.get()), *key_schema);
+
+  // a cut-off encoding would make the two keys equal
+  Tuple long_key({Value(TypeId::VARCHAR, "a key longer than sixteen bytes")}, key_schema.get());
+  EXPECT_THROW(index_key.SetFromKey(long_key, *key_schema), Exception);
+}
+
+}  // namespace bustub
@@ -19,7 +19,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
@@ -46,6 +46,47 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 4), 123);
+  EXPECT_EQ(tmp_tuple, TmpTuple(page_id, PAGE_SIZE - 8));
+
+  // fill the page, then read the tuples back from the last inserted to the first
+  int count = 1;
+  while (page.Insert(Tuple({ValueFactory::GetIntegerValue(123 + count)}, &schema), &tmp_tuple)) {
+    count++;
+  }
+  EXPECT_EQ(count, (PAGE_SIZE - 12) / 8);
+  Tuple read;
+  size_t offset = page.GetFreeSpacePointer();
+  for (int i = count - 1; i >= 0; i--) {
+    ASSERT_LT(offset, PAGE_SIZE);
+    offset = page.Get(offset, &read);
+    EXPECT_EQ(read.GetValue(&schema, 0).GetAs<int32_t>(), 123 + i);
+  }
+  EXPECT_EQ(offset, PAGE_SIZE);
+}
+
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, RidTest) {
+  TmpTuplePage page{};
+  page.Init(15445, PAGE_SIZE);
+  Schema schema({Column("A", TypeId::INTEGER)});
+
+  // Every tuple takes its size, its data and its RID
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  int count = 0;
+  while (page.Insert(Tuple({ValueFactory::GetIntegerValue(count)}, &schema), RID(count, 2 * count), &tmp_tuple)) {
+    count++;
+  }
+  EXPECT_EQ(count, (PAGE_SIZE - 12) / 16);
+  Tuple read;
+  RID rid;
+  size_t offset = page.GetFreeSpacePointer();
+  for (int i = count - 1; i >= 0; i--) {
+    ASSERT_LT(offset, PAGE_SIZE);
+    offset = page.Get(offset, &read, &rid);
+    EXPECT_EQ(read.GetValue(&schema, 0).GetAs<int32_t>(), i);
+    EXPECT_EQ(rid, RID(i, 2 * i));
+  }
+  EXPECT_EQ(offset, PAGE_SIZE);
 }
 
 }  // namespace bustub
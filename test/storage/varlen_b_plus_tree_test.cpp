@@ -0,0 +1,384 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree_test.cpp
+//
+// Identification: test/storage/varlen_b_plus_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/key_normalizer.h"
+#include "storage/index/varlen_b_plus_tree.h"
+#include "storage/index/varlen_b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+std::string MakeKey(int i) {
+  // long keys sharing a long prefix, with a variable-length tail
+  std::string key = "customer/region-europe/account-" + std::to_string(i);
+  key.append(i % 7, 'x');
+  return key;
+}
+}  // namespace
+
+TEST(VarlenBPlusTreeTest, SlottedPageTest) {
+  alignas(8) char data[PAGE_SIZE];
+  auto *leaf = reinterpret_cast<BPlusTreeSlottedPage<RID> *>(data);
+  leaf->Init(1, INVALID_PAGE_ID, IndexPageType::LEAF_PAGE);
+
+  std::string prefix = "customer/region-europe/account-";
+  int count = 0;
+  while (true) {
+    std::string key = prefix + std::to_string(100000 + count);
+    if (!leaf->Insert(leaf->KeyIndex(key), key, RID(0, count))) {
+      break;
+    }
+    count++;
+  }
+  // a GenericKey<64> leaf holds (4096 - 28) / 72 = 56 of these keys
+  EXPECT_GT(count, 200);
+  EXPECT_EQ(leaf->GetPrefix().substr(0, prefix.size()), prefix);
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(leaf->KeyAt(i), prefix + std::to_string(100000 + i));
+    EXPECT_EQ(leaf->ValueAt(i).GetSlotNum(), i);
+  }
+
+  // a key that does not share the prefix makes every key longer, so it does not fit any more
+  EXPECT_FALSE(leaf->Insert(0, "a", RID(0, -1)));
+  EXPECT_EQ(leaf->GetSize(), count);
+
+  // after removing most keys it does, and the prefix is gone
+  for (int i = 0; i < count - 20; i++) {
+    leaf->Remove(0);
+  }
+  EXPECT_TRUE(leaf->Insert(0, "a", RID(0, -1)));
+  EXPECT_TRUE(leaf->GetPrefix().empty());
+  EXPECT_EQ(leaf->KeyAt(0), "a");
+  EXPECT_EQ(leaf->KeyAt(1), prefix + std::to_string(100000 + count - 20));
+  EXPECT_EQ(leaf->KeyIndex(prefix), 1);
+  EXPECT_EQ(leaf->UpperBound("a"), 1);
+  EXPECT_EQ(leaf->KeyIndex("b"), 1);
+  EXPECT_EQ(leaf->KeyIndex("z"), leaf->GetSize());
+}
+
+TEST(VarlenBPlusTreeTest, KeyNormalizerTest) {
+  auto schema = ParseCreateStatement("a varchar(16),b int");
+  auto encode = [&](const std::string &a, int32_t b) {
+    return KeyNormalizer::Normalize(Tuple({Value(TypeId::VARCHAR, a), Value(TypeId::INTEGER, b)}, schema.get()),
+                                    *schema);
+  };
+  // memcmp order of the encodings follows the column by column order of the keys
+  std::vector<std::string> ordered = {encode("", 5),         encode("a", -100), encode("a", -1), encode("a", 0),
+                                      encode("a", 1),        encode("a", 300),  encode("ab", -5), encode("b", 0),
+                                      encode("ba", INT32_MAX)};
+  for (size_t i = 1; i < ordered.size(); i++) {
+    EXPECT_LT(ordered[i - 1], ordered[i]) << i;
+  }
+
+  std::string low;
+  std::string high;
+  KeyNormalizer::AppendValue(Value(TypeId::DECIMAL, -2.5), &low);
+  KeyNormalizer::AppendValue(Value(TypeId::DECIMAL, 0.25), &high);
+  EXPECT_LT(low, high);
+
+  // RIDs are ordered by page id, then by slot number
+  std::vector<RID> rids = {RID(), RID(0, 7), RID(1, 0), RID(1, 256), RID(2, 1)};
+  for (size_t i = 1; i < rids.size(); i++) {
+    low.clear();
+    high.clear();
+    KeyNormalizer::AppendRid(rids[i - 1], &low);
+    KeyNormalizer::AppendRid(rids[i], &high);
+    EXPECT_LT(low, high) << i;
+  }
+}
+
+TEST(VarlenBPlusTreeTest, InsertRemoveTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  VarlenBPlusTree tree("foo_pk", bpm);
+  std::vector<int> ids(5000);
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+
+  std::map<std::string, int> expected;
+  for (int id : ids) {
+    EXPECT_TRUE(tree.Insert(MakeKey(id), RID(0, id)));
+    expected[MakeKey(id)] = id;
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(ids[0]), RID(0, 0)));
+
+  std::vector<RID> rids;
+  for (int id : ids) {
+    rids.clear();
+    EXPECT_TRUE(tree.GetValue(MakeKey(id), &rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), id);
+  }
+  EXPECT_FALSE(tree.GetValue("customer/region-europe/account-", &rids));
+
+  // range scans return the keys in memcmp order
+  auto check_scan = [&]() {
+    auto expected_iter = expected.begin();
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator, ++expected_iter) {
+      ASSERT_NE(expected_iter, expected.end());
+      EXPECT_EQ(iterator.Key(), expected_iter->first);
+      EXPECT_EQ(iterator.Value().GetSlotNum(), expected_iter->second);
+    }
+    EXPECT_EQ(expected_iter, expected.end());
+  };
+  check_scan();
+  {
+    auto from = tree.Begin(MakeKey(4000));
+    EXPECT_EQ(from.Key(), MakeKey(4000));
+  }
+
+  for (int i = 0; i < static_cast<int>(ids.size()); i += 2) {
+    tree.Remove(MakeKey(ids[i]));
+    expected.erase(MakeKey(ids[i]));
+  }
+  check_scan();
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(MakeKey(ids[i]), &rids), i % 2 == 1);
+  }
+
+  for (int i = 0; i < static_cast<int>(ids.size()); i += 2) {
+    EXPECT_TRUE(tree.Insert(MakeKey(ids[i]), RID(0, ids[i])));
+    expected[MakeKey(ids[i])] = ids[i];
+  }
+  check_scan();
+
+  // underfull pages are merged until the tree is empty
+  for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+    tree.Remove(MakeKey(ids[i]));
+    expected.erase(MakeKey(ids[i]));
+    if (i % 1000 == 999) {
+      check_scan();
+    }
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin().IsEnd());
+  EXPECT_TRUE(tree.Insert(MakeKey(ids[0]), RID(0, ids[0])));
+  rids.clear();
+  EXPECT_TRUE(tree.GetValue(MakeKey(ids[0]), &rids));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarlenBPlusTreeTest, ConcurrentInsertTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  VarlenBPlusTree tree("foo_pk", bpm);
+  const int num_threads = 4;
+  const int num_keys = 8000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      Transaction transaction(t);
+      for (int i = t; i < num_keys; i += num_threads) {
+        EXPECT_TRUE(tree.Insert(MakeKey(i), RID(0, i), &transaction));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> rids;
+  for (int i = 0; i < num_keys; i++) {
+    rids.clear();
+    EXPECT_TRUE(tree.GetValue(MakeKey(i), &rids));
+  }
+  int count = 0;
+  std::string previous;
+  for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator) {
+    EXPECT_LT(previous, iterator.Key());
+    previous = iterator.Key();
+    count++;
+  }
+  EXPECT_EQ(count, num_keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarlenBPlusTreeTest, ConcurrentRemoveTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  VarlenBPlusTree tree("foo_pk", bpm);
+  const int num_threads = 4;
+  const int num_keys = 8000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(tree.Insert(MakeKey(i), RID(0, i)));
+  }
+  // every thread removes three quarters of its keys
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      Transaction transaction(t);
+      for (int i = t; i < num_keys; i += num_threads) {
+        if (i % 16 >= num_threads) {
+          tree.Remove(MakeKey(i), &transaction);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> rids;
+  for (int i = 0; i < num_keys; i++) {
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(MakeKey(i), &rids), i % 16 < num_threads);
+  }
+  int count = 0;
+  std::string previous;
+  for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator) {
+    EXPECT_LT(previous, iterator.Key());
+    previous = iterator.Key();
+    count++;
+  }
+  EXPECT_EQ(count, num_keys / 16 * num_threads);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarlenBPlusTreeTest, IndexTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto schema = ParseCreateStatement("name varchar(128),id int");
+  auto metadata = std::make_unique<IndexMetadata>("name_id_idx", "customers", schema.get(), std::vector<uint32_t>{0, 1});
+  VarlenBPlusTreeIndex index(std::move(metadata), bpm);
+  auto make_tuple = [&](int i) {
+    return Tuple({Value(TypeId::VARCHAR, MakeKey(i % 100)), Value(TypeId::INTEGER, i)}, index.GetKeySchema());
+  };
+
+  for (int i = 0; i < 1000; i++) {
+    index.InsertEntry(make_tuple(i), RID(1, i), nullptr);
+  }
+  std::vector<RID> rids;
+  for (int i = 0; i < 1000; i++) {
+    rids.clear();
+    index.ScanKey(make_tuple(i), &rids, nullptr);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), i);
+  }
+
+  index.DeleteEntry(make_tuple(42), RID(1, 42), nullptr);
+  rids.clear();
+  index.ScanKey(make_tuple(42), &rids, nullptr);
+  EXPECT_TRUE(rids.empty());
+
+  // the keys of one name are adjacent, ordered by id
+  {
+    auto iterator = index.GetBeginIterator(make_tuple(7));
+    for (int i = 7; i < 1000; i += 100) {
+      ASSERT_FALSE(iterator.IsEnd());
+      EXPECT_EQ(iterator.Value().GetSlotNum(), i);
+      ++iterator;
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarlenBPlusTreeTest, CatalogIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  auto schema = ParseCreateStatement("name varchar(128),id int");
+  auto *table_info = catalog->CreateTable(&txn, "customers", *schema);
+  for (int i = 0; i < 500; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::VARCHAR, MakeKey(i % 50)), Value(TypeId::INTEGER, i)}, schema.get());
+    table_info->table_->InsertTuple(tuple, &rid, &txn);
+  }
+
+  // the index is built from the rows already in the table, on keys longer than any GenericKey
+  auto key_schema = ParseCreateStatement("name varchar(128)");
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "name_idx", "customers", *schema, *key_schema, {0}, 8, HashFunction<GenericKey<8>>(),
+      IndexType::VARLEN_B_PLUS_TREE);
+  ASSERT_NE(index_info, Catalog::NULL_INDEX_INFO);
+  auto make_key = [&](int i) { return Tuple({Value(TypeId::VARCHAR, MakeKey(i))}, key_schema.get()); };
+
+  // every row of a key is indexed, ordered by RID
+  std::vector<RID> rids;
+  index_info->index_->ScanKey(make_key(7), &rids, &txn);
+  ASSERT_EQ(rids.size(), 10);
+  EXPECT_TRUE(std::is_sorted(rids.begin(), rids.end(), [](const RID &a, const RID &b) {
+    return std::make_pair(a.GetPageId(), a.GetSlotNum()) < std::make_pair(b.GetPageId(), b.GetSlotNum());
+  }));
+
+  // deleting one row of a key keeps the entries of the others
+  RID deleted = rids[3];
+  index_info->index_->DeleteEntry(make_key(7), deleted, &txn);
+  rids.clear();
+  index_info->index_->ScanKey(make_key(7), &rids, &txn);
+  ASSERT_EQ(rids.size(), 9);
+  EXPECT_EQ(std::find(rids.begin(), rids.end(), deleted), rids.end());
+  rids.clear();
+  index_info->index_->ScanKey(make_key(8), &rids, &txn);
+  EXPECT_EQ(rids.size(), 10);
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub